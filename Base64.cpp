@@ -0,0 +1,142 @@
+#include "Base64.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BASE64_NEON
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define BASE64_SSSE3
+#endif
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+#ifdef BASE64_NEON
+        //6 bit values to ASCII without a table: 'A'.. for 0-25, 'a'.. for 26-51, '0'.. for 52-61, '+', '/'
+        static inline uint8x16_t neonAscii(uint8x16_t values)
+        {
+            uint8x16_t offset = vdupq_n_u8('A');
+            offset = vbslq_u8(vcgeq_u8(values, vdupq_n_u8(26)), vdupq_n_u8('a' - 26), offset);
+            offset = vbslq_u8(vcgeq_u8(values, vdupq_n_u8(52)), vdupq_n_u8((uint8_t)('0' - 52)), offset);
+            offset = vbslq_u8(vceqq_u8(values, vdupq_n_u8(62)), vdupq_n_u8((uint8_t)('+' - 62)), offset);
+            offset = vbslq_u8(vceqq_u8(values, vdupq_n_u8(63)), vdupq_n_u8((uint8_t)('/' - 63)), offset);
+            return vaddq_u8(values, offset);
+        }
+#endif
+
+        size_t Base64Encoder::EncodeTriples(const uint8_t* data, size_t length, char* output)
+        {
+            size_t done = 0;
+#if defined(BASE64_NEON)
+            //vld3q splits 48 bytes into the first, second and third byte of 16 triples
+            const uint8x16_t mask = vdupq_n_u8(0x3f);
+            for (; done + 48 <= length; done += 48, output += 64)
+            {
+                const uint8x16x3_t in = vld3q_u8(data + done);
+                uint8x16x4_t out;
+                out.val[0] = neonAscii(vshrq_n_u8(in.val[0], 2));
+                out.val[1] = neonAscii(vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), mask));
+                out.val[2] = neonAscii(vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), mask));
+                out.val[3] = neonAscii(vandq_u8(in.val[2], mask));
+                vst4q_u8(reinterpret_cast<uint8_t*>(output), out);
+            }
+#elif defined(BASE64_SSSE3)
+            //each step loads 16 bytes and encodes the first 12, so it stops 4 bytes short of the end
+            const __m128i spread = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+            const __m128i shifts = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+            for (; done + 16 <= length; done += 12, output += 16)
+            {
+                __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + done));
+                in = _mm_shuffle_epi8(in, spread);
+                //move the four 6 bit fields of every 32 bit lane into their own byte
+                const __m128i high = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+                const __m128i low = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+                const __m128i values = _mm_or_si128(high, low);
+                //pick the ASCII offset of each value's range with a 16 entry shuffle
+                __m128i range = _mm_subs_epu8(values, _mm_set1_epi8(51));
+                range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), values), _mm_set1_epi8(13)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_add_epi8(_mm_shuffle_epi8(shifts, range), values));
+            }
+#endif
+            for (; done + 3 <= length; done += 3, output += 4)
+            {
+                const uint32_t triple = (uint32_t)data[done] << 16 | (uint32_t)data[done + 1] << 8 | data[done + 2];
+                output[0] = alphabet[(triple >> 18) & 0x3f];
+                output[1] = alphabet[(triple >> 12) & 0x3f];
+                output[2] = alphabet[(triple >> 6) & 0x3f];
+                output[3] = alphabet[triple & 0x3f];
+            }
+            return done;
+        }
+
+        Base64Encoder::Base64Encoder(std::string& output, bool padding)
+            : m_output(output)
+            , m_padding(padding)
+            , m_pending()
+            , m_pendingLength(0)
+        {
+        }
+        void Base64Encoder::Update(const uint8_t* data, size_t length)
+        {
+            if (m_pendingLength != 0)
+            {
+                //complete the triple left over from the previous chunk first
+                uint8_t triple[3] = { m_pending[0], m_pending[1], 0 };
+                size_t have = m_pendingLength;
+                for (; have < 3 && length != 0; length--)
+                    triple[have++] = *data++;
+                if (have < 3)
+                {
+                    m_pending[0] = triple[0];
+                    m_pending[1] = triple[1];
+                    m_pendingLength = have;
+                    return;
+                }
+                const size_t at = m_output.size();
+                m_output.resize(at + 4);
+                EncodeTriples(triple, 3, &m_output[at]);
+                m_pendingLength = 0;
+            }
+            const size_t triples = length - length % 3;
+            if (triples)
+            {
+                const size_t at = m_output.size();
+                m_output.resize(at + triples / 3 * 4);
+                EncodeTriples(data, triples, &m_output[at]);
+            }
+            for (size_t i = triples; i < length; i++)
+                m_pending[m_pendingLength++] = data[i];
+        }
+        void Base64Encoder::Finish()
+        {
+            if (m_pendingLength == 0)
+                return;
+            const uint32_t bits = (uint32_t)m_pending[0] << 16 | (m_pendingLength == 2 ? (uint32_t)m_pending[1] << 8 : 0);
+            m_output += alphabet[(bits >> 18) & 0x3f];
+            m_output += alphabet[(bits >> 12) & 0x3f];
+            if (m_pendingLength == 2)
+                m_output += alphabet[(bits >> 6) & 0x3f];
+            if (m_padding)
+                m_output.append(m_pendingLength == 2 ? 1 : 2, '=');
+            m_pendingLength = 0;
+        }
+        size_t Base64Encoder::EncodedLength(size_t length, bool padding)
+        {
+            const size_t tail = length % 3;
+            return length / 3 * 4 + (tail == 0 ? 0 : (padding ? 4 : tail + 1));
+        }
+        void Base64Encoder::Encode(const uint8_t* data, size_t length, bool padding, std::string& output)
+        {
+            output.clear();
+            output.reserve(EncodedLength(length, padding));
+            Base64Encoder encoder(output, padding);
+            encoder.Update(data, length);
+            encoder.Finish();
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Base64 (RFC 4648 alphabet) encoder for EDID and other HAL buffers of any size. Input is
+        // consumed in place, without a staging copy, 48 bytes per NEON step, 12 per SSSE3 step, and
+        // byte triples otherwise; the output string is sized once up front. Update() may be called
+        // repeatedly with consecutive chunks, the encoding is the same as for one call with all of them.
+        // Without padding the output matches Core::ToString(..., false, ...).
+        class Base64Encoder {
+        public:
+            Base64Encoder(std::string& output, bool padding);
+
+            Base64Encoder(const Base64Encoder&) = delete;
+            Base64Encoder& operator=(const Base64Encoder&) = delete;
+
+            void Update(const uint8_t* data, size_t length);
+            //encodes the last one or two pending bytes, the encoder can not be used afterwards
+            void Finish();
+
+            static size_t EncodedLength(size_t length, bool padding);
+            //replaces output with the encoding of data
+            static void Encode(const uint8_t* data, size_t length, bool padding, std::string& output);
+
+        private:
+            //encodes the whole triples of data to output, returns how many input bytes that was
+            static size_t EncodeTriples(const uint8_t* data, size_t length, char* output);
+
+            std::string& m_output;
+            bool m_padding;
+            uint8_t m_pending[2];
+            size_t m_pendingLength;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,109 @@
+#include "CaptureLog.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        CaptureLog::CaptureLog()
+            : m_enabled(false)
+            , m_entries(0)
+            , m_lock()
+            , m_file(nullptr)
+            , m_path()
+            , m_start()
+        {
+        }
+        CaptureLog::~CaptureLog()
+        {
+            Stop();
+        }
+        bool CaptureLog::Start(const std::string& path)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            if (m_file != nullptr)
+                fclose(m_file);
+            //never follow a symlink planted at the capture path
+            const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, 0640);
+            m_file = (fd < 0) ? nullptr : fdopen(fd, "w");
+            if (m_file == nullptr)
+            {
+                if (fd >= 0)
+                    close(fd);
+                m_enabled = false;
+                return false;
+            }
+            m_path = path;
+            m_entries = 0;
+            m_start = std::chrono::steady_clock::now();
+            m_enabled = true;
+            return true;
+        }
+        void CaptureLog::Stop()
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_enabled = false;
+            if (m_file != nullptr)
+            {
+                fclose(m_file);
+                m_file = nullptr;
+            }
+        }
+        std::string CaptureLog::Path() const
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            return m_path;
+        }
+        void CaptureLog::Request(uint8_t version, uint32_t channel, const char* method, const std::string& parametersJson)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            if (m_file == nullptr)
+                return;
+            fprintf(m_file, "{\"t\":%llu,\"type\":\"request\",\"version\":%u,\"channel\":%u,\"method\":\"%s\",\"params\":%s}\n",
+                (unsigned long long)Elapsed(), (unsigned)version, (unsigned)channel, method, parametersJson.empty() ? "{}" : parametersJson.c_str());
+            fflush(m_file);
+            m_entries++;
+        }
+        void CaptureLog::Event(const char* owner, int32_t eventId, const void* data, size_t length)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            if (m_file == nullptr)
+                return;
+            fprintf(m_file, "{\"t\":%llu,\"type\":\"event\",\"owner\":\"%s\",\"id\":%d,\"payload\":\"",
+                (unsigned long long)Elapsed(), owner, eventId);
+            Payload(data, length);
+            fputs("\"}\n", m_file);
+            fflush(m_file);
+            m_entries++;
+        }
+        void CaptureLog::Call(const char* owner, const char* name, const void* data, size_t length)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            if (m_file == nullptr)
+                return;
+            fprintf(m_file, "{\"t\":%llu,\"type\":\"call\",\"owner\":\"%s\",\"name\":\"%s\",\"payload\":\"",
+                (unsigned long long)Elapsed(), owner, name);
+            Payload(data, length);
+            fputs("\"}\n", m_file);
+            fflush(m_file);
+            m_entries++;
+        }
+        void CaptureLog::Payload(const void* data, size_t length)
+        {
+            static const char digits[] = "0123456789abcdef";
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; bytes != nullptr && i < length; i++)
+            {
+                fputc(digits[bytes[i] >> 4], m_file);
+                fputc(digits[bytes[i] & 0x0f], m_file);
+            }
+        }
+        uint64_t CaptureLog::Elapsed() const
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
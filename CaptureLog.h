@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Capture mode: records incoming JSON-RPC requests and IARM events/calls, with their
+        // payloads and arrival times, so a field problem can be replayed later with
+        // tests/CaptureReplay.cpp. One JSON object per line:
+        //   {"t":1234,"type":"request","version":2,"channel":7,"method":"getCurrentResolution","params":{...}}
+        //   {"t":1250,"type":"event","owner":"DSMgr","id":3,"payload":"00000000"}
+        //   {"t":1300,"type":"call","owner":"Display_Settings","name":"ResolutionPostChange","payload":"..."}
+        // t is microseconds since the capture started; version is the interface version the request came in
+        // on and channel its JSON-RPC channel, requests are recorded before setter admission so the
+        // rejected ones are in the capture too; payloads are the raw IARM bytes in hex.
+        // When capture is off the only cost on the hot path is one relaxed atomic load.
+        class CaptureLog {
+        public:
+            CaptureLog();
+            ~CaptureLog();
+
+            CaptureLog(const CaptureLog&) = delete;
+            CaptureLog& operator=(const CaptureLog&) = delete;
+
+            bool Start(const std::string& path);
+            void Stop();
+
+            bool IsEnabled() const
+            {
+                return m_enabled.load(std::memory_order_relaxed);
+            }
+            std::string Path() const;
+            uint64_t Entries() const
+            {
+                return m_entries.load(std::memory_order_relaxed);
+            }
+
+            void Request(uint8_t version, uint32_t channel, const char* method, const std::string& parametersJson);
+            void Event(const char* owner, int32_t eventId, const void* data, size_t length);
+            void Call(const char* owner, const char* name, const void* data, size_t length);
+
+        private:
+            void Payload(const void* data, size_t length);
+            uint64_t Elapsed() const;
+
+            std::atomic<bool> m_enabled;
+            std::atomic<uint64_t> m_entries;
+            mutable std::mutex m_lock;
+            FILE* m_file;
+            std::string m_path;
+            std::chrono::steady_clock::time_point m_start;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <strings.h>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Numbering used by the capability methods when called with "format":"compact". Those
+        // responses carry "schema":VERSION and bitmasks in place of the arrays of display strings:
+        //   getSupportedTvResolutions  "tvResolutions"  dsTV_RESOLUTION_* bits
+        //   getTvHDRSupport            "hdrStandards"   dsHDRSTANDARD_* bits
+        //   getSettopHDRSupport        "hdrStandards"   dsHDRSTANDARD_* bits
+        //   getSupportedResolutions    "resolutions"    bit i is Resolutions[i]
+        //   getSupportedAudioModes     "audioModes"     bit i is AudioModes[i]
+        // A name the tables below do not have is returned as a string in "otherResolutions" or
+        // "otherAudioModes". The tables only ever grow at the end and VERSION is bumped when they do,
+        // so native clients can include this header and decode without string compares.
+        namespace CompactSchema {
+
+            enum { VERSION = 1 };
+
+            static const char* const Resolutions[] = {
+                "480i", "480p", "576i", "576p", "576p50", "720p", "720p50", "1080i", "1080i25", "1080i50",
+                "1080p", "1080p24", "1080p25", "1080p30", "1080p50", "1080p60", "2160p24", "2160p25", "2160p30",
+                "2160p50", "2160p60"
+            };
+            static const char* const AudioModes[] = {
+                "MONO", "STEREO", "SURROUND", "PASSTHRU", "AUTO (Stereo)", "AUTO (Dolby Digital 5.1)", "AUTO (Dolby Digital Plus)"
+            };
+
+            static_assert(sizeof(Resolutions) / sizeof(Resolutions[0]) <= 32, "resolution bits do not fit a uint32_t");
+            static_assert(sizeof(AudioModes) / sizeof(AudioModes[0]) <= 32, "audio mode bits do not fit a uint32_t");
+
+            //bit of name in table, 0 when the table does not have it
+            template<size_t N>
+            inline uint32_t Bit(const char* const (&table)[N], const char* name)
+            {
+                for (size_t i = 0; i < N; i++)
+                {
+                    if (strcasecmp(table[i], name) == 0)
+                        return 1u << i;
+                }
+                return 0;
+            }
+            template<size_t N>
+            inline uint32_t Bit(const char* const (&table)[N], const std::string& name)
+            {
+                return Bit(table, name.c_str());
+            }
+
+        } // namespace CompactSchema
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -2,7 +2,19 @@
 //  when refactoring the servicemanager's version of displaysettings into this new thunder plugin format
 
 #include "DisplaySettings.h"
+#include "DisplaySettingsTracing.h"
+#include "TraceRing.h"
+#include "CaptureLog.h"
+#include "SinkCapabilityStore.h"
+#include "SinkQuirks.h"
+#include "ModeSelector.h"
+#include "CompactSchema.h"
+#include "Base64.h"
+#include "ShadowState.h"
 #include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
 #include "dsMgr.h"
 #include "libIBusDaemon.h"
 #include "host.hpp"
@@ -27,44 +39,69 @@
 #define MYLOG(...) fprintf(logger, __VA_ARGS__); fflush(logger);
 #define MYWARN(...) fprintf(logger, __VA_ARGS__); fflush(logger);
 #define MYERROR(...) fprintf(logger, __VA_ARGS__); fflush(logger);
-#define MYTRACEMETHOD() { string json; parameters.ToString(json); fprintf(logger, "%s parameters=%s\n", __FUNCTION__, json.c_str() ); fflush(logger); }
-#define MYTRACEMETHODFIN() { string json; response.ToString(json); fprintf(logger, "%s response=%s\n", __FUNCTION__, json.c_str() ); fflush(logger); }
+//parameters, responses and notifications are only serialized for a consumer: the log with "logpayloads", an enabled trace category
+//(the capture records requests where they are registered, see registerMethod)
+#define MYTRACEMETHOD() RequestArena::Scope requestArena; \
+    if (logPayloads || DS_TRACE_ENABLED(MethodEntry)) \
+    { string json; parameters.ToString(json); \
+        if (logPayloads) { fprintf(logger, "%s parameters=%s\n", __FUNCTION__, json.c_str() ); fflush(logger); } \
+        DS_TRACE(MethodEntry, (_T("%s %s"), __FUNCTION__, json.c_str())); } \
+    const uint64_t traceMethodStart = TraceRing::Now();
+#define MYTRACEMETHODFIN() if (logPayloads) { string json; response.ToString(json); fprintf(logger, "%s response=%s\n", __FUNCTION__, json.c_str() ); fflush(logger); }
 #define MYTRACE() fprintf(logger, "%s\n", __PRETTY_FUNCTION__); fflush(logger);
 #define LOG_DEVICE_EXCEPTION0() MYWARN("Exception caught while processing %s code=%d message=%s\n", __FUNCTION__, err.getCode(), err.what());
 #define LOG_DEVICE_EXCEPTION1(param1) MYWARN("Exception caught while processing %s " #param1 "=%s code=%d message=%s\n", __FUNCTION__, param1.c_str(), err.getCode(), err.what());
 #define LOG_DEVICE_EXCEPTION2(param1,param2) MYWARN("Exception caught while processing %s " #param1 "=%s " #param2 "=%s code=%d message=%s\n", __FUNCTION__, param1.c_str(), param2.c_str(), err.getCode(), err.what());
 
 //this set of macros are used in the method handlers to make the code more consistent and easier to read
-#define vectorSet(v,s) \
-    if (find(begin(v), end(v), s) == end(v)) \
-        v.emplace_back(s);
 #define stringContains(s1,s2) \
     (search(s1.begin(), s1.end(), s2, s2+strlen(s2), \
         [](char c1, char c2){ \
             return toupper(c1) == toupper(c2); \
     }) != s1.end())
+//the method's trace id is looked up per call through TraceRing's lock free cache, a cached NO_NAME from
+//before the recorder opened would stick for the life of the process
 #define returnResponse(success) \
     response["success"] = success; \
     MYTRACEMETHODFIN(); \
+    flightRecorder.Add(TraceRing::METHOD, flightRecorder.Id(__FUNCTION__), TraceRing::NO_NAME, traceMethodStart, 0, 0, (success) ? 0 : 1); \
+    DS_TRACE(MethodExit, (_T("%s success=%d %llu us"), __FUNCTION__, (success) ? 1 : 0, (unsigned long long)((TraceRing::Now() - traceMethodStart) / 1000))); \
     return (Core::ERROR_NONE); 
-#define returnIfWrongApiVersion(version)\
-    if(getApiVersionNumber() < version)\
-    {\
-        MYWARN("method %s not supported. version required=%u actual=%u\n", __FUNCTION__, version, getApiVersionNumber());\
-        returnResponse(false);\
-    }
 #define returnIfParamNotFound(param)\
     if(param.empty())\
     {\
         MYWARN("method %s missing parameter %s\n", __FUNCTION__, #param);\
         returnResponse(false);\
     }
-
-#define sendNotify(event,params)\
-    string json;\
-    params.ToString(json);\
-    MYLOG("Notify %s %s\n", event, json.c_str());\
-    Notify(event,params);
+#define returnIfDecoderNotFound(decoder)\
+    if(!videoDecoderParam(parameters, decoder))\
+    {\
+        MYWARN("method %s unknown videoDecoder, %u available\n", __FUNCTION__, (unsigned)m_ports.DecoderCount());\
+        returnResponse(false);\
+    }
+//a list the HAL filled past the capacity of its type keeps every item, but on the heap; warned once per call site
+#define warnIfSpilled(what,list)\
+    {\
+        static std::atomic<bool> warned(false);\
+        if (list.spilled() && !warned.exchange(true))\
+        {\
+            MYWARN("%s: %zu items, more than the %zu expected\n", what, list.size(), list.capacity());\
+        }\
+    }
+//changed false is an unchanged state, for the consumers that force notifications only
+#define sendNotifyIf(event,params,minApiVersion,changed)\
+    do {\
+        if (logPayloads || DS_TRACE_ENABLED(Notification))\
+        {\
+            string json;\
+            params.ToString(json);\
+            if (logPayloads) { MYLOG("Notify %s %s\n", event, json.c_str()); }\
+            DS_TRACE(Notification, (_T("%s %s"), event, json.c_str()));\
+        }\
+        flightRecorder.Add(TraceRing::NOTIFY, flightRecorder.Id(event), TraceRing::NO_NAME, 0, 0, 0, 0);\
+        notifyClients(event,params,minApiVersion,changed);\
+    } while (0)
+#define sendNotify(event,params,minApiVersion) sendNotifyIf(event,params,minApiVersion,true)
     
 #define IARM_CHECK(FUNC) \
   if ((res = FUNC) != IARM_RESULT_SUCCESS) { \
@@ -79,6 +116,35 @@
 
 #define HDMI_HOT_PLUG_EVENT_CONNECTED 0
 
+//our IARM bus name; ResolutionPreChange/ResolutionPostChange are registered as calls under it
+#define IARM_BUS_DISPLAYSETTINGS_NAME "Display_Settings"
+#define CAPTURE_DEFAULT_PATH "/opt/logs/ds.capture"
+#define SINK_STORE_PATH "/opt/persistent/ds_sinks.dat"
+
+//what readEDID/readHostEDID report when there is no EDID to return
+static const uint8_t unknownEdid[] = { 'u','n','k','n','o','w','n' };
+
+//bounded HAL executor: worker count, queue depth, timeouts needed to open the breaker and how long it stays open
+#define HAL_EXECUTOR_WORKERS 2
+#define HAL_EXECUTOR_QUEUE_DEPTH 8
+#define HAL_BREAKER_TRIP_THRESHOLD 3
+#define HAL_BREAKER_COOLDOWN_MS 10000
+//per-call deadlines; an HDMI mode switch legitimately takes longer than a query
+#define HAL_CALL_DEADLINE_MS 2000
+#define HAL_MODE_SWITCH_DEADLINE_MS 5000
+//how long an async resolution job waits for the ResolutionPostChange callback before reporting completion anyway
+#define RESOLUTION_POSTCHANGE_WAIT_MS 3000
+//the sink is read this long after a connect so the DDC reads do not race the TV's own startup
+#define SINK_SETTLE_MS 500
+//how long a request waits for a running hotplug prefetch before it asks the HAL itself
+#define SINK_PREFETCH_WAIT_MS 3000
+//how often the shadowed live settings are checked against the HAL
+#define SHADOW_RECONCILE_MS 60000
+//how long a standby video port state read from pwrMgr is served without asking again
+#define STANDBY_STATE_TTL_MS 60000
+//subscribers with a notification filter of their own, filters of disconnected clients are not noticed
+#define MAX_NOTIFICATION_FILTERS 64
+
 #define USE_IARM //TODO(MROLLINS) - this was defined in servicemanager.pro for all STB builds.  Not sure where to put it except here for now
 
 #ifdef USE_IARM 
@@ -142,75 +208,216 @@ namespace WPEFramework {
 	namespace Plugin {
 
         static FILE* logger = nullptr;
+        //"logpayloads" of the plugin configuration: method parameters, responses and notifications in the log too
+        static std::atomic<bool> logPayloads(false);
+        //binary flight recorder, see TraceRing.h; decode with tools/TraceDecoder.cpp
+        static TraceRing flightRecorder;
+        //JSON-RPC/IARM capture for offline replay, see CaptureLog.h; off unless enabled through setCaptureMode
+        static CaptureLog eventCapture;
+
+        static void traceIarm(const char* handler, IARM_EventId_t eventId, const void* data, size_t len)
+        {
+            //the first two payload words cover every dsMgr event we handle (resn, dfc, hdmi_hpd, hdmi_rxsense, ...)
+            int32_t words[2] = { 0, 0 };
+            if (data)
+                memcpy(words, data, std::min(len, sizeof(words)));
+            flightRecorder.Add(TraceRing::IARM_EVENT, flightRecorder.Id(handler), (uint16_t)eventId, 0, words[0], words[1], 0);
+            DS_TRACE(IarmEvent, (_T("%s id=%d data=%d,%d len=%u"), handler, (int)eventId, words[0], words[1], (unsigned)len));
+        }
+        static void traceIarmEvent(const char* handler, const char* owner, IARM_EventId_t eventId, const void* data, size_t len)
+        {
+            traceIarm(handler, eventId, data, len);
+            if (eventCapture.IsEnabled())
+                eventCapture.Event(owner, eventId, data, len);
+        }
+        static void traceIarmCall(const char* handler, const char* name, const void* data, size_t len)
+        {
+            traceIarm(handler, 0, data, len);
+            if (eventCapture.IsEnabled())
+                eventCapture.Call(IARM_BUS_DISPLAYSETTINGS_NAME, name, data, len);
+        }
+
+        static const char* hdcpStatusName(int hdcpStatus)
+        {
+            switch (hdcpStatus)
+            {
+            case dsHDCP_STATUS_UNPOWERED: return "unpowered";
+            case dsHDCP_STATUS_UNAUTHENTICATED: return "unauthenticated";
+            case dsHDCP_STATUS_AUTHENTICATED: return "authenticated";
+            case dsHDCP_STATUS_AUTHENTICATIONFAILURE: return "authenticationFailure";
+            case dsHDCP_STATUS_INPROGRESS: return "inProgress";
+            case dsHDCP_STATUS_PORTDISABLED: return "portDisabled";
+            }
+            return "unknown";
+        }
+
+        //HAL queries for the capabilities of the sink on videoDisplay; they run on the HAL executor
+        static int tvHdrCapabilities(const string& videoDisplay)
+        {
+            int tvCapabilities = dsHDRSTANDARD_NONE;
+            device::VideoOutputPort vPort = device::VideoOutputPortConfig::getInstance().getPort(videoDisplay);
+            if (vPort.isDisplayConnected())
+                vPort.getTVHDRCapabilities(&tvCapabilities);
+            return tvCapabilities;
+        }
+        static int tvResolutions(const string& videoDisplay)
+        {
+            int resolutions = 0;
+            device::Host::getInstance().getVideoOutputPort(videoDisplay).getSupportedTvResolutions(&resolutions);
+            return resolutions;
+        }
+        static int sinkSurroundMode(const string& videoDisplay)
+        {
+            device::VideoOutputPort vPort = device::VideoOutputPortConfig::getInstance().getPort(videoDisplay);
+            return vPort.isDisplayConnected() ? vPort.getDisplay().getSurroundMode() : 0;
+        }
+        //empty when the sink reports surround support the AUTO mode has no name for
+        static const char* autoAudioModeName(bool connected, int surroundMode)
+        {
+            if (!connected || !surroundMode)
+                return "AUTO (Stereo)";
+            if (surroundMode & dsSURROUNDMODE_DDPLUS)
+                return "AUTO (Dolby Digital Plus)";
+            if (surroundMode & dsSURROUNDMODE_DD)
+                return "AUTO (Dolby Digital 5.1)";
+            return "";
+        }
+        static std::vector<uint8_t> sinkEdid(const string& videoDisplay)
+        {
+            std::vector<uint8_t> bytes;
+            device::VideoOutputPort vPort = device::Host::getInstance().getVideoOutputPort(videoDisplay);
+            if (vPort.isDisplayConnected())
+                vPort.getDisplay().getEDIDBytes(bytes);
+            return bytes;
+        }
+
+        static void tvResolutionNames(int tvResolutions, FixedList<const char*, 10>& names)
+        {
+            if(!tvResolutions)names.emplace_back("none");
+            if(tvResolutions & dsTV_RESOLUTION_480i)names.emplace_back("480i");
+            if(tvResolutions & dsTV_RESOLUTION_480p)names.emplace_back("480p");
+            if(tvResolutions & dsTV_RESOLUTION_576i)names.emplace_back("576i");
+            if(tvResolutions & dsTV_RESOLUTION_576p)names.emplace_back("576p");
+            if(tvResolutions & dsTV_RESOLUTION_720p)names.emplace_back("720p");
+            if(tvResolutions & dsTV_RESOLUTION_1080i)names.emplace_back("1080i");
+            if(tvResolutions & dsTV_RESOLUTION_1080p)names.emplace_back("1080p");
+            if(tvResolutions & dsTV_RESOLUTION_2160p30)names.emplace_back("2160p30");
+            if(tvResolutions & dsTV_RESOLUTION_2160p60)names.emplace_back("2160p60");
+        }
+        static void hdrStandardNames(int capabilities, JsonArray& standards)
+        {
+            if(!capabilities)standards.Add("none");
+            if(capabilities & dsHDRSTANDARD_HDR10)standards.Add("HDR10");
+            if(capabilities & dsHDRSTANDARD_DolbyVision)standards.Add("Dolby Vision");
+            if(capabilities & dsHDRSTANDARD_TechnicolorPrime)standards.Add("Technicolor Prime");
+        }
+        static const char* surroundModeName(int surroundMode)
+        {
+            if(surroundMode & dsSURROUNDMODE_DDPLUS)
+                return "Dolby Digital Plus";
+            if(surroundMode & dsSURROUNDMODE_DD)
+                return "Dolby Digital 5.1";
+            return "none";
+        }
+
+        //thrown when the HAL executor could not complete a call (deadline missed, breaker open, queue full)
+        //it derives from device::Exception so the existing handler catch blocks fall back to their defaults
+        class HalUnavailable : public device::Exception {
+        public:
+            HalUnavailable(const char* reason)
+                : device::Exception(Core::ERROR_TIMEDOUT, reason)
+            {
+            }
+        };
         
         SERVICE_REGISTRATION(DisplaySettings, 1, 0);
 
         DisplaySettings* DisplaySettings::_instance = nullptr;
 
 		DisplaySettings::DisplaySettings()
-			: PluginHost::JSONRPC()
-			, m_apiVersionNumber((uint32_t)-1/*default max uint32_t so everything gets enabled*/)//TODO(MROLLINS) Can't we access this from jsonrpc interface?
+			: PluginHost::JSONRPC({ 1, 2, 3, 4, 5, 6, 7 })
+			, m_halExecutor(HAL_EXECUTOR_WORKERS, HAL_EXECUTOR_QUEUE_DEPTH, HAL_BREAKER_TRIP_THRESHOLD, HAL_BREAKER_COOLDOWN_MS)
+			, m_resolutionWorkerStop(false)
+			, m_lastResolutionJobId(0)
+			, m_resolutionJobDisplay()
+			, m_postChanges()
+			, m_notificationFilters(std::make_shared<NotificationFilters>())
+			, m_sinkConnected(false)
+			, m_haveSink(false)
+			, m_currentSink()
+			, m_sinkIdentified(false)
+			, m_sinkId()
+			, m_sinkQuirks(SinkQuirks::ALL)
+			, m_sinkPrefetchStop(false)
+			, m_sinkPrefetchPending(false)
+			, m_sinkPrefetching(false)
+			, m_sinkSettleMs(0)
+			, m_sinkGeneration(0)
+			, m_reconcileStop(false)
+			, m_standbySnapshot()
+			, m_standbyPending(false)
+			, m_resumePending(false)
+			, m_statePublisher()
+			, m_publishPending(false)
 		{
-    		logger = fopen("/opt/logs/ds.log", "w");
+            //the logger is shared by every instance and thread (stdio locks each write), open it once
+            if (logger == nullptr)
+                logger = fopen("/opt/logs/ds.log", "a");
+            if (logger == nullptr)
+                logger = stderr;
+            flightRecorder.Open("/opt/logs/ds.trace");
+            for (size_t port = 0; port < PortTable::MAX_PORTS; port++)
+                m_displayConnected[port] = false;
+            m_standbyVideoStates.fill(STANDBY_STATE_UNKNOWN);
+            m_supportedResolutionsValid.fill(false);
+            m_settopHdr.fill(-1);
     		
             MYTRACE();
             DisplaySettings::_instance = this;
-   			Register("getQuirks", &DisplaySettings::getQuirks, this);
-			Register("getConnectedVideoDisplays", &DisplaySettings::getConnectedVideoDisplays, this);
-			Register("getConnectedAudioPorts", &DisplaySettings::getConnectedAudioPorts, this);
-			Register("getSupportedResolutions", &DisplaySettings::getSupportedResolutions, this);
-			Register("getSupportedVideoDisplays", &DisplaySettings::getSupportedVideoDisplays, this);			
-			Register("getSupportedTvResolutions", &DisplaySettings::getSupportedTvResolutions, this);
-			Register("getSupportedSettopResolutions", &DisplaySettings::getSupportedSettopResolutions, this);			
-			Register("getSupportedAudioPorts", &DisplaySettings::getSupportedAudioPorts, this);
-			Register("getSupportedAudioModes", &DisplaySettings::getSupportedAudioModes, this);
-			Register("getZoomSetting", &DisplaySettings::getZoomSetting, this);
-			Register("setZoomSetting", &DisplaySettings::setZoomSetting, this);
-			Register("getCurrentResolution", &DisplaySettings::getCurrentResolution, this);
-			Register("setCurrentResolution", &DisplaySettings::setCurrentResolution, this);
-			Register("getSoundMode", &DisplaySettings::getSoundMode, this);
-			Register("setSoundMode", &DisplaySettings::setSoundMode, this);
-			Register("readEDID", &DisplaySettings::readEDID, this);
-			Register("readHostEDID", &DisplaySettings::readHostEDID, this);
-			Register("getActiveInput", &DisplaySettings::getActiveInput, this);
-			Register("getTvHDRSupport", &DisplaySettings::getTvHDRSupport, this);
-			Register("getSettopHDRSupport", &DisplaySettings::getSettopHDRSupport, this);
-			Register("setVideoPortStatusInStandby", &DisplaySettings::setVideoPortStatusInStandby, this);
-			Register("getVideoPortStatusInStandby", &DisplaySettings::getVideoPortStatusInStandby, this);
-			
-			setApiVersionNumber(7);//TODO(MROLLINS) - this is suppose to be called from xre receiver in DisplaySettingsAPI ctor, but we need to get it from the jsonrpc client version
+            registerMethods<API_VERSION_MAX>(1);
+            registerMethods<2>(2);
+            registerMethods<3>(3);
+            registerMethods<4>(4);
+            registerMethods<5>(5);
+            registerMethods<6>(6);
+            registerMethods<7>(7);
 		}
 		DisplaySettings::~DisplaySettings()
 		{
             MYTRACE();
             DisplaySettings::_instance = nullptr;
-			Unregister("getQuirks");
-			Unregister("getConnectedVideoDisplays");
-			Unregister("getConnectedAudioPorts");
-			Unregister("getSupportedResolutions");
-			Unregister("getSupportedVideoDisplays");
-			Unregister("getSupportedTvResolutions");
-			Unregister("getSupportedSettopResolutions");			
-			Unregister("getSupportedAudioPorts");
-			Unregister("getSupportedAudioModes");
-			Unregister("getZoomSetting");
-			Unregister("setZoomSetting");
-			Unregister("getCurrentResolution");
-			Unregister("setCurrentResolution");
-			Unregister("getSoundMode");
-			Unregister("setSoundMode");
-			Unregister("readEDID");
-			Unregister("readHostEDID");
-			Unregister("getActiveInput");
-			Unregister("getTvHDRSupport");
-			Unregister("getSettopHDRSupport");
-			Unregister("setVideoPortStatusInStandby");
-			Unregister("getVideoPortStatusInStandby");
+            for (const auto& method : m_registeredMethods)
+                method.first->Unregister(method.second);
+            m_registeredMethods.clear();
 		}
-		const string DisplaySettings::Initialize(PluginHost::IShell* /* service */)
+		const string DisplaySettings::Initialize(PluginHost::IShell* service)
 		{
             MYTRACE();
+            //the setter rate limit is the platform's to set, {"setterratelimit":2} in the plugin configuration, no limit without it
+            JsonObject config;
+            uint32_t setterRateLimit = 0;
+            if (service != nullptr && config.FromString(service->ConfigLine()) && config.HasLabel("setterratelimit"))
+                setterRateLimit = (uint32_t)config["setterratelimit"].Number();
+            m_setters.SetLimit(setterRateLimit);
+            logPayloads = config.HasLabel("logpayloads") && config["logpayloads"].Boolean();
+            m_halExecutor.Start();
+            m_resolutionWorkerStop = false;
+            m_resolutionWorkerThread = std::thread(&DisplaySettings::resolutionWorker, this);
+            m_sinkStore.Load(SINK_STORE_PATH);
+            m_sinkPrefetchStop = false;
+            m_sinkThread = std::thread(&DisplaySettings::sinkPrefetchWorker, this);
+            m_reconcileStop = false;
+            m_standbyPending = false;
+            m_resumePending = false;
+            m_publishPending = false;
+            m_reconcileThread = std::thread(&DisplaySettings::shadowReconciler, this);
             InitializeIARM();
+            //native readers map the segment at any time, give them the state as soon as the ports are known
+            if (!m_statePublisher.Open())
+            {
+                MYERROR("could not create the shared display state %s\n", DisplayStateShm::SegmentName);
+            }
+            requestStatePublish();
 			// On success return empty, to indicate there is no error text.
 			return (string());
 		}
@@ -218,6 +425,70 @@ namespace WPEFramework {
 		{
             MYTRACE();
             DeinitializeIARM();
+            eventCapture.Stop();
+            std::deque<ResolutionJob> droppedJobs;
+            {
+                std::lock_guard<std::mutex> guard(m_resolutionLock);
+                m_resolutionWorkerStop = true;
+                droppedJobs.swap(m_resolutionJobs);
+            }
+            m_resolutionSignal.notify_all();
+            if (m_resolutionWorkerThread.joinable())
+                m_resolutionWorkerThread.join();
+            //every job id handed out gets its resolutionChangeComplete, the ones never run fail
+            for (const ResolutionJob& job : droppedJobs)
+            {
+                JsonObject params;
+                params["error_message"] = "plugin deactivated";
+                resolutionJobComplete(job, params, false);
+            }
+            //before the sink thread, a resume validation may be waiting for a sink pass
+            {
+                std::lock_guard<std::mutex> guard(m_reconcileLock);
+                m_reconcileStop = true;
+                m_standbySnapshot = StandbySnapshot();
+            }
+            m_reconcileSignal.notify_all();
+            if (m_reconcileThread.joinable())
+                m_reconcileThread.join();
+            m_statePublisher.Close();
+            {
+                std::lock_guard<std::mutex> guard(m_sinkLock);
+                m_sinkPrefetchStop = true;
+                m_sinkPrefetching = false;
+                m_sinkConnected = false;
+            }
+            m_sinkSignal.notify_all();
+            m_sinkReady.notify_all();
+            if (m_sinkThread.joinable())
+                m_sinkThread.join();
+            m_shadow.Clear();
+            {
+                std::lock_guard<std::mutex> guard(m_lastKnownLock);
+                m_lastKnown.clear();
+            }
+            {
+                std::lock_guard<std::mutex> guard(m_standbyLock);
+                m_standbyVideoStates.fill(STANDBY_STATE_UNKNOWN);
+            }
+            {
+                std::lock_guard<std::mutex> guard(m_audioCapabilitiesLock);
+                m_audioCapabilities.reset();
+            }
+            {
+                //subscribers of the next activation get a full first round of notifications, and no filters
+                std::lock_guard<std::mutex> guard(m_notifyLock);
+                m_lastNotified.clear();
+                m_notificationFilters = std::make_shared<NotificationFilters>();
+            }
+            {
+                //the threads that call them are gone; clients that did not unregister are dropped
+                std::lock_guard<std::mutex> guard(m_comClientsLock);
+                for (Exchange::IDisplaySettings::INotification* client : m_comClients)
+                    client->Release();
+                m_comClients.clear();
+            }
+            m_halExecutor.Stop();
 		}
 		string DisplaySettings::Information() const
 		{
@@ -228,15 +499,8 @@ namespace WPEFramework {
         {
             MYTRACE();
             IARM_Result_t res;
-            IARM_CHECK( IARM_Bus_Init("Display_Settings") );
+            IARM_CHECK( IARM_Bus_Init(IARM_BUS_DISPLAYSETTINGS_NAME) );
             IARM_CHECK( IARM_Bus_Connect() );
-            IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_RX_SENSE, DisplResolutionHandler) );
-            IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_ZOOM_SETTINGS, DisplResolutionHandler) );
-            //TODO(MROLLINS) localinput.cpp has PreChange guared with #if !defined(DISABLE_PRE_RES_CHANGE_EVENTS)
-            //Can we set it all the time from inside here and let localinput put guards around listening for our event?
-            IARM_CHECK( IARM_Bus_RegisterCall(IARM_BUS_COMMON_API_ResolutionPreChange, ResolutionPreChange) );
-            IARM_CHECK( IARM_Bus_RegisterCall(IARM_BUS_COMMON_API_ResolutionPostChange, ResolutionPostChange) );
-            IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME,IARM_BUS_DSMGR_EVENT_HDMI_HOTPLUG, dsHdmiEventHandler) );
             try
             {
                 //TODO(MROLLINS) this is probably per process so we either need to be running in our own process or be carefull no other plugin is calling it
@@ -247,6 +511,20 @@ namespace WPEFramework {
             {
                 MYLOG("device::Manager::Initialize failed\n");            
             }
+            //the handlers below read the port table without locking, so it is complete before they are registered
+            buildPortTable();
+            IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_RX_SENSE, DisplResolutionHandler) );
+            IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_ZOOM_SETTINGS, DisplResolutionHandler) );
+            IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_AUDIO_MODE, DisplResolutionHandler) );
+            //TODO(MROLLINS) localinput.cpp has PreChange guared with #if !defined(DISABLE_PRE_RES_CHANGE_EVENTS)
+            //Can we set it all the time from inside here and let localinput put guards around listening for our event?
+            IARM_CHECK( IARM_Bus_RegisterCall(IARM_BUS_COMMON_API_ResolutionPreChange, ResolutionPreChange) );
+            IARM_CHECK( IARM_Bus_RegisterCall(IARM_BUS_COMMON_API_ResolutionPostChange, ResolutionPostChange) );
+            IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME,IARM_BUS_DSMGR_EVENT_HDMI_HOTPLUG, dsHdmiEventHandler) );
+            //DisplaySettings is the one subscriber for these, other services listen to our hdcpStatusChanged/hdmiInputHotPlug
+            IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME,IARM_BUS_DSMGR_EVENT_HDMI_IN_HOTPLUG, dsHdmiEventHandler) );
+            IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME,IARM_BUS_DSMGR_EVENT_HDCP_STATUS, dsHdmiEventHandler) );
+            IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_EVENT_MODECHANGED, pwrMgrEventHandler) );
         }
         //TODO(MROLLINS) - we need to install crash handler to ensure DeinitializeIARM gets called
         void DisplaySettings::DeinitializeIARM()
@@ -255,6 +533,11 @@ namespace WPEFramework {
             IARM_Result_t res;        
             IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_RX_SENSE) );
             IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_ZOOM_SETTINGS) );
+            IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_AUDIO_MODE) );
+            IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_HDMI_HOTPLUG) );
+            IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_HDMI_IN_HOTPLUG) );
+            IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_HDCP_STATUS) );
+            IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_EVENT_MODECHANGED) );
             IARM_CHECK( IARM_Bus_Disconnect() );
             IARM_CHECK( IARM_Bus_Term() );
             try
@@ -272,6 +555,7 @@ namespace WPEFramework {
 		IARM_Result_t DisplaySettings::ResolutionPreChange(void *arg)
 		{
             MYTRACE();
+            traceIarmCall(__FUNCTION__, IARM_BUS_COMMON_API_ResolutionPreChange, arg, arg ? sizeof(IARM_Bus_CommonAPI_ResChange_Param_t) : 0);
             if(DisplaySettings::_instance)
             {
                 DisplaySettings::_instance->resolutionPreChange();		
@@ -284,6 +568,7 @@ namespace WPEFramework {
             int dw = 1280;
             int dh = 720;
             IARM_Bus_CommonAPI_ResChange_Param_t *eventData = (IARM_Bus_CommonAPI_ResChange_Param_t *)arg;
+            traceIarmCall(__FUNCTION__, IARM_BUS_COMMON_API_ResolutionPostChange, arg, sizeof(*eventData));
             dw = eventData->width;
             dh = eventData->height;
             if(DisplaySettings::_instance)
@@ -294,7 +579,8 @@ namespace WPEFramework {
         }
         void DisplaySettings::DisplResolutionHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
         {
-            MYTRACE();        
+            MYTRACE();
+            traceIarmEvent(__FUNCTION__, owner, eventId, data, len);
             //TODO(MROLLINS) Receiver has this whole thing guarded by #ifndef HEADLESS_GW
             if (strcmp(owner,IARM_BUS_DSMGR_NAME) == 0)
             {
@@ -330,6 +616,14 @@ namespace WPEFramework {
                         }
                     }
                     break;
+                case IARM_BUS_DSMGR_EVENT_AUDIO_MODE:
+                    MYLOG("%s: audio mode changed, refreshing audio capabilities\n",__FUNCTION__);
+                    if(DisplaySettings::_instance)
+                    {
+                        DisplaySettings::_instance->m_shadow.Invalidate(ShadowState::SOUND_MODE);
+                        DisplaySettings::_instance->refreshAudioCapabilities();
+                    }
+                    break;
                 case IARM_BUS_DSMGR_EVENT_RX_SENSE:
                     {
                         
@@ -355,7 +649,8 @@ namespace WPEFramework {
         }
         void DisplaySettings::dsHdmiEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
         {
-            MYTRACE();        
+            MYTRACE();
+            traceIarmEvent(__FUNCTION__, owner, eventId, data, len);
             switch (eventId)
             {
             case IARM_BUS_DSMGR_EVENT_HDMI_HOTPLUG : 
@@ -370,15 +665,15 @@ namespace WPEFramework {
                         DisplaySettings::_instance->connectedVideoDisplaysUpdated(hdmi_hotplug_event);
                 }
                 break;
-                //TODO(MROLLINS) localinput.cpp was also sending these and they were getting handled by services other then DisplaySettings.  Should DisplaySettings own these as well ?
-                /*    
+            //localinput.cpp used to re-broadcast these through ServiceManagerNotifier; DisplaySettings owns them now
             case IARM_BUS_DSMGR_EVENT_HDMI_IN_HOTPLUG : 
                 {
                     IARM_Bus_DSMgr_EventData_t *eventData = (IARM_Bus_DSMgr_EventData_t *)data;
                     int hdmiin_hotplug_port = eventData->data.hdmi_in_connect.port;
-                    int hdmiin_hotplug_conn = eventData->data.hdmi_in_connect.isPortConnected;
-                    MYLOG("Received IARM_BUS_DSMGR_EVENT_HDMI_IN_HOTPLUG  event data:%d, %d \r\n", hdmiin_hotplug_port);
-                    ServiceManagerNotifier::getInstance()->notifyHdmiInputHotPlugEvent(hdmiin_hotplug_port, hdmiin_hotplug_conn);
+                    bool hdmiin_hotplug_conn = eventData->data.hdmi_in_connect.isPortConnected;
+                    MYLOG("Received IARM_BUS_DSMGR_EVENT_HDMI_IN_HOTPLUG  event data:%d, %d \r\n", hdmiin_hotplug_port, (int)hdmiin_hotplug_conn);
+                    if(DisplaySettings::_instance)
+                        DisplaySettings::_instance->hdmiInputHotPlug(hdmiin_hotplug_port, hdmiin_hotplug_conn);
                 }
                 break;
             case IARM_BUS_DSMGR_EVENT_HDCP_STATUS : 
@@ -386,41 +681,306 @@ namespace WPEFramework {
                     IARM_Bus_DSMgr_EventData_t *eventData = (IARM_Bus_DSMgr_EventData_t *)data;
                     int hdcpStatus = eventData->data.hdmi_hdcp.hdcpStatus;
                     MYLOG("Received IARM_BUS_DSMGR_EVENT_HDCP_STATUS  event data:%d \r\n", hdcpStatus);
-                    ServiceManagerNotifier::getInstance()->notifyHdmiOutputHDCPStatus(hdcpStatus);
+                    if(DisplaySettings::_instance)
+                        DisplaySettings::_instance->hdcpStatusChanged(hdcpStatus);
                 }
-                break;	
-                */                
+                break;
             default:
                 //do nothing
                 break;
             }
         }        
-        void setResponseArray(JsonObject& response, const char* key, const vector<string>& items)
+        void DisplaySettings::pwrMgrEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
+        {
+            MYTRACE();
+            traceIarmEvent(__FUNCTION__, owner, eventId, data, len);
+            if (eventId == IARM_BUS_PWRMGR_EVENT_MODECHANGED)
+            {
+                IARM_Bus_PWRMgr_EventData_t *eventData = (IARM_Bus_PWRMgr_EventData_t *)data;
+                MYLOG("Received IARM_BUS_PWRMGR_EVENT_MODECHANGED  event data:%d -> %d \r\n", (int)eventData->data.state.curState, (int)eventData->data.state.newState);
+                if(DisplaySettings::_instance)
+                    DisplaySettings::_instance->powerModeChanged(eventData->data.state.curState, eventData->data.state.newState);
+            }
+        }
+        void DisplaySettings::halApply(const char* name, const string& port, const std::function<void()>& call, uint32_t deadlineMs)
+        {
+            std::exception_ptr error;
+            const uint64_t start = TraceRing::Now();
+            HalExecutor::Result result = m_halExecutor.Run(call, deadlineMs, error);
+            int32_t errorCode = 0;
+            if (error)
+            {
+                try
+                {
+                    std::rethrow_exception(error);
+                }
+                catch (const device::Exception& err)
+                {
+                    errorCode = err.getCode();
+                }
+                catch (...)
+                {
+                    errorCode = -1;
+                }
+            }
+            flightRecorder.Add(TraceRing::HAL_CALL, flightRecorder.Id(name), flightRecorder.NameId(port), start, errorCode, 0, result);
+            DS_TRACE(HalCall, (_T("%s(%s) %s error=%d %llu us"), name, port.c_str(), HalExecutor::ResultName(result), errorCode,
+                (unsigned long long)((TraceRing::Now() - start) / 1000)));
+            if (result != HalExecutor::SUCCESS)
+            {
+                MYERROR("HAL call %s(%s) did not complete: %s\n", name, port.c_str(), HalExecutor::ResultName(result));
+                throw HalUnavailable(HalExecutor::ResultName(result));
+            }
+            if (error)
+                std::rethrow_exception(error);
+        }
+        //the lambda handed in here runs on an executor worker that may outlive the caller, so it must capture by value
+        template<typename T>
+        T DisplaySettings::sinkHalCall(const char* name, const string& port, const std::function<T()>& call)
+        {
+            std::shared_ptr<T> value = std::make_shared<T>();
+            halApply(name, port, [value, call]() { *value = call(); }, HAL_CALL_DEADLINE_MS);
+            //the worker is done with value, so move rather than copy it out
+            return std::move(*value);
+        }
+        template<typename T>
+        T DisplaySettings::halCall(const char* name, const string& port, const std::function<T()>& call)
+        {
+            //one type per call name, so the entry is always the T it was stored as
+            std::pair<const char*, string> key(name, port);
+            T value;
+            try
+            {
+                value = sinkHalCall<T>(name, port, call);
+            }
+            catch (const HalUnavailable&)
+            {
+                std::lock_guard<std::mutex> guard(m_lastKnownLock);
+                auto it = m_lastKnown.find(key);
+                if (it == m_lastKnown.end())
+                    throw;
+                MYWARN("HAL call %s(%s) serving last known value\n", name, port.c_str());
+                return *std::static_pointer_cast<T>(it->second);
+            }
+            //assigned in place once the entry exists, it keeps its buffers
+            std::lock_guard<std::mutex> guard(m_lastKnownLock);
+            std::shared_ptr<void>& known = m_lastKnown[key];
+            if (known)
+                *std::static_pointer_cast<T>(known) = value;
+            else
+                known = std::make_shared<T>(value);
+            return value;
+        }
+        template<typename LIST>
+        void setResponseArray(JsonObject& response, const char* key, const LIST& items)
         {
+            //the items end up in the response, which MYTRACEMETHODFIN logs, so no per item logging here
             JsonArray arr;
             for(auto& i : items)
             {
-                MYLOG("%s adding %s\n", key, i.c_str());
                 arr.Add(JsonValue(i));
             }
             response[key] = arr;
         }
-        uint32_t DisplaySettings::getQuirks(const JsonObject& parameters, JsonObject& response)
+        //drops the names listed before, by their id in table; a name the table has no room for is kept as it is
+        template<typename TABLE, typename LIST>
+        static void uniqueNames(TABLE& table, LIST& names)
+        {
+            typename TABLE::Set seen;
+            LIST unique;
+            for (const string& name : names)
+            {
+                const typename TABLE::Id id = table.Intern(name);
+                if (id == TABLE::NONE || !seen.test(id))
+                {
+                    if (id != TABLE::NONE)
+                        seen.set(id);
+                    unique.emplace_back(name);
+                }
+            }
+            if (unique.size() != names.size())
+                names = unique;
+        }
+        //"format":"compact" asks for the bitmask form of a capability response, see CompactSchema.h
+        static bool compactFormat(const JsonObject& parameters)
+        {
+            return parameters.HasLabel("format") && string(parameters["format"].String()) == "compact";
+        }
+        template<size_t N, typename LIST>
+        void setCompactResponse(JsonObject& response, const char* key, const char* otherKey, const char* const (&table)[N], const LIST& names)
+        {
+            uint32_t mask = 0;
+            JsonArray others;
+            for (const auto& name : names)
+            {
+                uint32_t bit = CompactSchema::Bit(table, name);
+                if (bit)
+                    mask |= bit;
+                else
+                    others.Add(JsonValue(name));
+            }
+            response["schema"] = (uint32_t)CompactSchema::VERSION;
+            response[key] = mask;
+            if (others.Length())
+                response[otherKey] = others;
+        }
+        template<uint32_t VERSION>
+        void DisplaySettings::registerMethods(uint8_t interfaceVersion)
+        {
+            //the method set of one interface version, with the variants for its API level
+            Core::JSONRPC::Handler* handler = GetHandler(interfaceVersion);
+            if (handler == nullptr)
+            {
+                MYERROR("no JSON-RPC handler for interface version %u\n", (unsigned)interfaceVersion);
+                return;
+            }
+            registerMethod(*handler, interfaceVersion, "getQuirks", &DisplaySettings::getQuirks);
+            registerMethod(*handler, interfaceVersion, "getConnectedVideoDisplays", &DisplaySettings::getConnectedVideoDisplays);
+            registerMethod(*handler, interfaceVersion, "getConnectedAudioPorts", &DisplaySettings::getConnectedAudioPorts);
+            registerMethod(*handler, interfaceVersion, "getSupportedResolutions", &DisplaySettings::getSupportedResolutions);
+            registerMethod(*handler, interfaceVersion, "getSupportedVideoDisplays", &DisplaySettings::getSupportedVideoDisplays);
+            registerMethod(*handler, interfaceVersion, "getSupportedAudioPorts", &DisplaySettings::getSupportedAudioPorts);
+            registerMethod(*handler, interfaceVersion, "getZoomSetting", &DisplaySettings::getZoomSetting);
+            registerSetter(*handler, interfaceVersion, "setZoomSetting", &DisplaySettings::setZoomSetting);
+            registerMethod(*handler, interfaceVersion, "getCurrentResolution", &DisplaySettings::getCurrentResolution);
+            registerSetter(*handler, interfaceVersion, "setCurrentResolution", &DisplaySettings::setCurrentResolution);
+            registerSetter(*handler, interfaceVersion, "setCurrentResolutionAsync", &DisplaySettings::setCurrentResolutionAsync);
+            registerMethod(*handler, interfaceVersion, "getSoundMode", &DisplaySettings::getSoundMode<VERSION>);
+            registerSetter(*handler, interfaceVersion, "setSoundMode", &DisplaySettings::setSoundMode<VERSION>);
+            registerMethod(*handler, interfaceVersion, "getHalStatus", &DisplaySettings::getHalStatus);
+            registerMethod(*handler, interfaceVersion, "setCaptureMode", &DisplaySettings::setCaptureMode);
+            registerMethod(*handler, interfaceVersion, "getCaptureMode", &DisplaySettings::getCaptureMode);
+            registerMethod(*handler, interfaceVersion, "setNotificationFilter", &DisplaySettings::setNotificationFilter);
+            registerMethod(*handler, interfaceVersion, "getNotificationStats", &DisplaySettings::getNotificationStats);
+            registerMethod(*handler, interfaceVersion, "getSetterStats", &DisplaySettings::getSetterStats);
+            if (VERSION >= 2)
+            {
+                registerMethod(*handler, interfaceVersion, "getSupportedAudioModes", &DisplaySettings::getSupportedAudioModes<VERSION>);
+            }
+            if (VERSION >= 4)
+            {
+                registerMethod(*handler, interfaceVersion, "readEDID", &DisplaySettings::readEDID);
+                registerMethod(*handler, interfaceVersion, "readHostEDID", &DisplaySettings::readHostEDID);
+            }
+            if (VERSION >= 5)
+            {
+                registerMethod(*handler, interfaceVersion, "getActiveInput", &DisplaySettings::getActiveInput);
+            }
+            if (VERSION >= 6)
+            {
+                registerMethod(*handler, interfaceVersion, "getSupportedTvResolutions", &DisplaySettings::getSupportedTvResolutions);
+                registerMethod(*handler, interfaceVersion, "getSupportedSettopResolutions", &DisplaySettings::getSupportedSettopResolutions);
+                registerMethod(*handler, interfaceVersion, "getTvHDRSupport", &DisplaySettings::getTvHDRSupport);
+                registerMethod(*handler, interfaceVersion, "getSettopHDRSupport", &DisplaySettings::getSettopHDRSupport);
+                //only a selection that is applied changes the resolution
+                registerSetter(*handler, interfaceVersion, "selectBestResolution", &DisplaySettings::selectBestResolution, [](const JsonObject& request) {
+                    return request.HasLabel("apply") && request["apply"].Boolean();
+                });
+            }
+            if (VERSION >= 7)
+            {
+                registerMethod(*handler, interfaceVersion, "setVideoPortStatusInStandby", &DisplaySettings::setVideoPortStatusInStandby);
+                registerMethod(*handler, interfaceVersion, "getVideoPortStatusInStandby", &DisplaySettings::getVideoPortStatusInStandby);
+                registerMethod(*handler, interfaceVersion, "getAllVideoPortStatusInStandby", &DisplaySettings::getAllVideoPortStatusInStandby);
+            }
+        }
+        //every JSON-RPC request goes into the capture here, with the interface version and channel it came in on
+        template<typename METHOD>
+        void DisplaySettings::registerMethod(Core::JSONRPC::Handler& handler, uint8_t version, const char* name, const METHOD& method)
+        {
+            handler.Register(name, [this, name, version, method](const Core::JSONRPC::Context& context, const string&, const string& parameters, string& result) -> uint32_t {
+                if (eventCapture.IsEnabled())
+                    eventCapture.Request(version, context.ChannelId(), name, parameters);
+                JsonObject request;
+                JsonObject response;
+                if (!parameters.empty() && !request.FromString(parameters))
+                    return Core::ERROR_BAD_REQUEST;
+                const uint32_t error = (this->*method)(request, response);
+                if (error != Core::ERROR_NONE)
+                    return error;
+                response.ToString(result);
+                return Core::ERROR_NONE;
+            });
+            m_registeredMethods.emplace_back(&handler, name);
+        }
+        //setters that resync the TV or the audio path are subject to the optional rate limit, see SetterQueue,
+        //counted per JSON-RPC channel so a client can neither pick its bucket nor share another's; limited
+        //tells the requests that change something from those that do not, all of them when not given.
+        //Admission happens here, in front of the JSON-RPC entry only: the handlers are shared with the
+        //IDisplaySettings implementation, whose in process callers are not rate limited.
+        template<typename METHOD>
+        void DisplaySettings::registerSetter(Core::JSONRPC::Handler& handler, uint8_t version, const char* name, const METHOD& method, bool (*limited)(const JsonObject&))
         {
+            const string setting(name);
+            handler.Register(name, [this, name, setting, version, method, limited](const Core::JSONRPC::Context& context, const string&, const string& parameters, string& result) -> uint32_t {
+                //before admission, a replay has to see the requests the rate limit turned away too
+                if (eventCapture.IsEnabled())
+                    eventCapture.Request(version, context.ChannelId(), name, parameters);
+                JsonObject request;
+                JsonObject response;
+                if (!parameters.empty() && !request.FromString(parameters))
+                    return Core::ERROR_BAD_REQUEST;
+                if ((limited == nullptr || limited(request)) && !m_setters.Admit(setting, std::to_string(context.ChannelId())))
+                {
+                    MYWARN("method %s rejected, channel %u over the rate limit\n", setting.c_str(), context.ChannelId());
+                    response["rateLimited"] = true;
+                    response["success"] = false;
+                }
+                else
+                {
+                    const uint32_t error = (this->*method)(request, response);
+                    if (error != Core::ERROR_NONE)
+                        return error;
+                }
+                response.ToString(result);
+                return Core::ERROR_NONE;
+            });
+            m_registeredMethods.emplace_back(&handler, name);
+        }
+        uint32_t DisplaySettings::getQuirks(const JsonObject& parameters, JsonObject& response)
+        {   //sample response: {"quirks":["XRE-7389"],"sink":{"manufacturer":"SAM","product":"0x0f47","serial":"0x01000e00"},"success":true}
             MYTRACEMETHOD();
+            //a sink we could not identify (or none yet) gets every quirk, as before the table
+            bool identified = false;
+            SinkQuirks::Id id = SinkQuirks::Id();
+            uint32_t quirks = SinkQuirks::ALL;
+            {
+                std::unique_lock<std::mutex> lock(m_sinkLock);
+                if (waitForSink(lock) && m_sinkIdentified)
+                {
+                    identified = true;
+                    id = m_sinkId;
+                    quirks = m_sinkQuirks;
+                }
+            }
             JsonArray array;
-            array.Add("XRE-7389");
-            array.Add("DELIA-16415");
-            array.Add("RDK-16024");
-            array.Add("DELIA-18552");
+            for (unsigned bit = 0; bit < SinkQuirks::COUNT; bit++)
+            {
+                if (quirks & (1u << bit))
+                    array.Add(SinkQuirks::Name(bit));
+            }
             response["quirks"] = array;
+            if (identified)
+            {
+                char manufacturer[4];
+                char product[7];
+                char serial[11];
+                SinkQuirks::ManufacturerName(id.manufacturer, manufacturer);
+                snprintf(product, sizeof(product), "0x%04x", id.product);
+                snprintf(serial, sizeof(serial), "0x%08x", id.serial);
+                JsonObject sink;
+                sink["manufacturer"] = string(manufacturer);
+                sink["product"] = string(product);
+                sink["serial"] = string(serial);
+                response["sink"] = sink;
+            }
             returnResponse(true);
         }
         uint32_t DisplaySettings::getConnectedVideoDisplays(const JsonObject& parameters, JsonObject& response)
         {   //sample servicemanager response: {"connectedVideoDisplays":["HDMI0"],"success":true}
             //this                          : {"connectedVideoDisplays":["HDMI0"]}
             MYTRACEMETHOD();
-            vector<string> connectedVideoDisplays;
+            PortNameList connectedVideoDisplays;
             getConnectedVideoDisplaysHelper(connectedVideoDisplays);
             setResponseArray(response, "connectedVideoDisplays", connectedVideoDisplays);
             returnResponse(true);
@@ -428,19 +988,25 @@ namespace WPEFramework {
         uint32_t DisplaySettings::getConnectedAudioPorts(const JsonObject& parameters, JsonObject& response)
         {   //sample servicemanager response: {"success":true,"connectedAudioPorts":["HDMI0"]}
             MYTRACEMETHOD();
-            vector<string> connectedAudioPorts;
+            PortNameList connectedAudioPorts;
             try
             {
-                device::List<device::AudioOutputPort> aPorts = device::Host::getInstance().getAudioOutputPorts();
-                for (size_t i = 0; i < aPorts.size(); i++)
-                {
-                    device::AudioOutputPort &aPort = aPorts.at(i);
-                    if (aPort.isConnected())
+                connectedAudioPorts = halCall<PortNameList>("getAudioOutputPorts", "", []() {
+                    PortNameList connected;
+                    device::List<device::AudioOutputPort> aPorts = device::Host::getInstance().getAudioOutputPorts();
+                    for (size_t i = 0; i < aPorts.size(); i++)
                     {
-                        string portName = aPort.getName();
-                        vectorSet(connectedAudioPorts, portName);
+                        device::AudioOutputPort &aPort = aPorts.at(i);
+                        if (aPort.isConnected())
+                        {
+                            const string& portName = aPort.getName();
+                            connected.emplace_back(portName);
+                        }
                     }
-                }
+                    warnIfSpilled("getAudioOutputPorts", connected);
+                    return connected;
+                });
+                uniqueNames(m_portNames, connectedAudioPorts);
             }
             catch(const device::Exception& err)
             {
@@ -452,38 +1018,29 @@ namespace WPEFramework {
         uint32_t DisplaySettings::getSupportedResolutions(const JsonObject& parameters, JsonObject& response)
         {   //sample servicemanager response:{"success":true,"supportedResolutions":["720p","1080i","1080p60"]}
             MYTRACEMETHOD();
-            string videoDisplay = parameters.HasLabel("videoDisplay") ? parameters["videoDisplay"].String() : "HDMI0";
-            vector<string> supportedResolutions;
+            string videoDisplay = parameters.HasLabel("videoDisplay") ? parameters["videoDisplay"].String() : m_ports.PrimaryHdmiName();
+            ResolutionNameList supportedResolutions;
             try
             {
-                device::VideoOutputPort &vPort = device::Host::getInstance().getVideoOutputPort(videoDisplay);
-                const device::List<device::VideoResolution> resolutions = device::VideoOutputPortConfig::getInstance().getPortType(vPort.getType().getId()).getSupportedResolutions();
-                for (size_t i = 0; i < resolutions.size(); i++) {
-                    const device::VideoResolution &resolution = resolutions.at(i);
-                    string supportedResolution = resolution.getName();
-                    vectorSet(supportedResolutions,supportedResolution);
-                }
+                getSupportedResolutionsHelper(videoDisplay, supportedResolutions);
             }
             catch(const device::Exception& err)
             {
                 LOG_DEVICE_EXCEPTION1(videoDisplay);
             }
-            setResponseArray(response, "supportedResolutions", supportedResolutions);
+            if (compactFormat(parameters))
+                setCompactResponse(response, "resolutions", "otherResolutions", CompactSchema::Resolutions, supportedResolutions);
+            else
+                setResponseArray(response, "supportedResolutions", supportedResolutions);
             returnResponse(true);
         }
         uint32_t DisplaySettings::getSupportedVideoDisplays(const JsonObject& parameters, JsonObject& response)
         {   //sample servicemanager response: {"supportedVideoDisplays":["HDMI0"],"success":true}
             MYTRACEMETHOD();
-            vector<string> supportedVideoDisplays;
+            PortNameList supportedVideoDisplays;
             try
             {
-                device::List<device::VideoOutputPort> vPorts = device::Host::getInstance().getVideoOutputPorts();
-                for (size_t i = 0; i < vPorts.size(); i++)
-                {
-                    device::VideoOutputPort &vPort = vPorts.at(i);
-                    string videoDisplay = vPort.getName();
-                    vectorSet(supportedVideoDisplays, videoDisplay);
-                }
+                getSupportedVideoDisplaysHelper(supportedVideoDisplays);
             }
             catch (const device::Exception& err)
             {
@@ -494,48 +1051,49 @@ namespace WPEFramework {
         }
         uint32_t DisplaySettings::getSupportedTvResolutions(const JsonObject& parameters, JsonObject& response)
         {   //sample servicemanager response:{"success":true,"supportedTvResolutions":["480i","480p","576i","720p","1080i","1080p"]}
+            //sample compact response:{"schema":1,"tvResolutions":127,"success":true}
             MYTRACEMETHOD();
-            returnIfWrongApiVersion(6);
-            string videoDisplay = parameters.HasLabel("videoDisplay") ? parameters["videoDisplay"].String() : "HDMI0";
-            vector<string> supportedTvResolutions;
+            string videoDisplay = parameters.HasLabel("videoDisplay") ? parameters["videoDisplay"].String() : m_ports.PrimaryHdmiName();
+            FixedList<const char*, 10> supportedTvResolutions;
+            int resolutions = 0;
             try
             {
-                int tvResolutions = 0;
-                device::VideoOutputPort &vPort = device::Host::getInstance().getVideoOutputPort(videoDisplay);
-                vPort.getSupportedTvResolutions(&tvResolutions);
-                if(!tvResolutions)supportedTvResolutions.emplace_back("none");
-                if(tvResolutions & dsTV_RESOLUTION_480i)supportedTvResolutions.emplace_back("480i");
-                if(tvResolutions & dsTV_RESOLUTION_480p)supportedTvResolutions.emplace_back("480p");
-                if(tvResolutions & dsTV_RESOLUTION_576i)supportedTvResolutions.emplace_back("576i");
-                if(tvResolutions & dsTV_RESOLUTION_576p)supportedTvResolutions.emplace_back("576p");
-                if(tvResolutions & dsTV_RESOLUTION_720p)supportedTvResolutions.emplace_back("720p");
-                if(tvResolutions & dsTV_RESOLUTION_1080i)supportedTvResolutions.emplace_back("1080i");
-                if(tvResolutions & dsTV_RESOLUTION_1080p)supportedTvResolutions.emplace_back("1080p");
-                if(tvResolutions & dsTV_RESOLUTION_2160p30)supportedTvResolutions.emplace_back("2160p30");
-                if(tvResolutions & dsTV_RESOLUTION_2160p60)supportedTvResolutions.emplace_back("2160p60");
+                resolutions = sinkTvResolutions(videoDisplay);
             }
             catch(const device::Exception& err)
             {
                 LOG_DEVICE_EXCEPTION1(videoDisplay);
             }
+            if (compactFormat(parameters))
+            {
+                response["schema"] = (uint32_t)CompactSchema::VERSION;
+                response["tvResolutions"] = resolutions;
+                returnResponse(true);
+            }
+            tvResolutionNames(resolutions, supportedTvResolutions);
             setResponseArray(response, "supportedTvResolutions", supportedTvResolutions);
             returnResponse(true);
         }
         uint32_t DisplaySettings::getSupportedSettopResolutions(const JsonObject& parameters, JsonObject& response)
         {   //sample servicemanager response:{"success":true,"supportedSettopResolutions":["720p","1080i","1080p60"]}
             MYTRACEMETHOD();
-            returnIfWrongApiVersion(6);
-            std::vector<string> supportedSettopResolutions;
+            size_t decoder = 0;
+            returnIfDecoderNotFound(decoder);
+            ResolutionNameList supportedSettopResolutions;
             try
             {
-                device::VideoDevice &device = device::Host::getInstance().getVideoDevices().at(0);
-                std::list<std::string> resolutions;
-                device.getSettopSupportedResolutions(resolutions);
-                for (std::list<std::string>::const_iterator ci = resolutions.begin(); ci != resolutions.end(); ++ci)
-                {
-                      string supportedResolution = *ci;
-                      vectorSet(supportedSettopResolutions, supportedResolution);
-                }
+                supportedSettopResolutions = halCall<ResolutionNameList>("getSettopSupportedResolutions", m_ports.DecoderName(decoder), [decoder]() {
+                    ResolutionNameList supportedSettopResolutions;
+                    std::list<std::string> resolutions;
+                    device::Host::getInstance().getVideoDevices().at(decoder).getSettopSupportedResolutions(resolutions);
+                    for (std::list<std::string>::const_iterator ci = resolutions.begin(); ci != resolutions.end(); ++ci)
+                    {
+                        supportedSettopResolutions.emplace_back(*ci);
+                    }
+                    warnIfSpilled("getSettopSupportedResolutions", supportedSettopResolutions);
+                    return supportedSettopResolutions;
+                });
+                uniqueNames(m_resolutionNames, supportedSettopResolutions);
             }
             catch(const device::Exception& err)
             {
@@ -547,16 +1105,22 @@ namespace WPEFramework {
         uint32_t DisplaySettings::getSupportedAudioPorts(const JsonObject& parameters, JsonObject& response)
         {   //sample servicemanager response: {"success":true,"supportedAudioPorts":["HDMI0"]}
             MYTRACEMETHOD();
-            vector<string> supportedAudioPorts;
+            PortNameList supportedAudioPorts;
             try
             {
-                device::List<device::AudioOutputPort> aPorts = device::Host::getInstance().getAudioOutputPorts();
-                for (size_t i = 0; i < aPorts.size(); i++)
-                {
-                    device::AudioOutputPort &vPort = aPorts.at(i);
-                    string portName  = vPort.getName();
-                    vectorSet(supportedAudioPorts,portName);
-                }
+                supportedAudioPorts = halCall<PortNameList>("getSupportedAudioPorts", "", []() {
+                    PortNameList names;
+                    device::List<device::AudioOutputPort> aPorts = device::Host::getInstance().getAudioOutputPorts();
+                    for (size_t i = 0; i < aPorts.size(); i++)
+                    {
+                        device::AudioOutputPort &vPort = aPorts.at(i);
+                        const string& portName  = vPort.getName();
+                        names.emplace_back(portName);
+                    }
+                    warnIfSpilled("getSupportedAudioPorts", names);
+                    return names;
+                });
+                uniqueNames(m_portNames, supportedAudioPorts);
             }
             catch(const device::Exception& err)
             {
@@ -565,87 +1129,71 @@ namespace WPEFramework {
             setResponseArray(response, "supportedAudioPorts", supportedAudioPorts);
             returnResponse(true);
         }
+        template<uint32_t VERSION>
         uint32_t DisplaySettings::getSupportedAudioModes(const JsonObject& parameters, JsonObject& response)
         {   //sample response: {"success":true,"supportedAudioModes":["STEREO","PASSTHRU","AUTO (Dolby Digital 5.1)"]}
             MYTRACEMETHOD();
-            returnIfWrongApiVersion(2);
-            string audioPort = parameters["audioPort"].String();
-            vector<string> supportedAudioModes;
-            try
+            AudioModeNameList supportedAudioModes;
+            getSupportedAudioModesHelper<VERSION>(parameters["audioPort"].String(), supportedAudioModes);
+            if (compactFormat(parameters))
+                setCompactResponse(response, "audioModes", "otherAudioModes", CompactSchema::AudioModes, supportedAudioModes);
+            else
+                setResponseArray(response, "supportedAudioModes", supportedAudioModes);
+            returnResponse(true);
+        }
+        template<uint32_t VERSION>
+        void DisplaySettings::getSupportedAudioModesHelper(const string& audioPort, AudioModeNameList& supportedAudioModes)
+        {
+            //answered from the capability matrix, no HAL calls here; see refreshAudioCapabilities
+            std::shared_ptr<const AudioCapabilities> capabilities = audioCapabilities();
+            if (capabilities)
             {
+                const AudioCapabilities::VersionBucket bucket = (VERSION >= 5) ? AudioCapabilities::DS5 : AudioCapabilities::DS4;
                 bool HAL_hasSurround = false;
-                
-                device::List<device::VideoOutputPort> vPorts = device::Host::getInstance().getVideoOutputPorts();
-                for (size_t i = 0; i < vPorts.size(); i++) {
-                    device::AudioOutputPort &aPort = vPorts.at(i).getAudioOutputPort();
-                    for (size_t i = 0; i < aPort.getSupportedStereoModes().size(); i++) {
-                        if (audioPort.empty() || stringContains(aPort.getName(), audioPort.c_str()))
-                        {
-                            string audioMode = aPort.getSupportedStereoModes().at(i).getName();
-                            
-                            // Starging Version 5, "Surround" mode is replaced by "Auto Mode"
-                            if ((getApiVersionNumber() >= 5) && (strcasecmp(audioMode.c_str(),"SURROUND") == 0)) 
-                            {
-                                HAL_hasSurround = true;
-                                continue;
-                            }
-
-                            if ((getApiVersionNumber() < 5) && (strcasecmp(audioMode.c_str(),"PASSTHRU") == 0)) 
-                            {
-                                /* Do not support PASSTHRU in DS 4 or lower */
-                                continue;
-                            }
-
-                            vectorSet(supportedAudioModes,audioMode);
-                        }
+                AudioModeNames::Set modes;
+                for (const AudioCapabilities::AudioPort& port : capabilities->audioPorts)
+                {
+                    if (audioPort.empty() || stringContains(port.name, audioPort.c_str()))
+                    {
+                        modes |= port.modes[bucket];
+                        HAL_hasSurround = HAL_hasSurround || port.hasSurround;
                     }
                 }
+                //in the order the HAL reports the modes, ids are older than this matrix and do not keep it
+                for (AudioModeNames::Id id : capabilities->modeOrder)
+                {
+                    if (modes.test(id))
+                        supportedAudioModes.emplace_back(m_audioModeNames.Name(id).c_str());
+                }
                 /* Version 5: Append Auto Mode for HDMI ports*/
-                if (getApiVersionNumber() >= 5 && (audioPort.empty() || stringContains(audioPort, "HDMI")))
+                if (VERSION >= 5 && (audioPort.empty() || stringContains(audioPort, "HDMI")))
                 {
-                    device::VideoOutputPort vPort = device::VideoOutputPortConfig::getInstance().getPort("HDMI0");
-                    int surroundMode = vPort.getDisplay().getSurroundMode();
-                    if (vPort.isDisplayConnected() && surroundMode)
+                    const string& hdmiPort = m_ports.HdmiPortName(audioPort);
+                    for (const AudioCapabilities::HdmiPort& port : capabilities->hdmiPorts)
                     {
-                        if(surroundMode & dsSURROUNDMODE_DDPLUS )
-                        {
-                            MYLOG("HDMI0 has surround DD Plus \n");
-                            supportedAudioModes.emplace_back("AUTO (Dolby Digital Plus)");
-                        }
-                        else if(surroundMode & dsSURROUNDMODE_DD )
-                        {
-                            MYLOG("HDMI0 has surround DD5.1 \n");
-                            supportedAudioModes.emplace_back("AUTO (Dolby Digital 5.1)");
-                        }
-                    }
-                    else {
-                        MYLOG("HDMI0 does not have surround\n");
-                        supportedAudioModes.emplace_back("AUTO (Stereo)");
+                        if (port.name == hdmiPort && port.autoMode != AudioModeNames::NONE)
+                            supportedAudioModes.emplace_back(m_audioModeNames.Name(port.autoMode).c_str());
                     }
                 }
-                if (getApiVersionNumber() >= 5 && (audioPort.empty() || stringContains(audioPort, "SPDIF")))
+                if (VERSION >= 5 && (audioPort.empty() || stringContains(audioPort, "SPDIF")))
                 {
                     if (HAL_hasSurround) {
                         supportedAudioModes.emplace_back("Surround");
                     }
                 }
             }
-            catch(const device::Exception& err)
-            {
-                LOG_DEVICE_EXCEPTION1(audioPort);
-            }
-            setResponseArray(response, "supportedAudioModes", supportedAudioModes);
-            returnResponse(true);
         }
         uint32_t DisplaySettings::getZoomSetting(const JsonObject& parameters, JsonObject& response)
         {   //sample servicemanager response:
             MYTRACEMETHOD();
+            size_t decoder = 0;
+            returnIfDecoderNotFound(decoder);
             string zoomSetting = "unknown";
             try
             {
-                // TODO: why is this always the first one in the list
-                device::VideoDevice &decoder = device::Host::getInstance().getVideoDevices().at(0);
-                zoomSetting = decoder.getDFC().getName();
+                zoomSetting = shadowRead(ShadowState::ZOOM, m_ports.DecoderName(decoder), [this, decoder]() {
+                    return halZoomSetting(decoder);
+                });
             }
             catch(const device::Exception& err)
             {
@@ -662,15 +1210,16 @@ namespace WPEFramework {
             MYTRACEMETHOD();
             string zoomSetting = parameters["zoomSetting"].String();
             returnIfParamNotFound(zoomSetting);
+            size_t decoder = 0;
+            returnIfDecoderNotFound(decoder);
             bool success = true;
             try
             {
 #ifdef USE_IARM
                 zoomSetting = svc2iarm(zoomSetting);
 #endif
-                // TODO: why is this always the first one in the list? 
-                device::VideoDevice &decoder = device::Host::getInstance().getVideoDevices().at(0);
-                decoder.setDFC(zoomSetting);
+                if (applyZoomSetting(decoder, zoomSetting) == SetterQueue::COALESCED)
+                    response["coalesced"] = true;
             }
             catch(const device::Exception& err)
             {
@@ -682,12 +1231,13 @@ namespace WPEFramework {
         uint32_t DisplaySettings::getCurrentResolution(const JsonObject& parameters, JsonObject& response)
         {   //sample servicemanager response:{"success":true,"resolution":"720p"}
             MYTRACEMETHOD();
-            string videoDisplay = parameters.HasLabel("videoDisplay") ? parameters["videoDisplay"].String() : "HDMI0";
+            string videoDisplay = parameters.HasLabel("videoDisplay") ? parameters["videoDisplay"].String() : m_ports.PrimaryHdmiName();
             bool success = true;
             try
             {
-                device::VideoOutputPort &vPort = device::Host::getInstance().getVideoOutputPort(videoDisplay);
-                response["resolution"] = vPort.getResolution().getName();
+                response["resolution"] = shadowRead(ShadowState::RESOLUTION, videoDisplay, [this, videoDisplay]() {
+                    return halResolution(videoDisplay);
+                });
             }
             catch(const device::Exception& err)
             {
@@ -706,8 +1256,9 @@ namespace WPEFramework {
             bool success = true;
             try
             {
-                device::VideoOutputPort &vPort = device::Host::getInstance().getVideoOutputPort(videoDisplay);
-                vPort.setResolution(resolution);
+                //a request replaced while waiting reports success, the newer resolution is what gets applied
+                if (applyResolution(videoDisplay, resolution) == SetterQueue::COALESCED)
+                    response["coalesced"] = true;
             }
             catch (const device::Exception& err)
             {
@@ -716,13 +1267,133 @@ namespace WPEFramework {
             }
             returnResponse(success);
         }
+        uint32_t DisplaySettings::setCurrentResolutionAsync(const JsonObject& parameters, JsonObject& response)
+        {   //sample response: {"jobId":3,"success":true}
+            //completion is reported via {"name":"resolutionChangeComplete","params":{"jobId":3,"videoDisplay":"HDMI0","resolution":"1080p60","width":1920,"height":1080,"success":true}}
+            MYTRACEMETHOD();
+            string videoDisplay = parameters["videoDisplay"].String();
+            string resolution = parameters["resolution"].String();
+            returnIfParamNotFound(videoDisplay);
+            returnIfParamNotFound(resolution);
+            ResolutionNameList supportedResolutions;
+            try
+            {
+                getSupportedResolutionsHelper(videoDisplay, supportedResolutions);
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION2(videoDisplay, resolution);
+                response["error_message"] = err.what();
+                returnResponse(false);
+            }
+            if (!supportsResolution(videoDisplay, resolution, supportedResolutions))
+            {
+                MYWARN("setCurrentResolutionAsync: %s does not support %s\n", videoDisplay.c_str(), resolution.c_str());
+                response["error_message"] = "unsupported resolution";
+                returnResponse(false);
+            }
+            const uint32_t jobId = queueResolutionJob(videoDisplay, resolution);
+            if (jobId == 0)
+            {
+                response["error_message"] = "too many resolution jobs";
+                returnResponse(false);
+            }
+            response["jobId"] = jobId;
+            returnResponse(true);
+        }
+        uint32_t DisplaySettings::selectBestResolution(const JsonObject& parameters, JsonObject& response)
+        {   //sample request: {"videoDisplay":"HDMI0","videoDecoder":0,"policy":{"maxHeight":1080,"frameRate":60,"progressiveOnly":true},"apply":true}
+            //sample response: {"resolution":"1080p60","candidates":4,"tvFiltered":true,"hdrStandards":["HDR10"],"jobId":4,"success":true}
+            MYTRACEMETHOD();
+            string videoDisplay = parameters.HasLabel("videoDisplay") ? parameters["videoDisplay"].String() : m_ports.PrimaryHdmiName();
+            //the decoder whose HDR support is matched with the TV's, like getSettopHDRSupport
+            size_t decoder = 0;
+            returnIfDecoderNotFound(decoder);
+            ModeSelector::Policy policy;
+            if (parameters.HasLabel("policy"))
+            {
+                const JsonObject requested = parameters["policy"].Object();
+                if (requested.HasLabel("maxHeight"))
+                    policy.maxHeight = (uint32_t)requested["maxHeight"].Number();
+                if (requested.HasLabel("frameRate"))
+                    policy.frameRate = (uint32_t)requested["frameRate"].Number();
+                if (requested.HasLabel("progressiveOnly"))
+                    policy.progressiveOnly = requested["progressiveOnly"].Boolean();
+            }
+            //every input is normally in memory: settop modes per port and settop HDR are cached, the TV side comes from the sink store
+            ResolutionNameList settopResolutions;
+            int tvResolutionMask = 0;
+            int tvHdr = dsHDRSTANDARD_NONE;
+            int settopHdr = dsHDRSTANDARD_NONE;
+            try
+            {
+                getSupportedResolutionsHelper(videoDisplay, settopResolutions);
+                settopHdr = settopHdrCapabilities(decoder);
+                SinkCapabilityStore::Sink sink;
+                if (currentSinkCapabilities(videoDisplay, sink))
+                {
+                    tvResolutionMask = sink.tvResolutions;
+                    tvHdr = sink.hdrCapabilities;
+                }
+                else
+                {
+                    tvResolutionMask = sinkHalCall<int>("getSupportedTvResolutions", videoDisplay, [videoDisplay]() {
+                        return tvResolutions(videoDisplay);
+                    });
+                    tvHdr = sinkHalCall<int>("getTVHDRCapabilities", videoDisplay, [videoDisplay]() {
+                        return tvHdrCapabilities(videoDisplay);
+                    });
+                }
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION1(videoDisplay);
+                response["error_message"] = err.what();
+                returnResponse(false);
+            }
+            size_t candidates = 0;
+            size_t best = ModeSelector::Select(settopResolutions.begin(), settopResolutions.size(), tvResolutionMask, policy, candidates);
+            if (best == ModeSelector::NONE)
+            {
+                MYWARN("selectBestResolution: no mode on %s fits the TV and the policy\n", videoDisplay.c_str());
+                response["error_message"] = "no matching resolution";
+                returnResponse(false);
+            }
+            const string& resolution = settopResolutions[best];
+            JsonArray hdrStandards;
+            hdrStandardNames(tvHdr & settopHdr, hdrStandards);
+            response["resolution"] = resolution;
+            response["candidates"] = (uint32_t)candidates;
+            response["tvFiltered"] = (tvResolutionMask != 0);
+            response["hdrStandards"] = hdrStandards;
+            if (parameters.HasLabel("apply") && parameters["apply"].Boolean())
+            {
+                //applied like setCurrentResolutionAsync, completion comes as resolutionChangeComplete
+                const uint32_t jobId = queueResolutionJob(videoDisplay, resolution);
+                if (jobId == 0)
+                {
+                    response["error_message"] = "too many resolution jobs";
+                    returnResponse(false);
+                }
+                response["jobId"] = jobId;
+            }
+            returnResponse(true);
+        }
+        template<uint32_t VERSION>
         uint32_t DisplaySettings::getSoundMode(const JsonObject& parameters, JsonObject& response)
         {   //sample servicemanager response:{"success":true,"soundMode":"AUTO (Dolby Digital 5.1)"}
             MYTRACEMETHOD();
-            string videoDisplay = parameters["videoDisplay"].String();//empty value will browse all ports
+            string soundMode;
+            getSoundModeHelper<VERSION>(parameters["videoDisplay"].String(), soundMode);//empty value will browse all ports
+            response["soundMode"] = soundMode;
+            returnResponse(true);
+        }
+        template<uint32_t VERSION>
+        void DisplaySettings::getSoundModeHelper(string videoDisplay, string& soundMode)
+        {
             bool validPortName = true;
 
-            if (getApiVersionNumber() < 5)
+            if (VERSION < 5)
             {
                 /* Convert videoDisplay to connected audio ports */
                 if (videoDisplay.empty()) 
@@ -731,7 +1402,7 @@ namespace WPEFramework {
                 }
                 else if (stringContains(videoDisplay,"HDMI"))
                 {
-                    videoDisplay = "HDMI0";        
+                    videoDisplay = m_ports.HdmiPortName(videoDisplay);
                 }
                 else if (stringContains(videoDisplay,"COMPONENT"))
                 {
@@ -751,7 +1422,7 @@ namespace WPEFramework {
                 }
                 if (stringContains(videoDisplay,"HDMI"))
                 {
-                    videoDisplay = "HDMI0";        
+                    videoDisplay = m_ports.HdmiPortName(videoDisplay);
                 }
                 else if (stringContains(videoDisplay,"SPDIF"))
                 {
@@ -764,104 +1435,131 @@ namespace WPEFramework {
             }
 
             if (!validPortName) 
-                videoDisplay = "HDMI0";
-
-            string modeString("");
-            device::AudioStereoMode mode = device::AudioStereoMode::kStereo;  //default to stereo
+                videoDisplay = m_ports.PrimaryHdmiName();
+
+            //the answer depends on the requested port and on the DS4/DS5 naming
+            const string shadowKey = videoDisplay + ((VERSION >= 5) ? "/5" : "/4");
+            string shadowMode;
+            if (m_shadow.Get(ShadowState::SOUND_MODE, shadowKey, shadowMode))
+            {
+                soundMode = shadowMode;
+                return;
+            }
+            const uint64_t shadowGeneration = m_shadow.Generation(ShadowState::SOUND_MODE);
+            bool halRead = true;
+
+            string modeString("");
+            device::AudioStereoMode mode = device::AudioStereoMode::kStereo;  //default to stereo
 
             try
             {
                 /* Return the sound mode of the audio ouput connected to the specified videoDisplay */
                 /* Check if HDMI is connected - Return (default) Stereo Mode if not connected */
-                if (videoDisplay.empty()) 
-                {
-                    if (device::Host::getInstance().getVideoOutputPort("HDMI0").isDisplayConnected()) 
-                    {
-                        videoDisplay = "HDMI0";
-                    }
-                    else 
+                const string primaryHdmi = m_ports.PrimaryHdmiName();
+                videoDisplay = halCall<string>("getSoundModePort", videoDisplay, [videoDisplay, primaryHdmi]() {
+                    string videoDisplayPort = videoDisplay;
+                    if (videoDisplayPort.empty()) 
                     {
-                        /*  * If HDMI is not connected  
-                            * Get the SPDIF if it is supported by platform
-                            * If Platform does not have connected ports. Default to HDMI.
-                        */
-                        videoDisplay = "HDMI0";    
-                        device::List<device::VideoOutputPort> vPorts = device::Host::getInstance().getVideoOutputPorts();
-                        for (size_t i = 0; i < vPorts.size(); i++) 
+                        if (device::Host::getInstance().getVideoOutputPort(primaryHdmi).isDisplayConnected()) 
                         {
-                            device::VideoOutputPort &vPort = vPorts.at(i);
-                            if (vPort.isDisplayConnected())
+                            videoDisplayPort = primaryHdmi;
+                        }
+                        else 
+                        {
+                            /*  * If HDMI is not connected  
+                                * Get the SPDIF if it is supported by platform
+                                * If Platform does not have connected ports. Default to HDMI.
+                            */
+                            videoDisplayPort = primaryHdmi;
+                            device::List<device::VideoOutputPort> vPorts = device::Host::getInstance().getVideoOutputPorts();
+                            for (size_t i = 0; i < vPorts.size(); i++) 
                             {
-                                videoDisplay = "SPDIF0";
-                                break;
+                                device::VideoOutputPort &vPort = vPorts.at(i);
+                                if (vPort.isDisplayConnected())
+                                {
+                                    videoDisplayPort = "SPDIF0";
+                                    break;
+                                }
                             }
                         }
                     }
-                }
+                    return videoDisplayPort;
+                });
 
-                device::AudioOutputPort aPort = device::Host::getInstance().getAudioOutputPort(videoDisplay);
+                //the sink's surround support is normally known from the hotplug prefetch, -1 asks the HAL
+                SinkCapabilityStore::Sink sink;
+                const int knownSurroundMode = currentSinkCapabilities(videoDisplay, sink) ? sink.surroundMode : -1;
+                //the mode names differ between DS4 and DS5, no last known value that may be the other level's
+                modeString = sinkHalCall<string>("getSoundMode", videoDisplay, [videoDisplay, knownSurroundMode]() {
+                    string modeString;
+                    device::AudioStereoMode mode = device::AudioStereoMode::kStereo;
+                    device::AudioOutputPort aPort = device::Host::getInstance().getAudioOutputPort(videoDisplay);
 
-                if (aPort.isConnected()) 
-                {
+                    if (aPort.isConnected()) 
+                    {
             	
-                    mode = aPort.getStereoMode();
+                        mode = aPort.getStereoMode();
 
-                    if ((getApiVersionNumber() >= 5) && (aPort.getType().getId() == device::AudioOutputPortType::kHDMI))
-                    {
-                        /* In DS5, "Surround" implies "Auto" */
-                        if (aPort.getStereoAuto() || mode == device::AudioStereoMode::kSurround)
+                        if ((VERSION >= 5) && (aPort.getType().getId() == device::AudioOutputPortType::kHDMI))
                         {
-                            MYLOG("HDMI0 is in Auto Mode\r\n");
-                            int surroundMode = device::Host::getInstance().getVideoOutputPort("HDMI0").getDisplay().getSurroundMode();
-                            if ( surroundMode & dsSURROUNDMODE_DDPLUS)
+                            /* In DS5, "Surround" implies "Auto" */
+                            if (aPort.getStereoAuto() || mode == device::AudioStereoMode::kSurround)
+                            {
+                                MYLOG("%s is in Auto Mode\r\n", videoDisplay.c_str());
+                                //HDMI audio ports share their name with the video port they are carried on
+                                int surroundMode = (knownSurroundMode >= 0) ? knownSurroundMode :
+                                    device::Host::getInstance().getVideoOutputPort(videoDisplay).getDisplay().getSurroundMode();
+                                if ( surroundMode & dsSURROUNDMODE_DDPLUS)
+                                {
+                                    MYLOG("getSoundMode: %s has surround DDPlus\r\n", videoDisplay.c_str());
+                                    modeString.append("AUTO (Dolby Digital Plus)");
+                                }
+                                else if (surroundMode & dsSURROUNDMODE_DD)
+                                {
+                                    MYLOG("getSoundMode: %s has surround DD 5.1\r\n", videoDisplay.c_str());
+                                    modeString.append("AUTO (Dolby Digital 5.1)");
+                                }
+                                else 
+                                {
+                                    MYLOG("getSoundMode: %s does not surround\r\n", videoDisplay.c_str());
+                                    modeString.append("AUTO (Stereo)");
+                                }
+                            }
+                            else
                             {
-                                MYLOG("getSoundMode: HDMI0 has surround DDPlus\r\n");
-                                modeString.append("AUTO (Dolby Digital Plus)");
+                                modeString.append(mode.toString());
                             }
-                            else if (surroundMode & dsSURROUNDMODE_DD)
+                        }
+                        else 
+                        {
+                	       if ((VERSION >= 5) && (mode == device::AudioStereoMode::kSurround))
                             {
-                                MYLOG("getSoundMode: HDMI0 has surround DD 5.1\r\n");
-                                modeString.append("AUTO (Dolby Digital 5.1)");
+                                modeString.append("Surround");
                             }
                             else 
                             {
-                                MYLOG("getSoundMode: HDMI0 does not surround\r\n");
-                                modeString.append("AUTO (Stereo)");
+                                modeString.append(mode.toString());
                             }
                         }
-                        else
-                        {
-                            modeString.append(mode.toString());
-                        }
                     }
-                    else 
+                    else
                     {
-            	       if ((getApiVersionNumber() >= 5) && (mode == device::AudioStereoMode::kSurround))
+                       /* 
+                        * VideoDisplay is not connected. Its audio mode is unknown. Return
+                        * "Stereo" as safe default;
+                        */
+                        mode = device::AudioStereoMode::kStereo;
+                        if (VERSION >= 5) 
                         {
-                            modeString.append("Surround");
+                            modeString.append("AUTO (Stereo)");
                         }
                         else 
                         {
                             modeString.append(mode.toString());
                         }
                     }
-                }
-                else
-                {
-                   /* 
-                    * VideoDisplay is not connected. Its audio mode is unknown. Return
-                    * "Stereo" as safe default;
-                    */
-                    mode = device::AudioStereoMode::kStereo;
-                    if (getApiVersionNumber() >= 5) 
-                    {
-                        modeString.append("AUTO (Stereo)");
-                    }
-                    else 
-                    {
-                        modeString.append(mode.toString());
-                    }
-                }
+                    return modeString;
+                });
             }
             catch (const device::Exception& err)
             {
@@ -870,8 +1568,9 @@ namespace WPEFramework {
                 // Exception
                 // "Stereo" as safe default;
                 //
+                halRead = false;
                 mode = device::AudioStereoMode::kStereo;
-                if (getApiVersionNumber() >= 5) 
+                if (VERSION >= 5) 
                 {
                     modeString += "AUTO (Stereo)";
                 }
@@ -885,15 +1584,26 @@ namespace WPEFramework {
 #ifdef USE_IARM
             modeString = iarm2svc(modeString);
 #endif
-            response["soundMode"] = modeString;
-            returnResponse(true);
+            if (halRead)
+                m_shadow.Fill(ShadowState::SOUND_MODE, shadowKey, modeString, shadowGeneration);
+            soundMode = modeString;
         }
+        template<uint32_t VERSION>
         uint32_t DisplaySettings::setSoundMode(const JsonObject& parameters, JsonObject& response)
         {   //sample servicemanager response:
             MYTRACEMETHOD();
             string videoDisplay = parameters["videoDisplay"].String();//missing or empty string and we will set all ports
             string soundMode = parameters["soundMode"].String();
             returnIfParamNotFound(soundMode);
+            bool coalesced = false;
+            bool success = setSoundModeHelper<VERSION>(videoDisplay, soundMode, coalesced);
+            if (coalesced)
+                response["coalesced"] = true;
+            returnResponse(success);
+        }
+        template<uint32_t VERSION>
+        bool DisplaySettings::setSoundModeHelper(string videoDisplay, const string& soundMode, bool& coalesced)
+        {
             bool success = true;
             device::AudioStereoMode mode = device::AudioStereoMode::kStereo;  //default to stereo
             bool stereoAuto = false;
@@ -914,18 +1624,18 @@ namespace WPEFramework {
             {
                 mode = device::AudioStereoMode::kPassThru;
             }
-            else if ((getApiVersionNumber() >= 5) && ((soundMode == "auto") || (strncasecmp(soundMode.c_str(), "auto ", 5) == 0)))
+            else if ((VERSION >= 5) && ((soundMode == "auto") || (strncasecmp(soundMode.c_str(), "auto ", 5) == 0)))
             {
                 /* 
                  * anthing after "auto" is only descriptive, and can be ignored.
                  * use kSurround in this case.
                  */
                 if (videoDisplay.empty())
-                    videoDisplay = "HDMI0";
+                    videoDisplay = m_ports.PrimaryHdmiName();
                 stereoAuto = true;
                 mode = device::AudioStereoMode::kSurround;
             }
-            else if ((getApiVersionNumber() >= 5) && (soundMode == "dolby digital 5.1"))
+            else if ((VERSION >= 5) && (soundMode == "dolby digital 5.1"))
             {
                 mode = device::AudioStereoMode::kSurround;
             }
@@ -935,7 +1645,7 @@ namespace WPEFramework {
 
             bool validPortName = true;
 
-            if (getApiVersionNumber() < 5) {
+            if (VERSION < 5) {
                 /* Convert videoDisplay to connected audio ports */
                 if (videoDisplay.empty()) 
                 {
@@ -943,7 +1653,7 @@ namespace WPEFramework {
                 }
                 else if (stringContains(videoDisplay,"HDMI"))
                 {
-                    videoDisplay = "HDMI0";        
+                    videoDisplay = m_ports.HdmiPortName(videoDisplay);
                 }
                 else if (stringContains(videoDisplay,"COMPONENT"))
                 {
@@ -963,7 +1673,7 @@ namespace WPEFramework {
                 }
                 else if (stringContains(videoDisplay,"HDMI"))
                 {
-                    videoDisplay = "HDMI0";        
+                    videoDisplay = m_ports.HdmiPortName(videoDisplay);
                 }
                 else if (stringContains(videoDisplay,"SPDIF"))
                 {
@@ -978,7 +1688,7 @@ namespace WPEFramework {
             if (!validPortName)
             { 
                 MYERROR("setSoundMode has Invalid port Name : display = %s, mode = %s!\n", videoDisplay.c_str(), soundMode.c_str());
-                returnResponse(false);
+                return false;
             }
 
             MYWARN("setSoundMode: display = %s, mode = %s!\n", videoDisplay.c_str(), soundMode.c_str());
@@ -988,132 +1698,202 @@ namespace WPEFramework {
                 //now setting the sound mode for specified video display types
                 if (!videoDisplay.empty()) 
                 {
-                    device::AudioOutputPort aPort = device::Host::getInstance().getAudioOutputPort(videoDisplay);
+                    coalesced = (applySoundMode<VERSION>(videoDisplay, soundMode, mode.getId(), stereoAuto) == SetterQueue::COALESCED);
+                }
+                else 
+                {
+                    /* No videoDisplay is specified, setMode to all connected ports */
+                    std::vector<string> audioPorts(1, m_ports.PrimaryHdmiName());
+                    for (size_t port = 0; port < m_ports.VideoPortCount(); port++)
+                    {
+                        if (port != m_ports.PrimaryHdmi() && m_ports.IsHdmi(port))
+                            audioPorts.push_back(m_ports.VideoPortName(port));
+                    }
+                    audioPorts.push_back("SPDIF0");
+                    //a port that fails does not keep the others from being set
+                    for (const string& audioPort : audioPorts)
+                    {
+                        try
+                        {
+                            applySoundMode<VERSION>(audioPort, soundMode, mode.getId(), stereoAuto);
+                        }
+                        catch (const device::Exception& err)
+                        {
+                            LOG_DEVICE_EXCEPTION1(audioPort);
+                        }
+                    }
+                }
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION0();
+                success = false;
+            }
+            //TODO(MROLLINS) -- so this is interesting.  ServiceManager had a settingChanged event that I guess handled settings from many services.
+            //Does that mean we need to save our setting back to another plugin that would own settings (and this settingsChanged event) ?
+            //ServiceManager::getInstance()->saveSetting(this, SETTING_DISPLAY_SERVICE_SOUND_MODE, soundMode);
+
+            //even a failed set may have changed some ports; the mode is read back on the next getSoundMode
+            m_shadow.Invalidate(ShadowState::SOUND_MODE);
+            return success;
+        }
+        //one audio port, through m_setters so a burst of requests for the port applies only the latest
+        template<uint32_t VERSION>
+        SetterQueue::Outcome DisplaySettings::applySoundMode(const string& audioPort, const string& soundMode, int mode, bool stereoAuto)
+        {
+            return m_setters.Apply("setSoundMode", audioPort, [this, audioPort, soundMode, mode, stereoAuto]() {
+                halApply("setStereoMode", audioPort, [audioPort, soundMode, mode, stereoAuto]() {
+                    device::AudioStereoMode stereoMode = mode;
+                    device::AudioOutputPort aPort = device::Host::getInstance().getAudioOutputPort(audioPort);
                     if (aPort.isConnected())
                     {
                         /* Auto mode is only for HDMI and DS5 and non-Passthru*/
-                        if (getApiVersionNumber() >= 5 && aPort.getType().getId() == device::AudioOutputPortType::kHDMI && (!(mode == device::AudioStereoMode::kPassThru)))
+                        if (VERSION >= 5 && aPort.getType().getId() == device::AudioOutputPortType::kHDMI && (!(stereoMode == device::AudioStereoMode::kPassThru)))
                         {
                             aPort.setStereoAuto(stereoAuto);
                             if (stereoAuto) 
                             {
-                                if (device::Host::getInstance().getVideoOutputPort("HDMI0").getDisplay().getSurroundMode())
+                                if (device::Host::getInstance().getVideoOutputPort(audioPort).getDisplay().getSurroundMode())
                                 {
-                                    mode = device::AudioStereoMode::kSurround;
+                                    stereoMode = device::AudioStereoMode::kSurround;
                                 }
                                 else 
                                 {
-                                    mode = device::AudioStereoMode::kStereo;
+                                    stereoMode = device::AudioStereoMode::kStereo;
                                 }
                             }
                         }
                         else if (aPort.getType().getId() == device::AudioOutputPortType::kHDMI) {
-                            MYERROR("setSoundMode: reset auto on %s for mode = %s!\n", videoDisplay.c_str(), soundMode.c_str());
+                            MYERROR("setSoundMode: reset auto on %s for mode = %s!\n", audioPort.c_str(), soundMode.c_str());
                             aPort.setStereoAuto(false);
                         }
                         //TODO: if mode has not changed, we can skip the extra call
-                        aPort.setStereoMode(mode.toString());
+                        aPort.setStereoMode(stereoMode.toString());
                     }
+                }, HAL_CALL_DEADLINE_MS);
+            });
+        }
+        SetterQueue::Outcome DisplaySettings::applyResolution(const string& videoDisplay, const string& resolution)
+        {
+            return m_setters.Apply("setCurrentResolution", videoDisplay, [this, videoDisplay, resolution]() {
+                halApply("setResolution", videoDisplay, [videoDisplay, resolution]() {
+                    device::Host::getInstance().getVideoOutputPort(videoDisplay).setResolution(resolution);
+                }, HAL_MODE_SWITCH_DEADLINE_MS);
+                m_shadow.Set(ShadowState::RESOLUTION, videoDisplay, resolution);
+            });
+        }
+        SetterQueue::Outcome DisplaySettings::applyZoomSetting(size_t decoder, const string& zoomSetting)
+        {
+            return m_setters.Apply("setZoomSetting", m_ports.DecoderName(decoder), [this, zoomSetting, decoder]() {
+                halApply("setDFC", m_ports.DecoderName(decoder), [zoomSetting, decoder]() {
+                    device::VideoDevice &videoDevice = device::Host::getInstance().getVideoDevices().at(decoder);
+                    videoDevice.setDFC(zoomSetting);
+                }, HAL_CALL_DEADLINE_MS);
+                m_shadow.Set(ShadowState::ZOOM, m_ports.DecoderName(decoder), zoomSetting);
+            });
+        }
+        int DisplaySettings::sinkHdrCapabilities(const string& videoDisplay)
+        {
+            SinkCapabilityStore::Sink sink;
+            if (currentSinkCapabilities(videoDisplay, sink))
+                return sink.hdrCapabilities;
+            return sinkHalCall<int>("getTVHDRCapabilities", videoDisplay, [videoDisplay]() {
+                return tvHdrCapabilities(videoDisplay);
+            });
+        }
+        int DisplaySettings::sinkTvResolutions(const string& videoDisplay)
+        {
+            SinkCapabilityStore::Sink sink;
+            if (currentSinkCapabilities(videoDisplay, sink))
+                return sink.tvResolutions;
+            return sinkHalCall<int>("getSupportedTvResolutions", videoDisplay, [videoDisplay]() {
+                return tvResolutions(videoDisplay);
+            });
+        }
+        bool DisplaySettings::readEDIDHelper(const string& videoDisplay, const std::function<void(const uint8_t* data, size_t length)>& consume)
+        {
+            const std::shared_ptr<const std::vector<uint8_t>> cached = currentSinkEdid(videoDisplay);
+            if (cached)
+            {
+                consume(cached->data(), cached->size());
+                return true;
+            }
+            const std::vector<uint8_t> bytes = sinkHalCall<std::vector<uint8_t>>("getEDIDBytes", videoDisplay, [videoDisplay]() {
+                std::vector<uint8_t> bytes;
+                device::VideoOutputPort vPort = device::Host::getInstance().getVideoOutputPort(videoDisplay);
+                if (vPort.isDisplayConnected())
+                {
+                    vPort.getDisplay().getEDIDBytes(bytes);
                 }
-                else 
+                else
                 {
-                    /* No videoDisplay is specified, setMode to all connected ports */
-                    JsonObject params;
-                    params["videoDisplay"] = "HDMI0";
-                    params["soundMode"] = soundMode;
-                    JsonObject unusedResponse;
-                    setSoundMode(params, response);
-                    if (getApiVersionNumber() < 5)
-                    {
-                        params["videoDisplay"] = "COMPONENT";
-                        setSoundMode(params, unusedResponse);
-                    }
-                    else
-                    {
-                        params["videoDisplay"] = "SPDIF0";
-                        setSoundMode(params, unusedResponse);
-                    }
+                    MYWARN("readEDID failure: %s not connected!\n", videoDisplay.c_str());
                 }
-            }
-            catch (const device::Exception& err)
-            {
-                LOG_DEVICE_EXCEPTION0();
-                success = false;
-            }
-            //TODO(MROLLINS) -- so this is interesting.  ServiceManager had a settingChanged event that I guess handled settings from many services.
-            //Does that mean we need to save our setting back to another plugin that would own settings (and this settingsChanged event) ?
-            //ServiceManager::getInstance()->saveSetting(this, SETTING_DISPLAY_SERVICE_SOUND_MODE, soundMode);
-
-            returnResponse(success);
+                return bytes;
+            });
+            if (bytes.empty())
+                return false;
+            consume(bytes.data(), bytes.size());
+            return true;
         }
         uint32_t DisplaySettings::readEDID(const JsonObject& parameters, JsonObject& response)
         {   //sample servicemanager response: {"EDID":"AP///////wBSYgYCAQEBAQEXAQOAoFp4CvCdo1VJmyYPR0ovzgCBgIvAAQEBAQEBAQEBAQEBAjqAGHE4LUBYLEUAQIRjAAAeZiFQsFEAGzBAcDYAQIRjAAAeAAAA/ABUT1NISUJBLVRWCiAgAAAA/QAXSw9EDwAKICAgICAgAbECAytxSpABAgMEBQYHICImCQcHEQcYgwEAAGwDDAAQADgtwBUVHx/jBQMBAR2AGHEcFiBYLCUAQIRjAACeAR0AclHQHiBuKFUAQIRjAAAejArQiiDgLRAQPpYAsIRDAAAYjAqgFFHwFgAmfEMAsIRDAACYAAAAAAAAAAAAAAAA9w=="
             //sample this thunder plugin    : {"EDID":"AP///////wBSYgYCAQEBAQEXAQOAoFp4CvCdo1VJmyYPR0ovzgCBgIvAAQEBAQEBAQEBAQEBAjqAGHE4LUBYLEUAQIRjAAAeZiFQsFEAGzBAcDYAQIRjAAAeAAAA/ABUT1NISUJBLVRWCiAgAAAA/QAXSw9EDwAKICAgICAgAbECAytxSpABAgMEBQYHICImCQcHEQcYgwEAAGwDDAAQADgtwBUVHx/jBQMBAR2AGHEcFiBYLCUAQIRjAACeAR0AclHQHiBuKFUAQIRjAAAejArQiiDgLRAQPpYAsIRDAAAYjAqgFFHwFgAmfEMAsIRDAACYAAAAAAAAAAAAAAAA9w"}
             MYTRACEMETHOD();
-            returnIfWrongApiVersion(4);
-            std::vector<uint8_t> edidVec({'u','n','k','n','o','w','n' });
+            string videoDisplay = parameters.HasLabel("videoDisplay") ? parameters["videoDisplay"].String() : m_ports.PrimaryHdmiName();
+            //converted to base64 straight from where the EDID is, without a copy or the 64KB limit of Core::ToString
+            string edidbase64;
+            bool haveEdid = false;
             try
             {
-                std::vector<uint8_t> edidVec2;
-                device::VideoOutputPort vPort = device::Host::getInstance().getVideoOutputPort("HDMI0");
-                if (vPort.isDisplayConnected())
-                {
-                    vPort.getDisplay().getEDIDBytes(edidVec2);
-                    edidVec = edidVec2;//edidVec must be "unknown" unless we successfully get to this line
-                }
-                else
-                {
-                    MYWARN("readEDID failure: HDMI0 not connected!\n");
-                }
+                haveEdid = readEDIDHelper(videoDisplay, [&edidbase64](const uint8_t* data, size_t length) {
+                    Base64Encoder::Encode(data, length, false, edidbase64);
+                });
             }
             catch (const device::Exception& err)
             {
-                LOG_DEVICE_EXCEPTION0();
+                LOG_DEVICE_EXCEPTION1(videoDisplay);
             }
-            //convert to base64
-            uint16_t size = std::min(edidVec.size(), (size_t)std::numeric_limits<uint16_t>::max());
-            if(edidVec.size() > (size_t)std::numeric_limits<uint16_t>::max())
-                MYERROR("readEDID size too large to use ToString base64 wpe api\n");
-            string edidbase64;
-            Core::ToString((uint8_t*)&edidVec[0], size, false, edidbase64);
+            if (!haveEdid)
+                Base64Encoder::Encode(unknownEdid, sizeof(unknownEdid), false, edidbase64);//"unknown" unless we successfully got the bytes
             response["EDID"] = edidbase64;
             returnResponse(true);
         }
         uint32_t DisplaySettings::readHostEDID(const JsonObject& parameters, JsonObject& response)
         {   //sample servicemanager response:
             MYTRACEMETHOD();
-            returnIfWrongApiVersion(4);
-            std::vector<uint8_t> edidVec({'u','n','k','n','o','w','n' });
+            std::vector<uint8_t> edidVec;
             try
             {
-                std::vector<unsigned char> edidVec2;
-                device::Host::getInstance().getHostEDID(edidVec2);
-                edidVec = edidVec2;//edidVec must be "unknown" unless we successfully get to this line                
-                MYLOG("readHostEDID: getHostEDID size is %d.\n", int(edidVec2.size()));
+                edidVec = halCall<std::vector<unsigned char>>("getHostEDID", "", []() {
+                    std::vector<unsigned char> bytes;
+                    device::Host::getInstance().getHostEDID(bytes);
+                    return bytes;
+                });
+                MYLOG("readHostEDID: getHostEDID size is %d.\n", int(edidVec.size()));
             }
             catch (const device::Exception& err)
             {
                 LOG_DEVICE_EXCEPTION0();
             }
+            if (edidVec.empty())
+                edidVec.assign(std::begin(unknownEdid), std::end(unknownEdid));//edidVec must be "unknown" unless we successfully got the bytes
             //convert to base64
             string base64String;
-            uint16_t size = std::min(edidVec.size(), (size_t)std::numeric_limits<uint16_t>::max());
-            if(edidVec.size() > (size_t)std::numeric_limits<uint16_t>::max())
-                MYLOG("readHostEDID size too large to use ToString base64 wpe api\n");
-            Core::ToString((uint8_t*)&edidVec[0], size, false, base64String);
+            Base64Encoder::Encode(edidVec.data(), edidVec.size(), false, base64String);
             response["EDID"] = base64String;
             returnResponse(true);
         }
         uint32_t DisplaySettings::getActiveInput(const JsonObject& parameters, JsonObject& response)
         {   //sample servicemanager response:
             MYTRACEMETHOD();
-            returnIfWrongApiVersion(5);
-            string videoDisplay = parameters.HasLabel("videoDisplay") ? parameters["videoDisplay"].String() : "HDMI0";
+            string videoDisplay = parameters.HasLabel("videoDisplay") ? parameters["videoDisplay"].String() : m_ports.PrimaryHdmiName();
             bool active = true;
             try
             {
-                device::VideoOutputPort &vPort = device::Host::getInstance().getVideoOutputPort(videoDisplay);
-                active = (vPort.isDisplayConnected() && vPort.isActive());
+                active = shadowRead(ShadowState::ACTIVE_INPUT, videoDisplay, [this, videoDisplay]() {
+                    return halActiveInput(videoDisplay);
+                }) == "true";
             }
             catch(const device::Exception& err)
             {
@@ -1125,26 +1905,26 @@ namespace WPEFramework {
         uint32_t DisplaySettings::getTvHDRSupport(const JsonObject& parameters, JsonObject& response)
         {   //sample servicemanager response:{"standards":["none"],"supportsHDR":false}
             MYTRACEMETHOD();
-            returnIfWrongApiVersion(6);
-            
+            string videoDisplay = parameters.HasLabel("videoDisplay") ? parameters["videoDisplay"].String() : m_ports.PrimaryHdmiName();
             JsonArray hdrCapabilities;
             int capabilities = dsHDRSTANDARD_NONE;
 
             try
             {
-                device::VideoOutputPort vPort = device::VideoOutputPortConfig::getInstance().getPort("HDMI0");
-                if (vPort.isDisplayConnected())
-                    vPort.getTVHDRCapabilities(&capabilities);
+                capabilities = sinkHdrCapabilities(videoDisplay);
             }
             catch(const device::Exception& err)
             {
-                LOG_DEVICE_EXCEPTION0();
+                LOG_DEVICE_EXCEPTION1(videoDisplay);
             }                
+            if (compactFormat(parameters))
+            {   //sample compact response:{"schema":1,"hdrStandards":1,"success":true}
+                response["schema"] = (uint32_t)CompactSchema::VERSION;
+                response["hdrStandards"] = capabilities;
+                returnResponse(true);
+            }
 
-            if(!capabilities)hdrCapabilities.Add("none");
-            if(capabilities & dsHDRSTANDARD_HDR10)hdrCapabilities.Add("HDR10");
-            if(capabilities & dsHDRSTANDARD_DolbyVision)hdrCapabilities.Add("Dolby Vision");
-            if(capabilities & dsHDRSTANDARD_TechnicolorPrime)hdrCapabilities.Add("Technicolor Prime");
+            hdrStandardNames(capabilities, hdrCapabilities);
 
             if(capabilities)
             {
@@ -1164,19 +1944,25 @@ namespace WPEFramework {
         uint32_t DisplaySettings::getSettopHDRSupport(const JsonObject& parameters, JsonObject& response)
         {   //sample servicemanager response:{"standards":["HDR10"],"supportsHDR":true}
             MYTRACEMETHOD();
-            returnIfWrongApiVersion(6);
+            size_t decoder = 0;
+            returnIfDecoderNotFound(decoder);
             JsonArray hdrCapabilities;
             int capabilities = dsHDRSTANDARD_NONE;
 
             try
             {
-                device::VideoDevice &device = device::Host::getInstance().getVideoDevices().at(0);
-                device.getHDRCapabilities(&capabilities);
+                capabilities = settopHdrCapabilities(decoder);
             }
             catch(const device::Exception& err)
             {
                 LOG_DEVICE_EXCEPTION0();
             } 
+            if (compactFormat(parameters))
+            {
+                response["schema"] = (uint32_t)CompactSchema::VERSION;
+                response["hdrStandards"] = capabilities;
+                returnResponse(true);
+            }
                         
             if(!capabilities)hdrCapabilities.Add("none");
             if(capabilities & dsHDRSTANDARD_HDR10)hdrCapabilities.Add("HDR10");
@@ -1201,69 +1987,244 @@ namespace WPEFramework {
         uint32_t DisplaySettings::setVideoPortStatusInStandby(const JsonObject& parameters, JsonObject& response)
         {
             MYTRACEMETHOD();
-            returnIfWrongApiVersion(7);
             string portname = parameters["portName"].String();
             returnIfParamNotFound(portname); 
             bool enabled = parameters["enabled"].Boolean();
-            IARM_Bus_PWRMgr_StandbyVideoState_Param_t param;
-            param.isEnabled = enabled;
-            strncpy(param.port, portname.c_str(), PWRMGR_MAX_VIDEO_PORT_NAME_LENGTH);
-            bool success = true;
-            if(IARM_RESULT_SUCCESS != IARM_Bus_Call(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_API_SetStandbyVideoState, &param, sizeof(param)))
-            {
-                MYERROR("setVideoPortStatusInStandby failed. Port: %s. enable:%d\n", param.port, param.isEnabled);
-                response["error_message"] = "Bus failure";
-                success = false;
-            }
-            else if(0 != param.result)
-            {
-                MYERROR("setVideoPortStatusInStandby failed with result %d. Port: %s. enable:%d\n", param.result, param.port, param.isEnabled);
-                response["error_message"] = "internal error";
-                success = false;
-            }
+            string error;
+            bool success = setVideoPortStatusInStandbyHelper(portname, enabled, error);
+            if (!success)
+                response["error_message"] = error;
             returnResponse(success);
         }
         uint32_t DisplaySettings::getVideoPortStatusInStandby(const JsonObject& parameters, JsonObject& response)
         {
             MYTRACEMETHOD();
-            returnIfWrongApiVersion(7);
             string portname = parameters["portName"].String();
             returnIfParamNotFound(portname);            
-            bool success = true;
-            IARM_Bus_PWRMgr_StandbyVideoState_Param_t param;
-            strncpy(param.port, portname.c_str(), PWRMGR_MAX_VIDEO_PORT_NAME_LENGTH);
-            if(IARM_RESULT_SUCCESS != IARM_Bus_Call(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_API_GetStandbyVideoState, &param, sizeof(param)))
+            bool refresh = parameters.HasLabel("refresh") && parameters["refresh"].Boolean();
+            bool enabled = false;
+            string error;
+            bool success = getVideoPortStatusInStandbyHelper(portname, refresh, enabled, error);
+            if (success)
+                response["videoPortStatusInStandby"] = enabled;
+            else
+                response["error_message"] = error;
+            returnResponse(success);
+        }
+        uint32_t DisplaySettings::getAllVideoPortStatusInStandby(const JsonObject& parameters, JsonObject& response)
+        {   //sample response: {"videoPorts":[{"portName":"HDMI0","videoPortStatusInStandby":true}],"success":true}
+            MYTRACEMETHOD();
+            bool refresh = parameters.HasLabel("refresh") && parameters["refresh"].Boolean();
+            JsonArray states;
+            for (size_t port = 0; port < m_ports.VideoPortCount(); port++)
+            {
+                const string& portname = m_ports.VideoPortName(port);
+                JsonObject state;
+                bool enabled = false;
+                string error;
+                state["portName"] = portname;
+                if (getVideoPortStatusInStandbyHelper(portname, refresh, enabled, error))
+                    state["videoPortStatusInStandby"] = enabled;
+                else
+                    state["error_message"] = error;
+                states.Add(state);
+            }
+            response["videoPorts"] = states;
+            returnResponse(true);
+        }
+        uint32_t DisplaySettings::setCaptureMode(const JsonObject& parameters, JsonObject& response)
+        {   //sample request: {"enabled":true}
+            //the capture always goes to CAPTURE_DEFAULT_PATH, a client never chooses which file the plugin writes
+            MYTRACEMETHOD();
+            string enabledParam = parameters["enabled"].String();
+            returnIfParamNotFound(enabledParam);
+            if (parameters.HasLabel("path"))
             {
-                MYERROR("getVideoPortStatusInStandby failed. Port: %s. enable:%d\n", param.port, param.isEnabled);
-                response["error_message"] = "Bus failure";
-                success = false;
+                MYWARN("setCaptureMode: path is not accepted, the capture goes to %s\n", CAPTURE_DEFAULT_PATH);
+                response["error_message"] = "path is not supported";
+                returnResponse(false);
             }
-            else if(0 != param.result)
+            bool enabled = parameters["enabled"].Boolean();
+            bool success = true;
+            if (enabled)
             {
-                MYERROR("getVideoPortStatusInStandby failed with result %d. Port: %s. enable:%d\n", param.result, param.port, param.isEnabled);
-                response["error_message"] = "internal error";
-                success = false;
+                success = eventCapture.Start(CAPTURE_DEFAULT_PATH);
+                if (!success)
+                {
+                    MYERROR("setCaptureMode: can not open %s\n", CAPTURE_DEFAULT_PATH);
+                    response["error_message"] = "can not open capture file";
+                }
             }
             else
             {
-                bool enabled(0 != param.isEnabled);
-                MYLOG("video port is %s\n", enabled ? "enabled" : "disabled");
-                response["videoPortStatusInStandby"] = enabled;
+                eventCapture.Stop();
+            }
+            returnResponse(success);
+        }
+        uint32_t DisplaySettings::getCaptureMode(const JsonObject& parameters, JsonObject& response)
+        {   //sample response: {"enabled":true,"path":"/opt/logs/ds.capture","entries":120,"success":true}
+            MYTRACEMETHOD();
+            response["enabled"] = eventCapture.IsEnabled();
+            response["path"] = eventCapture.Path();
+            response["entries"] = eventCapture.Entries();
+            returnResponse(true);
+        }
+        uint32_t DisplaySettings::getHalStatus(const JsonObject& parameters, JsonObject& response)
+        {   //sample response: {"state":"closed","consecutiveTimeouts":0,"calls":42,"timeouts":0,"rejected":0,"queued":0,"busyWorkers":0,"workers":2,"shadowHits":120,"shadowMisses":4,"shadowCorrections":0,"success":true}
+            MYTRACEMETHOD();
+            HalExecutor::Stats stats = m_halExecutor.GetStats();
+            response["state"] = HalExecutor::StateName(stats.state);
+            response["consecutiveTimeouts"] = stats.consecutiveTimeouts;
+            response["calls"] = stats.calls;
+            response["timeouts"] = stats.timeouts;
+            response["rejected"] = stats.rejected;
+            response["queued"] = stats.queued;
+            response["busyWorkers"] = stats.busyWorkers;
+            response["workers"] = stats.workers;
+            ShadowState::Stats shadowStats = m_shadow.GetStats();
+            response["shadowHits"] = shadowStats.hits;
+            response["shadowMisses"] = shadowStats.misses;
+            response["shadowCorrections"] = shadowStats.corrections;
+            returnResponse(true);
+        }
+        uint32_t DisplaySettings::setNotificationFilter(const JsonObject& parameters, JsonObject& response)
+        {   //sample request: {"id":"client.events","force":false,"disabledEvents":["hdmiInputHotPlug"]}
+            //id is what the caller registered its events with, the filter only applies to those subscriptions
+            MYTRACEMETHOD();
+            string id = parameters["id"].String();
+            returnIfParamNotFound(id);
+            bool hasForce = parameters.HasLabel("force");
+            bool hasDisabledEvents = parameters.HasLabel("disabledEvents");
+            if (!hasForce && !hasDisabledEvents)
+            {
+                MYWARN("method %s missing parameter force or disabledEvents\n", __FUNCTION__);
+                returnResponse(false);
             }
+            bool success = true;
+            updateNotificationFilter([&](NotificationFilters& filters) {
+                if (filters.subscribers.find(id) == filters.subscribers.end() && filters.subscribers.size() >= MAX_NOTIFICATION_FILTERS)
+                {
+                    MYWARN("method %s: %zu subscribers have a filter already\n", __FUNCTION__, filters.subscribers.size());
+                    success = false;
+                    return;
+                }
+                NotificationFilter& filter = filters.subscribers[id];
+                if (hasForce)
+                    filter.force = parameters["force"].Boolean();
+                if (hasDisabledEvents)
+                {
+                    //replaces the whole set, an empty array enables every event again
+                    const JsonArray disabledEvents = parameters["disabledEvents"].Array();
+                    filter.disabledEvents.clear();
+                    for (uint32_t i = 0; i < disabledEvents.Length(); i++)
+                        filter.disabledEvents.insert(disabledEvents[i].String());
+                }
+                //back to the default, nothing to keep
+                if (!filter.force && filter.disabledEvents.empty())
+                    filters.subscribers.erase(id);
+            });
             returnResponse(success);
         }
+        uint32_t DisplaySettings::getNotificationStats(const JsonObject& parameters, JsonObject& response)
+        {   //sample request: {"id":"client.events"}, for the filter of that subscriber
+            //sample response: {"force":false,"disabledEvents":[],"events":[{"event":"resolutionChanged","emitted":3,"suppressed":5,"filtered":0}],"success":true}
+            MYTRACEMETHOD();
+            const string id = parameters["id"].String();
+            const std::shared_ptr<const NotificationFilters> filters = notificationFilters();
+            const auto filter = filters->subscribers.find(id);
+            JsonArray disabledEvents;
+            response["force"] = (filter != filters->subscribers.end() && filter->second.force);
+            if (filter != filters->subscribers.end())
+            {
+                for (const string& event : filter->second.disabledEvents)
+                    disabledEvents.Add(event);
+            }
+            JsonArray events;
+            {
+                std::lock_guard<std::mutex> guard(m_notifyLock);
+                for (const auto& it : m_notificationCounters)
+                {
+                    JsonObject event;
+                    event["event"] = it.first;
+                    event["emitted"] = it.second.emitted;
+                    event["suppressed"] = it.second.suppressed;
+                    event["filtered"] = it.second.filtered;
+                    events.Add(event);
+                }
+            }
+            response["disabledEvents"] = disabledEvents;
+            response["events"] = events;
+            returnResponse(true);
+        }
+        uint32_t DisplaySettings::getSetterStats(const JsonObject& parameters, JsonObject& response)
+        {   //sample response: {"maxPerSecond":2,"setters":[{"setter":"setCurrentResolution","applied":4,"coalesced":16,"rejected":3}],"success":true}
+            MYTRACEMETHOD();
+            JsonArray setters;
+            for (const auto& it : m_setters.GetCounters())
+            {
+                JsonObject setter;
+                setter["setter"] = it.first;
+                setter["applied"] = it.second.applied;
+                setter["coalesced"] = it.second.coalesced;
+                setter["rejected"] = it.second.rejected;
+                setters.Add(setter);
+            }
+            //0 is no limit
+            response["maxPerSecond"] = m_setters.Limit();
+            response["setters"] = setters;
+            returnResponse(true);
+        }
         //End methods
         //Begin events
         void DisplaySettings::resolutionPreChange()
         {
             MYTRACE();
-            sendNotify("resolutionPreChange", JsonObject());
+            sendNotify("resolutionPreChange", JsonObject(), API_VERSION_MIN);
+            notifyComClients("resolutionPreChange", [](Exchange::IDisplaySettings::INotification* client) {
+                client->ResolutionPreChange();
+            });
+        }
+        string DisplaySettings::recordPostChange(const string& videoDisplay, int width, int height)
+        {
+            const string resolution = halResolution(videoDisplay);
+            m_shadow.Set(ShadowState::RESOLUTION, videoDisplay, resolution);
+            requestStatePublish();
+            const size_t port = m_ports.VideoPortIndex(videoDisplay);
+            if (port != PortTable::NONE)
+            {
+                //lets the async resolution worker match its job with this post change callback
+                std::lock_guard<std::mutex> guard(m_resolutionLock);
+                PostChange& postChange = m_postChanges[port];
+                postChange.count++;
+                postChange.resolution = resolution;
+                postChange.width = width;
+                postChange.height = height;
+            }
+            m_resolutionSignal.notify_all();
+            return resolution;
         }
         void DisplaySettings::resolutionChanged(int width, int height)
         {
             MYTRACE();
-            vector<string> connectedDisplays;
+            PortNameList connectedDisplays;
             getConnectedVideoDisplaysHelper(connectedDisplays);
+            string jobDisplay;
+            {
+                std::lock_guard<std::mutex> guard(m_resolutionLock);
+                jobDisplay = m_resolutionJobDisplay;
+            }
+            if (!jobDisplay.empty() && std::find(connectedDisplays.begin(), connectedDisplays.end(), jobDisplay) == connectedDisplays.end())
+            {
+                //an async job on a port that is not reported below, it still waits for this call
+                try
+                {
+                    recordPostChange(jobDisplay, width, height);
+                }
+                catch(const device::Exception& err)
+                {
+                    LOG_DEVICE_EXCEPTION1(jobDisplay);
+                }
+            }
         
             string firstDisplay = "";
             string firstResolution = "";
@@ -1271,10 +2232,10 @@ namespace WPEFramework {
             for (int i = 0; i < (int)connectedDisplays.size(); i++)
             {
                 string resolution;
-                string display = connectedDisplays.at(i);
+                const string& display = connectedDisplays.at(i);
                 try
                 {
-                    resolution = device::Host::getInstance().getVideoOutputPort(display).getResolution().getName();
+                    resolution = recordPostChange(display, width, height);
                 }
                 catch(const device::Exception& err)
                 {
@@ -1290,7 +2251,9 @@ namespace WPEFramework {
                         params["height"] = height;
                         params["videoDisplayType"] = display;
                         params["resolution"] = resolution;
-                        sendNotify("resolutionChanged", params);                        
+                        notifyIfChanged("resolutionChanged", display, params, [&](Exchange::IDisplaySettings::INotification* client) {
+                            client->ResolutionChanged(display, resolution, width, height);
+                        });
                         return;
                     }
                     else if (!firstResolutionSet)
@@ -1309,136 +2272,1593 @@ namespace WPEFramework {
                 params["height"] = height;
                 params["videoDisplayType"] = firstDisplay;
                 params["resolution"] = firstResolution;
-                sendNotify("resolutionChanged", params);                        
+                notifyIfChanged("resolutionChanged", firstDisplay, params, [&](Exchange::IDisplaySettings::INotification* client) {
+                    client->ResolutionChanged(firstDisplay, firstResolution, width, height);
+                });
             }
         }
         void DisplaySettings::zoomSettingUpdated(const string& zoomSetting)
         {//servicemanager sample: {"name":"zoomSettingUpdated","params":{"zoomSetting":"None","success":true,"videoDisplayType":"all"}
          //servicemanager sample: {"name":"zoomSettingUpdated","params":{"zoomSetting":"Full","success":true,"videoDisplayType":"all"}
             MYTRACE();
+            //dsMgr does not say which decoder, the DFC it reports is the first decoder's; the others are read again
+            m_shadow.Invalidate(ShadowState::ZOOM);
+#ifdef USE_IARM
+            m_shadow.Set(ShadowState::ZOOM, m_ports.DecoderName(0), svc2iarm(zoomSetting));
+#else
+            m_shadow.Set(ShadowState::ZOOM, m_ports.DecoderName(0), zoomSetting);
+#endif
             JsonObject params;
             params["zoomSetting"] = zoomSetting;
             params["videoDisplayType"] = "all";
-            sendNotify("zoomSettingUpdated", params);
+            notifyIfChanged("zoomSettingUpdated", "all", params, [&](Exchange::IDisplaySettings::INotification* client) {
+                client->ZoomSettingUpdated(zoomSetting);
+            });
         }
         void DisplaySettings::activeInputChanged(bool activeInput)
         {
             MYTRACE();
-            if(getApiVersionNumber() < 5)
-                return;
+            m_shadow.Set(ShadowState::ACTIVE_INPUT, m_ports.PrimaryHdmiName(), activeInput ? "true" : "false");
             JsonObject params;
             params["activeInput"] = activeInput;
-            sendNotify("activeInputChanged", params);
+            notifyIfChanged("activeInputChanged", m_ports.PrimaryHdmiName(), params, [activeInput](Exchange::IDisplaySettings::INotification* client) {
+                client->ActiveInputChanged(activeInput);
+            }, 5);
         }
         void DisplaySettings::connectedVideoDisplaysUpdated(int hdmiHotPlugEvent)
         {
             MYTRACE();
-            static int previousStatus = HDMI_HOT_PLUG_EVENT_CONNECTED; 
-            static int firstTime = 1;
-
-            if (firstTime || previousStatus != hdmiHotPlugEvent)
+            //dsMgr only reports hotplug for the primary HDMI output, the other slots keep what buildPortTable saw
+            const bool connected = (HDMI_HOT_PLUG_EVENT_CONNECTED == hdmiHotPlugEvent);
+            JsonArray connectedDisplays;
+            std::list<string> connectedNames;
+            if (m_ports.PrimaryHdmi() == PortTable::NONE)
             {
-                firstTime = 0;
-                JsonArray connectedDisplays;
-                if (HDMI_HOT_PLUG_EVENT_CONNECTED == hdmiHotPlugEvent)
-                {
-                    connectedDisplays.Add("HDMI0");
-                }
-                else
+                if (connected)
+                    connectedNames.push_back(m_ports.PrimaryHdmiName());
+            }
+            else
+            {
+                m_displayConnected[m_ports.PrimaryHdmi()] = connected;
+                for (size_t port = 0; port < m_ports.VideoPortCount(); port++)
                 {
-                    /* notify Empty list on HDMI-output-disconnect hotplug */
+                    if (m_displayConnected[port])
+                        connectedNames.push_back(m_ports.VideoPortName(port));
                 }
-
-                JsonObject params;
-                params["connectedVideoDisplays"] = connectedDisplays;
-                sendNotify("connectedVideoDisplaysUpdated", params);
             }
-            previousStatus = hdmiHotPlugEvent;
+            for (const string& name : connectedNames)
+                connectedDisplays.Add(name);
+
+            //the sink's surround support comes with the display, and with it the AUTO sound mode: the prefetch
+            //pass reads it once the link settled, an unplugged port is back to stereo right away
+            m_shadow.Invalidate(ShadowState::SOUND_MODE);
+            m_shadow.Invalidate(ShadowState::ACTIVE_INPUT);
+            requestSinkPrefetch(connected, SINK_SETTLE_MS);
+            if (!connected)
+                setAutoAudioMode(m_ports.PrimaryHdmiName(), false, 0);
+            requestStatePublish();
+
+            JsonObject params;
+            params["connectedVideoDisplays"] = connectedDisplays;
+            //every client gets its own iterator, they are consumed as they are read
+            notifyIfChanged("connectedVideoDisplaysUpdated", m_ports.PrimaryHdmiName(), params, [&](Exchange::IDisplaySettings::INotification* client) {
+                RPC::IStringIterator* displays = Core::Service<RPC::StringIterator>::Create<RPC::IStringIterator>(connectedNames);
+                client->ConnectedVideoDisplaysUpdated(displays);
+                displays->Release();
+            });
         }
-        //End events
-        
-        void DisplaySettings::getConnectedVideoDisplaysHelper(std::vector<string>& connectedDisplays)
+        void DisplaySettings::hdcpStatusChanged(int hdcpStatus)
+        {
+            MYTRACE();
+            JsonObject params;
+            params["videoDisplay"] = m_ports.PrimaryHdmiName();
+            params["hdcpStatus"] = hdcpStatusName(hdcpStatus);
+            params["hdcpStatusCode"] = hdcpStatus;
+            notifyIfChanged("hdcpStatusChanged", m_ports.PrimaryHdmiName(), params, [&](Exchange::IDisplaySettings::INotification* client) {
+                client->HdcpStatusChanged(m_ports.PrimaryHdmiName(), hdcpStatusName(hdcpStatus));
+            });
+        }
+        void DisplaySettings::hdmiInputHotPlug(int port, bool connected)
+        {
+            MYTRACE();
+            JsonObject params;
+            params["port"] = port;
+            params["connected"] = connected;
+            notifyIfChanged("hdmiInputHotPlug", "HDMIIN" + std::to_string(port), params, [port, connected](Exchange::IDisplaySettings::INotification* client) {
+                client->HdmiInputHotPlug((uint32_t)port, connected);
+            });
+        }
+        void DisplaySettings::powerModeChanged(int currentState, int newState)
         {
             MYTRACE();
-            try
             {
-                device::List<device::VideoOutputPort> vPorts = device::Host::getInstance().getVideoOutputPorts();
-                for (size_t i = 0; i < vPorts.size(); i++)
-                {
-                    device::VideoOutputPort &vPort = vPorts.at(i);
-                    if (vPort.isDisplayConnected())
-                    {
-                        string displayName = vPort.getName();
-                        if (strncasecmp(displayName.c_str(), "hdmi", 4)==0)
-                        {
-                            connectedDisplays.clear();
-                            connectedDisplays.emplace_back(displayName);
-                            break;
-                        }
-                        else
-                        {
-                            vectorSet(connectedDisplays, displayName);
-                        }
-                    }
-                }
+                //pwrMgr applies and may change the standby port states around a mode change, read them again
+                std::lock_guard<std::mutex> guard(m_standbyLock);
+                m_standbyVideoStates.fill(STANDBY_STATE_UNKNOWN);
             }
-            catch(const device::Exception& err)
+            //light and deep sleep count as standby too, only ON is awake
+            const bool wasOn = (currentState == IARM_BUS_PWRMGR_POWERSTATE_ON);
+            const bool isOn = (newState == IARM_BUS_PWRMGR_POWERSTATE_ON);
+            if (wasOn == isOn)
+                return;
             {
-                LOG_DEVICE_EXCEPTION0();
-            } 
+                std::lock_guard<std::mutex> guard(m_reconcileLock);
+                if (isOn)
+                    m_resumePending = true;
+                else
+                    m_standbyPending = true;
+            }
+            m_reconcileSignal.notify_all();
         }
-        uint32_t DisplaySettings::getApiVersionNumber()
+        void DisplaySettings::requestSinkPrefetch(bool connected, uint32_t settleMs)
         {
-            return m_apiVersionNumber;
+            {
+                std::lock_guard<std::mutex> guard(m_sinkLock);
+                //a newer hotplug makes any pass in flight stale
+                m_sinkGeneration++;
+                m_sinkConnected = false;
+                m_sinkPrefetching = connected;
+                m_sinkPrefetchPending = connected;
+                m_sinkSettleMs = settleMs;
+            }
+            m_sinkSignal.notify_all();
+            if (!connected)
+                m_sinkReady.notify_all();
         }
-        void DisplaySettings::setApiVersionNumber(unsigned int apiVersionNumber)
+        void DisplaySettings::sinkPrefetchWorker()
         {
-            MYWARN("setApiVersionNumber enter version=%d", (int)apiVersionNumber);
-            
-            if (apiVersionNumber <= 4)
+            std::unique_lock<std::mutex> lock(m_sinkLock);
+            while (true)
             {
-              try
-              {
-                device::AudioOutputPort aPort = device::Host::getInstance().getAudioOutputPort("HDMI0");
+                m_sinkSignal.wait(lock, [this]() { return m_sinkPrefetchStop || m_sinkPrefetchPending; });
+                if (m_sinkPrefetchStop)
+                    break;
+                m_sinkPrefetchPending = false;
+                const uint64_t generation = m_sinkGeneration;
+                //let the link settle; another hotplug in the meantime starts the wait over
+                if (m_sinkSignal.wait_for(lock, std::chrono::milliseconds(m_sinkSettleMs),
+                        [this]() { return m_sinkPrefetchStop || m_sinkPrefetchPending; }))
+                    continue;
+                lock.unlock();
+                prefetchSink(generation);
+                lock.lock();
+            }
+        }
+        void DisplaySettings::prefetchSink(uint64_t generation)
+        {
+            MYTRACE();
+            const string videoDisplay = m_ports.PrimaryHdmiName();
+            std::vector<uint8_t> edid;
+            try
+            {
+                edid = sinkHalCall<std::vector<uint8_t>>("getEDIDBytes", videoDisplay, [videoDisplay]() {
+                    return sinkEdid(videoDisplay);
+                });
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION1(videoDisplay);
+            }
+            if (edid.empty())
+            {
+                MYWARN("prefetchSink: no EDID on %s\n", videoDisplay.c_str());
+                finishSinkPrefetch(generation);
+                return;
+            }
 
-                MYWARN("setApiVersionNumber aPort.getStereoAuto()=%d", (int)aPort.getStereoAuto());
-                if (aPort.getStereoAuto()) 
+            SinkCapabilityStore::Sink sink = SinkCapabilityStore::Sink();
+            const uint64_t edidHash = SinkCapabilityStore::Hash(edid);
+            //the quirks are resolved here once per hotplug, getQuirks only reads them
+            SinkQuirks::Id sinkId = SinkQuirks::Id();
+            const bool identified = SinkQuirks::Parse(edid, sinkId);
+            const uint32_t quirks = identified ? SinkQuirks::Resolve(sinkId) : (uint32_t)SinkQuirks::ALL;
+            bool knownSink;
+            {
+                std::lock_guard<std::mutex> guard(m_sinkLock);
+                knownSink = m_sinkStore.Lookup(edidHash, sink);
+            }
+            if (!knownSink)
+            {
+                //first time we see this sink, discover its capabilities once
+                try
+                {
+                    sink.edidHash = edidHash;
+                    sink.hdrCapabilities = sinkHalCall<int>("getTVHDRCapabilities", videoDisplay, [videoDisplay]() {
+                        return tvHdrCapabilities(videoDisplay);
+                    });
+                    sink.tvResolutions = sinkHalCall<int>("getSupportedTvResolutions", videoDisplay, [videoDisplay]() {
+                        return tvResolutions(videoDisplay);
+                    });
+                    sink.surroundMode = sinkHalCall<int>("getSurroundMode", videoDisplay, [videoDisplay]() {
+                        return sinkSurroundMode(videoDisplay);
+                    });
+                }
+                catch (const device::Exception& err)
                 {
-                    MYWARN(" setApiVersionNumber DS version check: AUTO is set, resetting");
-                    aPort.setStereoAuto(false);
-                    aPort.setStereoMode(device::AudioStereoMode::kSurround);
+                    LOG_DEVICE_EXCEPTION1(videoDisplay);
+                    finishSinkPrefetch(generation);
+                    return;
                 }
-                
+            }
 
-                device::AudioStereoMode mode = aPort.getStereoMode(/*from persistent*/true);
+            bool hadSink;
+            SinkCapabilityStore::Sink previous;
+            //a new sink is persisted from this copy once m_sinkLock is released; only m_sinkThread saves
+            std::unique_ptr<SinkCapabilityStore::Contents> unsaved;
+            {
+                std::lock_guard<std::mutex> guard(m_sinkLock);
+                if (generation != m_sinkGeneration)
+                {
+                    //unplugged or replugged while we were reading, the next pass publishes
+                    MYLOG("prefetchSink: dropped stale pass for %s\n", videoDisplay.c_str());
+                    return;
+                }
+                if (!knownSink)
+                {
+                    m_sinkStore.Store(sink);
+                    unsaved.reset(new SinkCapabilityStore::Contents(m_sinkStore.Copy()));
+                }
+                hadSink = m_haveSink;
+                previous = m_currentSink;
+                //published as a whole: waiting requests see all of the sink or none of it
+                m_currentSink = sink;
+                m_currentEdid = std::make_shared<const std::vector<uint8_t>>(std::move(edid));
+                m_sinkIdentified = identified;
+                m_sinkId = sinkId;
+                m_sinkQuirks = quirks;
+                m_haveSink = true;
+                m_sinkConnected = true;
+                m_sinkPrefetching = false;
+                //under m_sinkLock, so an unplug after the generation check sets stereo after this
+                setAutoAudioMode(videoDisplay, true, sink.surroundMode);
+            }
+            m_sinkReady.notify_all();
+            requestStatePublish();
+            if (unsaved && !SinkCapabilityStore::Save(SINK_STORE_PATH, *unsaved))
+            {
+                MYWARN("prefetchSink: can not save %s\n", SINK_STORE_PATH);
+            }
+            MYLOG("sink %016llx on %s is %s, quirks 0x%x\n", (unsigned long long)edidHash, videoDisplay.c_str(), knownSink ? "known" : "new", quirks);
+            if (hadSink && previous.edidHash == sink.edidHash)
+                return;
 
-                MYWARN("setApiVersionNumber kPassThru=%d", (int)(mode == device::AudioStereoMode::kPassThru));
+            //only the fields that differ from the previous sink
+            char hash[17];
+            snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)edidHash);
+            JsonObject params;
+            params["videoDisplay"] = videoDisplay;
+            params["edidHash"] = string(hash);
+            params["knownSink"] = knownSink;
+            if (!hadSink || previous.hdrCapabilities != sink.hdrCapabilities)
+            {
+                JsonArray standards;
+                hdrStandardNames(sink.hdrCapabilities, standards);
+                params["supportsHDR"] = (sink.hdrCapabilities != dsHDRSTANDARD_NONE);
+                params["hdrStandards"] = standards;
+            }
+            if (!hadSink || previous.tvResolutions != sink.tvResolutions)
+            {
+                FixedList<const char*, 10> names;
+                tvResolutionNames(sink.tvResolutions, names);
+                setResponseArray(params, "supportedTvResolutions", names);
+            }
+            if (!hadSink || previous.surroundMode != sink.surroundMode)
+            {
+                params["surroundMode"] = surroundModeName(sink.surroundMode);
+            }
+            notifyIfChanged("displayCapabilitiesChanged", videoDisplay, params, [&](Exchange::IDisplaySettings::INotification* client) {
+                client->DisplayCapabilitiesChanged(videoDisplay, (uint32_t)sink.hdrCapabilities, (uint32_t)sink.tvResolutions);
+            });
+        }
+        void DisplaySettings::finishSinkPrefetch(uint64_t generation)
+        {
+            //the pass failed: release the waiters, they fall back to asking the HAL
+            {
+                std::lock_guard<std::mutex> guard(m_sinkLock);
+                if (generation != m_sinkGeneration)
+                    return;
+                m_sinkPrefetching = false;
+            }
+            m_sinkReady.notify_all();
+        }
+        bool DisplaySettings::waitForSink(std::unique_lock<std::mutex>& lock)
+        {
+            //rather than queue the same DDC reads behind the prefetch, wait for its result
+            if (m_sinkPrefetching && !m_sinkReady.wait_for(lock, std::chrono::milliseconds(SINK_PREFETCH_WAIT_MS),
+                    [this]() { return !m_sinkPrefetching; }))
+            {
+                MYWARN("sink prefetch still running after %d ms\n", SINK_PREFETCH_WAIT_MS);
+            }
+            return m_sinkConnected;
+        }
+        bool DisplaySettings::currentSinkCapabilities(const string& videoDisplay, SinkCapabilityStore::Sink& sink)
+        {
+            if (videoDisplay != m_ports.PrimaryHdmiName())
+                return false;
+            std::unique_lock<std::mutex> lock(m_sinkLock);
+            if (!waitForSink(lock))
+                return false;
+            sink = m_currentSink;
+            return true;
+        }
+        std::shared_ptr<const std::vector<uint8_t>> DisplaySettings::currentSinkEdid(const string& videoDisplay)
+        {
+            if (videoDisplay != m_ports.PrimaryHdmiName())
+                return nullptr;
+            std::unique_lock<std::mutex> lock(m_sinkLock);
+            if (!waitForSink(lock) || !m_currentEdid || m_currentEdid->empty())
+                return nullptr;
+            return m_currentEdid;
+        }
+        template<typename CALL>
+        void DisplaySettings::notifyIfChanged(const char* event, const string& port, const JsonObject& params, const CALL& call, uint32_t minApiVersion)
+        {
+            string payload;
+            params.ToString(payload);
+            bool changed = false;
+            {
+                //events arrive on IARM threads; the order lock keeps the JSON-RPC notifications
+                //of an event in the same order as the state changes
+                std::lock_guard<std::mutex> order(m_notifyOrderLock);
+                bool forced = false;
+                {
+                    std::lock_guard<std::mutex> guard(m_notifyLock);
+                    NotificationCounters& counters = m_notificationCounters[event];
+                    string& last = m_lastNotified[std::make_pair(string(event), port)];
+                    changed = (last != payload);
+                    if (changed)
+                    {
+                        last = payload;
+                        counters.emitted++;
+                    }
+                    else
+                        counters.suppressed++;
+                    for (const auto& it : m_notificationFilters->subscribers)
+                        forced = forced || it.second.force;
+                    for (const auto& it : m_notificationFilters->sinks)
+                        forced = forced || it.second.force;
+                }
+                if (!changed && !forced)
+                {
+                    MYLOG("Notify %s suppressed, %s unchanged\n", event, port.c_str());
+                    return;
+                }
+                sendNotifyIf(event, params, minApiVersion, changed);
+            }
+            notifyComClients(event, call, changed);
+        }
+        void DisplaySettings::notifyClients(const char* event, const JsonObject& params, uint32_t minApiVersion, bool changed)
+        {
+            const std::shared_ptr<const NotificationFilters> filters = notificationFilters();
+            uint64_t filtered = 0;
+            //called by Notify for every subscriber of the event
+            const std::function<bool(const string&)> sendif = [&filters, &filtered, event, changed](const string& designator) {
+                const auto filter = filters->subscribers.find(designator);
+                if (filter == filters->subscribers.end())
+                    return changed;
+                if (filter->second.disabledEvents.count(event))
+                {
+                    filtered++;
+                    return false;
+                }
+                return changed || filter->second.force;
+            };
+            //event subscriptions are kept per interface version
+            for (uint8_t interfaceVersion = 1; interfaceVersion <= API_VERSION_MAX; interfaceVersion++)
+            {
+                Core::JSONRPC::Handler* handler = GetHandler(interfaceVersion);
+                if (handler == nullptr || apiVersionOf(interfaceVersion) < minApiVersion)
+                    continue;
+                if (filters->subscribers.empty())
+                    handler->Notify(event, params);
+                else
+                    handler->Notify(event, params, sendif);
+            }
+            countFiltered(event, filtered);
+        }
+        //the IDisplaySettings clients are called outside the lock, so one may unregister from its callback
+        template<typename CALL>
+        void DisplaySettings::notifyComClients(const char* event, const CALL& call, bool changed)
+        {
+            const std::shared_ptr<const NotificationFilters> filters = notificationFilters();
+            std::list<Exchange::IDisplaySettings::INotification*> clients;
+            {
+                std::lock_guard<std::mutex> guard(m_comClientsLock);
+                for (Exchange::IDisplaySettings::INotification* client : m_comClients)
+                {
+                    client->AddRef();
+                    clients.push_back(client);
+                }
+            }
+            uint64_t filtered = 0;
+            for (Exchange::IDisplaySettings::INotification* client : clients)
+            {
+                const auto filter = filters->sinks.find(client);
+                bool send = changed;
+                if (filter != filters->sinks.end())
+                {
+                    if (filter->second.disabledEvents.count(event))
+                    {
+                        filtered++;
+                        send = false;
+                    }
+                    else
+                        send = changed || filter->second.force;
+                }
+                if (send)
+                    call(client);
+                client->Release();
+            }
+            countFiltered(event, filtered);
+        }
+        std::shared_ptr<const DisplaySettings::NotificationFilters> DisplaySettings::notificationFilters()
+        {
+            std::lock_guard<std::mutex> guard(m_notifyLock);
+            return m_notificationFilters;
+        }
+        void DisplaySettings::updateNotificationFilter(const std::function<void(NotificationFilters&)>& update)
+        {
+            std::lock_guard<std::mutex> guard(m_notifyLock);
+            std::shared_ptr<NotificationFilters> filters = std::make_shared<NotificationFilters>(*m_notificationFilters);
+            update(*filters);
+            m_notificationFilters = filters;
+        }
+        void DisplaySettings::countFiltered(const char* event, uint64_t filtered)
+        {
+            if (filtered == 0)
+                return;
+            std::lock_guard<std::mutex> guard(m_notifyLock);
+            m_notificationCounters[event].filtered += filtered;
+        }
+        //End events
 
-                if (mode == device::AudioStereoMode::kPassThru) 
-                {
-                    MYWARN(" setApiVersionNumberDS version check: PASSTHRU is set, resetting");
-                    aPort.setStereoAuto(false);
-                    aPort.setStereoMode(device::AudioStereoMode::kSurround);
-                    MYWARN("DS version 4 set with Audio Surround");
-                }
-              }
-              catch (const device::Exception& err)
-              {
-                  LOG_DEVICE_EXCEPTION0();              
-                  MYERROR(" setApiVersionNumber exception caught set surround, now try stereo");
-                  try {
-                      device::AudioOutputPort aPort = device::Host::getInstance().getAudioOutputPort("HDMI0");
-                      aPort.setStereoAuto(false);
-                      aPort.setStereoMode(device::AudioStereoMode::kStereo);
-                      MYWARN("DS version 4 set with Audio stereo");
-                   }
-                  catch (const device::Exception& err) {
-                      LOG_DEVICE_EXCEPTION0();
-                      MYERROR("exception caught set stereo");
-                  }
-               }
-            }
-            m_apiVersionNumber = apiVersionNumber;
-        }                                                    
+        //Begin IDisplaySettings
+        uint32_t DisplaySettings::Register(Exchange::IDisplaySettings::INotification* client)
+        {
+            MYTRACE();
+            if (client == nullptr)
+                return Core::ERROR_BAD_REQUEST;
+            std::lock_guard<std::mutex> guard(m_comClientsLock);
+            if (std::find(m_comClients.begin(), m_comClients.end(), client) != m_comClients.end())
+                return Core::ERROR_ALREADY_CONNECTED;
+            client->AddRef();
+            m_comClients.push_back(client);
+            return Core::ERROR_NONE;
+        }
+        uint32_t DisplaySettings::Unregister(Exchange::IDisplaySettings::INotification* client)
+        {
+            MYTRACE();
+            std::lock_guard<std::mutex> guard(m_comClientsLock);
+            auto it = std::find(m_comClients.begin(), m_comClients.end(), client);
+            if (it == m_comClients.end())
+                return Core::ERROR_UNKNOWN_KEY;
+            (*it)->Release();
+            m_comClients.erase(it);
+            updateNotificationFilter([client](NotificationFilters& filters) {
+                filters.sinks.erase(client);
+            });
+            return Core::ERROR_NONE;
+        }
+        uint32_t DisplaySettings::SetNotificationFilter(Exchange::IDisplaySettings::INotification* client, const bool force, RPC::IStringIterator* disabledEvents)
+        {
+            MYTRACE();
+            NotificationFilter filter;
+            filter.force = force;
+            string event;
+            while (disabledEvents != nullptr && disabledEvents->Next(event))
+                filter.disabledEvents.insert(event);
+            //registered sinks only, Unregister is what drops the filter again
+            std::lock_guard<std::mutex> guard(m_comClientsLock);
+            if (std::find(m_comClients.begin(), m_comClients.end(), client) == m_comClients.end())
+                return Core::ERROR_UNKNOWN_KEY;
+            updateNotificationFilter([client, &filter](NotificationFilters& filters) {
+                if (!filter.force && filter.disabledEvents.empty())
+                    filters.sinks.erase(client);
+                else
+                    filters.sinks[client] = filter;
+            });
+            return Core::ERROR_NONE;
+        }
+        uint32_t DisplaySettings::ConnectedVideoDisplays(RPC::IStringIterator*& videoDisplays)
+        {
+            MYTRACE();
+            PortNameList connectedDisplays;
+            getConnectedVideoDisplaysHelper(connectedDisplays);
+            videoDisplays = Core::Service<RPC::StringIterator>::Create<RPC::IStringIterator>(
+                std::list<string>(connectedDisplays.begin(), connectedDisplays.end()));
+            return Core::ERROR_NONE;
+        }
+        uint32_t DisplaySettings::SupportedResolutions(const string& videoDisplay, RPC::IStringIterator*& resolutions)
+        {
+            MYTRACE();
+            ResolutionNameList supportedResolutions;
+            try
+            {
+                getSupportedResolutionsHelper(videoDisplay.empty() ? m_ports.PrimaryHdmiName() : videoDisplay, supportedResolutions);
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION1(videoDisplay);
+                return Core::ERROR_GENERAL;
+            }
+            resolutions = Core::Service<RPC::StringIterator>::Create<RPC::IStringIterator>(
+                std::list<string>(supportedResolutions.begin(), supportedResolutions.end()));
+            return Core::ERROR_NONE;
+        }
+        uint32_t DisplaySettings::CurrentResolution(const string& videoDisplay, string& resolution)
+        {
+            MYTRACE();
+            const string port = videoDisplay.empty() ? m_ports.PrimaryHdmiName() : videoDisplay;
+            try
+            {
+                resolution = shadowRead(ShadowState::RESOLUTION, port, [this, port]() {
+                    return halResolution(port);
+                });
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION1(port);
+                return Core::ERROR_GENERAL;
+            }
+            return Core::ERROR_NONE;
+        }
+        uint32_t DisplaySettings::SetCurrentResolution(const string& videoDisplay, const string& resolution)
+        {
+            MYTRACE();
+            if (videoDisplay.empty() || resolution.empty())
+                return Core::ERROR_BAD_REQUEST;
+            //plugins are not rate limited, but share the coalescing with the JSON-RPC callers
+            try
+            {
+                applyResolution(videoDisplay, resolution);
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION2(videoDisplay, resolution);
+                return Core::ERROR_GENERAL;
+            }
+            return Core::ERROR_NONE;
+        }
+        uint32_t DisplaySettings::ZoomSetting(const uint8_t videoDecoder, string& zoomSetting)
+        {
+            MYTRACE();
+            if (videoDecoder >= m_ports.DecoderCount())
+                return Core::ERROR_BAD_REQUEST;
+            try
+            {
+                zoomSetting = shadowRead(ShadowState::ZOOM, m_ports.DecoderName(videoDecoder), [this, videoDecoder]() {
+                    return halZoomSetting(videoDecoder);
+                });
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION0();
+                return Core::ERROR_GENERAL;
+            }
+#ifdef USE_IARM
+            zoomSetting = iarm2svc(zoomSetting);
+#endif
+            return Core::ERROR_NONE;
+        }
+        uint32_t DisplaySettings::SetZoomSetting(const uint8_t videoDecoder, const string& zoomSetting)
+        {
+            MYTRACE();
+            if (videoDecoder >= m_ports.DecoderCount() || zoomSetting.empty())
+                return Core::ERROR_BAD_REQUEST;
+            try
+            {
+#ifdef USE_IARM
+                applyZoomSetting(videoDecoder, svc2iarm(zoomSetting));
+#else
+                applyZoomSetting(videoDecoder, zoomSetting);
+#endif
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION1(zoomSetting);
+                return Core::ERROR_GENERAL;
+            }
+            return Core::ERROR_NONE;
+        }
+        uint32_t DisplaySettings::SoundMode(const string& audioPort, string& soundMode)
+        {
+            MYTRACE();
+            getSoundModeHelper<API_VERSION_MAX>(audioPort, soundMode);
+            return Core::ERROR_NONE;
+        }
+        uint32_t DisplaySettings::SetSoundMode(const string& audioPort, const string& soundMode)
+        {
+            MYTRACE();
+            if (soundMode.empty())
+                return Core::ERROR_BAD_REQUEST;
+            bool coalesced = false;
+            return setSoundModeHelper<API_VERSION_MAX>(audioPort, soundMode, coalesced) ? Core::ERROR_NONE : Core::ERROR_GENERAL;
+        }
+        uint32_t DisplaySettings::SupportedAudioModes(const string& audioPort, RPC::IStringIterator*& audioModes)
+        {
+            MYTRACE();
+            AudioModeNameList supportedAudioModes;
+            getSupportedAudioModesHelper<API_VERSION_MAX>(audioPort, supportedAudioModes);
+            audioModes = Core::Service<RPC::StringIterator>::Create<RPC::IStringIterator>(
+                std::list<string>(supportedAudioModes.begin(), supportedAudioModes.end()));
+            return Core::ERROR_NONE;
+        }
+        uint32_t DisplaySettings::ActiveInput(const string& videoDisplay, bool& activeInput)
+        {
+            MYTRACE();
+            const string port = videoDisplay.empty() ? m_ports.PrimaryHdmiName() : videoDisplay;
+            try
+            {
+                activeInput = shadowRead(ShadowState::ACTIVE_INPUT, port, [this, port]() {
+                    return halActiveInput(port);
+                }) == "true";
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION1(port);
+                return Core::ERROR_GENERAL;
+            }
+            return Core::ERROR_NONE;
+        }
+        uint32_t DisplaySettings::TvHDRSupport(const string& videoDisplay, uint32_t& hdrStandards)
+        {
+            MYTRACE();
+            const string port = videoDisplay.empty() ? m_ports.PrimaryHdmiName() : videoDisplay;
+            try
+            {
+                hdrStandards = (uint32_t)sinkHdrCapabilities(port);
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION1(port);
+                return Core::ERROR_GENERAL;
+            }
+            return Core::ERROR_NONE;
+        }
+        uint32_t DisplaySettings::SettopHDRSupport(const uint8_t videoDecoder, uint32_t& hdrStandards)
+        {
+            MYTRACE();
+            if (videoDecoder >= m_ports.DecoderCount())
+                return Core::ERROR_BAD_REQUEST;
+            try
+            {
+                hdrStandards = (uint32_t)settopHdrCapabilities(videoDecoder);
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION0();
+                return Core::ERROR_GENERAL;
+            }
+            return Core::ERROR_NONE;
+        }
+        uint32_t DisplaySettings::SupportedTvResolutions(const string& videoDisplay, uint32_t& tvResolutions)
+        {
+            MYTRACE();
+            const string port = videoDisplay.empty() ? m_ports.PrimaryHdmiName() : videoDisplay;
+            try
+            {
+                tvResolutions = (uint32_t)sinkTvResolutions(port);
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION1(port);
+                return Core::ERROR_GENERAL;
+            }
+            return Core::ERROR_NONE;
+        }
+        uint32_t DisplaySettings::EDID(const string& videoDisplay, uint16_t& length, uint8_t data[])
+        {
+            MYTRACE();
+            const string port = videoDisplay.empty() ? m_ports.PrimaryHdmiName() : videoDisplay;
+            uint32_t result = Core::ERROR_NONE;
+            bool haveEdid = false;
+            try
+            {
+                haveEdid = readEDIDHelper(port, [&length, data, &result](const uint8_t* edid, size_t size) {
+                    if (size > length)
+                    {
+                        length = (uint16_t)std::min(size, (size_t)0xffff);
+                        result = Core::ERROR_INVALID_INPUT_LENGTH;
+                        return;
+                    }
+                    memcpy(data, edid, size);
+                    length = (uint16_t)size;
+                });
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION1(port);
+                return Core::ERROR_GENERAL;
+            }
+            //no sink is no EDID rather than the "unknown" readEDID answers with
+            return haveEdid ? result : (uint32_t)Core::ERROR_UNAVAILABLE;
+        }
+        uint32_t DisplaySettings::VideoPortStatusInStandby(const string& videoPort, bool& enabled)
+        {
+            MYTRACE();
+            string error;
+            if (!getVideoPortStatusInStandbyHelper(videoPort, false, enabled, error))
+            {
+                MYERROR("VideoPortStatusInStandby %s: %s\n", videoPort.c_str(), error.c_str());
+                return Core::ERROR_GENERAL;
+            }
+            return Core::ERROR_NONE;
+        }
+        uint32_t DisplaySettings::SetVideoPortStatusInStandby(const string& videoPort, const bool enabled)
+        {
+            MYTRACE();
+            string error;
+            if (!setVideoPortStatusInStandbyHelper(videoPort, enabled, error))
+            {
+                MYERROR("SetVideoPortStatusInStandby %s: %s\n", videoPort.c_str(), error.c_str());
+                return Core::ERROR_GENERAL;
+            }
+            return Core::ERROR_NONE;
+        }
+        //End IDisplaySettings
+        
+        void DisplaySettings::getConnectedVideoDisplaysHelper(PortNameList& connectedDisplays)
+        {
+            MYTRACE();
+            try
+            {
+                connectedDisplays = halCall<PortNameList>("getConnectedVideoDisplays", "", []() {
+                    PortNameList connectedDisplays;
+                    device::List<device::VideoOutputPort> vPorts = device::Host::getInstance().getVideoOutputPorts();
+                    for (size_t i = 0; i < vPorts.size(); i++)
+                    {
+                        device::VideoOutputPort &vPort = vPorts.at(i);
+                        if (vPort.isDisplayConnected())
+                        {
+                            const string& displayName = vPort.getName();
+                            if (strncasecmp(displayName.c_str(), "hdmi", 4)==0)
+                            {
+                                connectedDisplays.clear();
+                                connectedDisplays.emplace_back(displayName);
+                                break;
+                            }
+                            else
+                            {
+                                connectedDisplays.emplace_back(displayName);
+                            }
+                        }
+                    }
+                    warnIfSpilled("getConnectedVideoDisplays", connectedDisplays);
+                    return connectedDisplays;
+                });
+                uniqueNames(m_portNames, connectedDisplays);
+            }
+            catch(const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION0();
+            } 
+        }
+        void DisplaySettings::getSupportedVideoDisplaysHelper(PortNameList& supportedVideoDisplays)
+        {
+            supportedVideoDisplays = halCall<PortNameList>("getVideoOutputPorts", "", []() {
+                PortNameList names;
+                device::List<device::VideoOutputPort> vPorts = device::Host::getInstance().getVideoOutputPorts();
+                for (size_t i = 0; i < vPorts.size(); i++)
+                {
+                    device::VideoOutputPort &vPort = vPorts.at(i);
+                    const string& videoDisplay = vPort.getName();
+                    names.emplace_back(videoDisplay);
+                }
+                warnIfSpilled("getVideoOutputPorts", names);
+                return names;
+            });
+            uniqueNames(m_portNames, supportedVideoDisplays);
+        }
+        bool DisplaySettings::setVideoPortStatusInStandbyHelper(const string& portname, bool enabled, string& error)
+        {
+            std::shared_ptr<IARM_Bus_PWRMgr_StandbyVideoState_Param_t> call = std::make_shared<IARM_Bus_PWRMgr_StandbyVideoState_Param_t>();
+            IARM_Bus_PWRMgr_StandbyVideoState_Param_t& param = *call;
+            param.isEnabled = enabled;
+            strncpy(param.port, portname.c_str(), PWRMGR_MAX_VIDEO_PORT_NAME_LENGTH);
+            std::shared_ptr<IARM_Result_t> busResult = std::make_shared<IARM_Result_t>(IARM_RESULT_IPCCORE_FAIL);
+            try
+            {
+                halApply("pwrMgr.SetStandbyVideoState", portname, [call, busResult]() {
+                    *busResult = IARM_Bus_Call(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_API_SetStandbyVideoState, call.get(), sizeof(*call));
+                }, HAL_CALL_DEADLINE_MS);
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION1(portname);
+                error = "Bus timeout";
+                return false;
+            }
+            if(IARM_RESULT_SUCCESS != *busResult)
+            {
+                MYERROR("setVideoPortStatusInStandby failed. Port: %s. enable:%d\n", param.port, param.isEnabled);
+                error = "Bus failure";
+                return false;
+            }
+            if(0 != param.result)
+            {
+                MYERROR("setVideoPortStatusInStandby failed with result %d. Port: %s. enable:%d\n", param.result, param.port, param.isEnabled);
+                error = "internal error";
+                return false;
+            }
+            setStandbyVideoState(portname, enabled ? STANDBY_STATE_ENABLED : STANDBY_STATE_DISABLED);
+            return true;
+        }
+        bool DisplaySettings::getVideoPortStatusInStandbyHelper(const string& portname, bool refresh, bool& enabled, string& error)
+        {
+            //a SetStandbyVideoState of another pwrMgr client goes unseen, so a cached state is only served for a while; refresh bypasses the cache
+            size_t port = m_ports.VideoPortIndex(portname);
+            if (!refresh && port != PortTable::NONE)
+            {
+                std::lock_guard<std::mutex> guard(m_standbyLock);
+                if (m_standbyVideoStates[port] != STANDBY_STATE_UNKNOWN &&
+                    std::chrono::steady_clock::now() - m_standbyVideoStatesRead[port] < std::chrono::milliseconds(STANDBY_STATE_TTL_MS))
+                {
+                    enabled = (m_standbyVideoStates[port] == STANDBY_STATE_ENABLED);
+                    return true;
+                }
+            }
+            std::shared_ptr<IARM_Bus_PWRMgr_StandbyVideoState_Param_t> call = std::make_shared<IARM_Bus_PWRMgr_StandbyVideoState_Param_t>();
+            IARM_Bus_PWRMgr_StandbyVideoState_Param_t& param = *call;
+            strncpy(param.port, portname.c_str(), PWRMGR_MAX_VIDEO_PORT_NAME_LENGTH);
+            std::shared_ptr<IARM_Result_t> busResult = std::make_shared<IARM_Result_t>(IARM_RESULT_IPCCORE_FAIL);
+            try
+            {
+                halApply("pwrMgr.GetStandbyVideoState", portname, [call, busResult]() {
+                    *busResult = IARM_Bus_Call(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_API_GetStandbyVideoState, call.get(), sizeof(*call));
+                }, HAL_CALL_DEADLINE_MS);
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION1(portname);
+                error = "Bus timeout";
+                return false;
+            }
+            if(IARM_RESULT_SUCCESS != *busResult)
+            {
+                MYERROR("getVideoPortStatusInStandby failed. Port: %s. enable:%d\n", param.port, param.isEnabled);
+                error = "Bus failure";
+                return false;
+            }
+            else if(0 != param.result)
+            {
+                MYERROR("getVideoPortStatusInStandby failed with result %d. Port: %s. enable:%d\n", param.result, param.port, param.isEnabled);
+                error = "internal error";
+                return false;
+            }
+            enabled = (0 != param.isEnabled);
+            MYLOG("video port %s is %s\n", portname.c_str(), enabled ? "enabled" : "disabled");
+            setStandbyVideoState(portname, enabled ? STANDBY_STATE_ENABLED : STANDBY_STATE_DISABLED);
+            return true;
+        }
+        void DisplaySettings::setStandbyVideoState(const string& portname, int8_t state)
+        {
+            size_t port = m_ports.VideoPortIndex(portname);
+            if (port == PortTable::NONE)
+                return;
+            std::lock_guard<std::mutex> guard(m_standbyLock);
+            m_standbyVideoStates[port] = state;
+            m_standbyVideoStatesRead[port] = std::chrono::steady_clock::now();
+        }
+        bool DisplaySettings::videoDecoderParam(const JsonObject& parameters, size_t& decoder)
+        {
+            decoder = 0;
+            if (!parameters.HasLabel("videoDecoder"))
+                return true;
+            int64_t requested = parameters["videoDecoder"].Number();
+            if (requested < 0 || (uint64_t)requested >= m_ports.DecoderCount())
+                return false;
+            decoder = (size_t)requested;
+            return true;
+        }
+        void DisplaySettings::refreshAudioCapabilities()
+        {
+            //the names as the HAL reports them; interned below, the HAL thread does not touch the plugin
+            struct HalAudioPort {
+                string name;
+                AudioModeList modes;
+            };
+            struct HalHdmiPort {
+                string name;
+                string autoMode;
+            };
+            struct HalAudioCapabilities {
+                FixedList<HalAudioPort, PortTable::MAX_PORTS> audioPorts;
+                FixedList<HalHdmiPort, PortTable::MAX_PORTS> hdmiPorts;
+            };
+            HalAudioCapabilities reported;
+            try
+            {
+                //one getSupportedStereoModes() per audio port and one surround query per HDMI port
+                reported = halCall<HalAudioCapabilities>("getAudioCapabilities", "", []() {
+                    HalAudioCapabilities capabilities;
+                    device::List<device::VideoOutputPort> vPorts = device::Host::getInstance().getVideoOutputPorts();
+                    for (size_t i = 0; i < vPorts.size(); i++)
+                    {
+                        device::VideoOutputPort &vPort = vPorts.at(i);
+                        device::AudioOutputPort &aPort = vPort.getAudioOutputPort();
+                        const string audioPortName = aPort.getName();
+                        bool known = false;
+                        for (const HalAudioPort& port : capabilities.audioPorts)
+                            known = known || (port.name == audioPortName);
+                        if (!known)
+                        {
+                            HalAudioPort port;
+                            port.name = audioPortName;
+                            const device::List<device::AudioStereoMode> modes = aPort.getSupportedStereoModes();
+                            for (size_t m = 0; m < modes.size(); m++)
+                                port.modes.emplace_back(modes.at(m).getName());
+                            warnIfSpilled("getSupportedStereoModes", port.modes);
+                            capabilities.audioPorts.emplace_back(port);
+                        }
+
+                        const string videoPortName = vPort.getName();
+                        if (videoPortName.compare(0, 4, "HDMI") == 0)
+                        {
+                            HalHdmiPort hdmi;
+                            hdmi.name = videoPortName;
+                            try
+                            {
+                                device::VideoOutputPort port = device::VideoOutputPortConfig::getInstance().getPort(videoPortName);
+                                int surroundMode = port.getDisplay().getSurroundMode();
+                                hdmi.autoMode = autoAudioModeName(port.isDisplayConnected(), surroundMode);
+                            }
+                            catch (const device::Exception& err)
+                            {
+                                //no display to ask, same as not connected
+                                hdmi.autoMode = "AUTO (Stereo)";
+                            }
+                            MYLOG("%s auto mode is %s\n", videoPortName.c_str(), hdmi.autoMode.c_str());
+                            capabilities.hdmiPorts.emplace_back(hdmi);
+                        }
+                    }
+                    return capabilities;
+                });
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION0();
+                return;
+            }
+
+            std::shared_ptr<AudioCapabilities> capabilities = std::make_shared<AudioCapabilities>();
+            for (const HalAudioPort& reportedPort : reported.audioPorts)
+            {
+                AudioCapabilities::AudioPort port;
+                port.name = reportedPort.name;
+                port.hasSurround = false;
+                for (const string& audioMode : reportedPort.modes)
+                {
+                    const AudioModeNames::Id id = m_audioModeNames.Intern(audioMode);
+                    if (id == AudioModeNames::NONE)
+                    {
+                        MYWARN("audio mode %s of %s not kept, %u modes known\n", audioMode.c_str(), port.name.c_str(), (unsigned)m_audioModeNames.Size());
+                        continue;
+                    }
+                    if (std::find(capabilities->modeOrder.begin(), capabilities->modeOrder.end(), id) == capabilities->modeOrder.end())
+                        capabilities->modeOrder.emplace_back(id);
+                    // Starging Version 5, "Surround" mode is replaced by "Auto Mode"
+                    if (strcasecmp(audioMode.c_str(),"SURROUND") == 0)
+                        port.hasSurround = true;
+                    else
+                        port.modes[AudioCapabilities::DS5].set(id);
+                    /* Do not support PASSTHRU in DS 4 or lower */
+                    if (strcasecmp(audioMode.c_str(),"PASSTHRU") != 0)
+                        port.modes[AudioCapabilities::DS4].set(id);
+                }
+                capabilities->audioPorts.emplace_back(port);
+            }
+            for (const HalHdmiPort& reportedPort : reported.hdmiPorts)
+            {
+                AudioCapabilities::HdmiPort hdmi;
+                hdmi.name = reportedPort.name;
+                if (!reportedPort.autoMode.empty())
+                    hdmi.autoMode = m_audioModeNames.Intern(reportedPort.autoMode);
+                capabilities->hdmiPorts.emplace_back(hdmi);
+            }
+            std::lock_guard<std::mutex> guard(m_audioCapabilitiesLock);
+            m_audioCapabilities = capabilities;
+        }
+        void DisplaySettings::setAutoAudioMode(const string& hdmiPort, bool connected, int surroundMode)
+        {
+            const string name = autoAudioModeName(connected, surroundMode);
+            const AudioModeNames::Id autoMode = name.empty() ? AudioModeNames::NONE : m_audioModeNames.Intern(name);
+            std::lock_guard<std::mutex> guard(m_audioCapabilitiesLock);
+            if (!m_audioCapabilities)
+                return;
+            //copied and swapped, requests keep the matrix they started with
+            std::shared_ptr<AudioCapabilities> capabilities = std::make_shared<AudioCapabilities>(*m_audioCapabilities);
+            for (AudioCapabilities::HdmiPort& port : capabilities->hdmiPorts)
+            {
+                if (port.name == hdmiPort)
+                    port.autoMode = autoMode;
+            }
+            m_audioCapabilities = capabilities;
+        }
+        std::shared_ptr<const DisplaySettings::AudioCapabilities> DisplaySettings::audioCapabilities()
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_audioCapabilitiesLock);
+                if (m_audioCapabilities)
+                    return m_audioCapabilities;
+            }
+            //the build in Initialize failed, try again
+            refreshAudioCapabilities();
+            std::lock_guard<std::mutex> guard(m_audioCapabilitiesLock);
+            return m_audioCapabilities;
+        }
+        void DisplaySettings::buildPortTable()
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_modeLock);
+                m_supportedResolutionsValid.fill(false);
+                m_settopHdr.fill(-1);
+            }
+            m_shadow.Clear();
+            m_ports.Clear();
+            PortNameList videoPorts;
+            try
+            {
+                getSupportedVideoDisplaysHelper(videoPorts);
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION0();
+            }
+            for (const string& name : videoPorts)
+                m_ports.AddVideoPort(name);
+            try
+            {
+                m_ports.SetDecoderCount(halCall<size_t>("getVideoDevices", "", []() {
+                    return (size_t)device::Host::getInstance().getVideoDevices().size();
+                }));
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION0();
+            }
+            for (size_t port = 0; port < PortTable::MAX_PORTS; port++)
+                m_displayConnected[port] = false;
+            PortNameList connectedDisplays;
+            getConnectedVideoDisplaysHelper(connectedDisplays);
+            for (const string& name : connectedDisplays)
+            {
+                size_t port = m_ports.VideoPortIndex(name);
+                if (port != PortTable::NONE)
+                    m_displayConnected[port] = true;
+            }
+            {
+                std::lock_guard<std::mutex> guard(m_standbyLock);
+                m_standbyVideoStates.fill(STANDBY_STATE_UNKNOWN);
+            }
+            MYLOG("port table: %u video ports, primary HDMI %s, %u decoders\n", (unsigned)m_ports.VideoPortCount(),
+                m_ports.PrimaryHdmiName().c_str(), (unsigned)m_ports.DecoderCount());
+            refreshAudioCapabilities();
+            if (m_ports.PrimaryHdmi() != PortTable::NONE && m_displayConnected[m_ports.PrimaryHdmi()])
+                requestSinkPrefetch(true, 0);
+        }
+        string DisplaySettings::shadowRead(ShadowState::Setting setting, const string& key, const std::function<string()>& read)
+        {
+            string value;
+            if (m_shadow.Get(setting, key, value))
+                return value;
+            const uint64_t generation = m_shadow.Generation(setting);
+            value = read();
+            m_shadow.Fill(setting, key, value, generation);
+            return value;
+        }
+        string DisplaySettings::halResolution(const string& videoDisplay)
+        {
+            return halCall<string>("getResolution", videoDisplay, [videoDisplay]() {
+                return device::Host::getInstance().getVideoOutputPort(videoDisplay).getResolution().getName();
+            });
+        }
+        string DisplaySettings::halZoomSetting(size_t decoder)
+        {
+            return halCall<string>("getDFC", m_ports.DecoderName(decoder), [decoder]() {
+                device::VideoDevice &videoDevice = device::Host::getInstance().getVideoDevices().at(decoder);
+                return videoDevice.getDFC().getName();
+            });
+        }
+        string DisplaySettings::halActiveInput(const string& videoDisplay)
+        {
+            bool active = halCall<bool>("isActive", videoDisplay, [videoDisplay]() {
+                device::VideoOutputPort &vPort = device::Host::getInstance().getVideoOutputPort(videoDisplay);
+                return (vPort.isDisplayConnected() && vPort.isActive());
+            });
+            return active ? "true" : "false";
+        }
+        void DisplaySettings::shadowReconciler()
+        {
+            std::unique_lock<std::mutex> lock(m_reconcileLock);
+            while (true)
+            {
+                m_reconcileSignal.wait_for(lock, std::chrono::milliseconds(SHADOW_RECONCILE_MS), [this]() {
+                    return m_reconcileStop || m_standbyPending || m_resumePending || m_publishPending; });
+                if (m_reconcileStop)
+                    break;
+                //entry first, a quick standby and resume arrive together
+                if (m_standbyPending || m_resumePending || m_publishPending)
+                {
+                    const bool standby = m_standbyPending;
+                    const bool resume = m_resumePending;
+                    m_standbyPending = false;
+                    m_resumePending = false;
+                    m_publishPending = false;
+                    lock.unlock();
+                    if (standby)
+                        takeStandbySnapshot();
+                    if (resume)
+                        validateResume();
+                    publishDisplayState();
+                    lock.lock();
+                    continue;
+                }
+                lock.unlock();
+                reconcileShadow(ShadowState::RESOLUTION, [this](const string& videoDisplay) {
+                    return halResolution(videoDisplay);
+                });
+                reconcileShadow(ShadowState::ZOOM, [this](const string& decoderName) {
+                    size_t decoder = 0;
+                    while (decoder + 1 < m_ports.DecoderCount() && m_ports.DecoderName(decoder) != decoderName)
+                        decoder++;
+                    return halZoomSetting(decoder);
+                });
+                reconcileShadow(ShadowState::ACTIVE_INPUT, [this](const string& videoDisplay) {
+                    return halActiveInput(videoDisplay);
+                });
+                //resolving a sound mode takes the whole getSoundMode logic, so those are just read again on next use
+                m_shadow.Invalidate(ShadowState::SOUND_MODE);
+                publishDisplayState();
+                lock.lock();
+            }
+        }
+        void DisplaySettings::reconcileShadow(ShadowState::Setting setting, const std::function<string(const string&)>& read)
+        {
+            for (const auto& entry : m_shadow.Entries(setting))
+            {
+                try
+                {
+                    const uint64_t generation = m_shadow.Generation(setting);
+                    const string value = read(entry.first);
+                    if (m_shadow.Fill(setting, entry.first, value, generation))
+                    {
+                        MYWARN("reconcileShadow: %s had %s, the HAL reports %s\n", entry.first.c_str(), entry.second.c_str(), value.c_str());
+                    }
+                }
+                catch (const device::Exception& err)
+                {
+                    LOG_DEVICE_EXCEPTION0();
+                }
+            }
+        }
+        void DisplaySettings::requestStatePublish()
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_reconcileLock);
+                m_publishPending = true;
+            }
+            m_reconcileSignal.notify_all();
+        }
+        void DisplaySettings::publishDisplayState()
+        {
+            static_assert((int)PortTable::MAX_PORTS <= (int)DisplayStateShm::MAX_PORTS, "the shared state has fewer port slots than the port table");
+            static_assert((int)PortTable::MAX_DECODERS <= (int)DisplayStateShm::MAX_DECODERS, "the shared state has fewer decoder slots than the port table");
+            //zeroed as a whole, the publisher compares it bytewise with the published one
+            DisplayStateShm::DisplayState state;
+            memset(&state, 0, sizeof(state));
+            state.portCount = (uint32_t)m_ports.VideoPortCount();
+            state.primaryHdmi = (m_ports.PrimaryHdmi() == PortTable::NONE) ? (uint32_t)DisplayStateShm::MAX_PORTS : (uint32_t)m_ports.PrimaryHdmi();
+            for (size_t port = 0; port < m_ports.VideoPortCount(); port++)
+            {
+                const string videoDisplay = m_ports.VideoPortName(port);
+                DisplayStateShm::Port& shared = state.ports[port];
+                strncpy(shared.name, videoDisplay.c_str(), DisplayStateShm::NAME_LENGTH - 1);
+                shared.connected = m_displayConnected[port] ? 1 : 0;
+                if (!shared.connected)
+                    continue;
+                try
+                {
+                    const string resolution = shadowRead(ShadowState::RESOLUTION, videoDisplay, [this, videoDisplay]() {
+                        return halResolution(videoDisplay);
+                    });
+                    strncpy(shared.resolution, resolution.c_str(), DisplayStateShm::NAME_LENGTH - 1);
+                }
+                catch (const device::Exception& err)
+                {
+                    LOG_DEVICE_EXCEPTION1(videoDisplay);
+                }
+            }
+            {
+                //what the last sink pass published, without waiting for one in flight
+                std::lock_guard<std::mutex> guard(m_sinkLock);
+                if (m_haveSink && m_sinkConnected)
+                {
+                    state.sinkKnown = 1;
+                    state.edidHash = m_currentSink.edidHash;
+                    state.tvHdrCapabilities = m_currentSink.hdrCapabilities;
+                    state.tvResolutions = m_currentSink.tvResolutions;
+                }
+            }
+            //every decoder, a reader picks the one that drives its output; settopHdrCapabilities stays the first one's
+            state.decoderCount = (uint32_t)m_ports.DecoderCount();
+            for (size_t decoder = 0; decoder < m_ports.DecoderCount(); decoder++)
+            {
+                state.decoderHdrCapabilities[decoder] = -1;
+                try
+                {
+                    state.decoderHdrCapabilities[decoder] = settopHdrCapabilities(decoder);
+                }
+                catch (const device::Exception& err)
+                {
+                    LOG_DEVICE_EXCEPTION0();
+                }
+            }
+            state.settopHdrCapabilities = state.decoderHdrCapabilities[0];
+            if (m_statePublisher.Publish(state))
+            {
+                MYLOG("published display state, %u ports, sink %016llx\n", state.portCount, (unsigned long long)state.edidHash);
+            }
+        }
+        void DisplaySettings::takeStandbySnapshot()
+        {
+            MYTRACE();
+            //every connected port and decoder goes in, not only the ones a client asked about so far
+            for (size_t port = 0; port < m_ports.VideoPortCount(); port++)
+            {
+                if (!m_displayConnected[port])
+                    continue;
+                const string videoDisplay = m_ports.VideoPortName(port);
+                try
+                {
+                    shadowRead(ShadowState::RESOLUTION, videoDisplay, [this, videoDisplay]() {
+                        return halResolution(videoDisplay);
+                    });
+                }
+                catch (const device::Exception& err)
+                {
+                    LOG_DEVICE_EXCEPTION1(videoDisplay);
+                }
+            }
+            for (size_t decoder = 0; decoder < m_ports.DecoderCount(); decoder++)
+            {
+                try
+                {
+                    shadowRead(ShadowState::ZOOM, m_ports.DecoderName(decoder), [this, decoder]() {
+                        return halZoomSetting(decoder);
+                    });
+                }
+                catch (const device::Exception& err)
+                {
+                    LOG_DEVICE_EXCEPTION0();
+                }
+            }
+
+            StandbySnapshot snapshot;
+            snapshot.valid = true;
+            snapshot.taken = std::chrono::steady_clock::now();
+            for (int setting = 0; setting < ShadowState::SETTINGS; setting++)
+                snapshot.settings[setting] = m_shadow.Entries((ShadowState::Setting)setting);
+            {
+                std::lock_guard<std::mutex> guard(m_sinkLock);
+                snapshot.haveSink = m_haveSink && m_sinkConnected;
+                snapshot.sink = m_currentSink;
+            }
+            MYLOG("standby snapshot: %zu resolutions, %zu zoom, %zu sound modes, sink %016llx\n",
+                snapshot.settings[ShadowState::RESOLUTION].size(), snapshot.settings[ShadowState::ZOOM].size(),
+                snapshot.settings[ShadowState::SOUND_MODE].size(), snapshot.haveSink ? (unsigned long long)snapshot.sink.edidHash : 0ULL);
+            std::lock_guard<std::mutex> guard(m_reconcileLock);
+            m_standbySnapshot = snapshot;
+        }
+        void DisplaySettings::validateResume()
+        {   //sample event: {"name":"resumeComplete","params":{"fromSnapshot":true,"standbyMs":60000,"validationMs":640,"sinkChanged":false,"changes":[{"setting":"resolution","videoDisplay":"HDMI0","before":"2160p60","after":"1080p60"}]}}
+            MYTRACE();
+            StandbySnapshot snapshot;
+            {
+                std::unique_lock<std::mutex> lock(m_reconcileLock);
+                snapshot = m_standbySnapshot;
+                m_standbySnapshot = StandbySnapshot();
+                //the HDMI link retrains on resume, give it the same time as after a hotplug
+                if (m_reconcileSignal.wait_for(lock, std::chrono::milliseconds(SINK_SETTLE_MS), [this]() { return m_reconcileStop; }))
+                    return;
+            }
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            JsonObject params;
+            params["fromSnapshot"] = snapshot.valid;
+            if (!snapshot.valid)
+            {
+                //started while in standby, nothing to compare with: everything is read again on use
+                m_shadow.Clear();
+                sendNotify("resumeComplete", params, API_VERSION_MIN);
+                notifyComClients("resumeComplete", [](Exchange::IDisplaySettings::INotification* client) {
+                    client->ResumeComplete(false, 0);
+                });
+                return;
+            }
+            params["standbyMs"] = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(start - snapshot.taken).count();
+
+            //the sink can have been swapped while the box slept, without a hotplug: one EDID read tells
+            const string primary = m_ports.PrimaryHdmiName();
+            std::vector<uint8_t> edid;
+            //an EDID that could not be read says nothing about the sink, it is taken as changed
+            bool edidRead = true;
+            try
+            {
+                edid = sinkHalCall<std::vector<uint8_t>>("getEDIDBytes", primary, [primary]() {
+                    return sinkEdid(primary);
+                });
+            }
+            catch (const HalUnavailable&)
+            {
+                edidRead = false;
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION1(primary);
+            }
+            const bool haveSink = !edid.empty();
+            const bool sinkChanged = !edidRead || (haveSink != snapshot.haveSink) ||
+                (haveSink && SinkCapabilityStore::Hash(edid) != snapshot.sink.edidHash);
+            params["sinkChanged"] = sinkChanged;
+            if (sinkChanged)
+            {
+                //a fresh pass publishes the new sink's capabilities, wait for it like a request would
+                requestSinkPrefetch(haveSink || !edidRead, 0);
+                SinkCapabilityStore::Sink sink;
+                if (haveSink && currentSinkCapabilities(primary, sink))
+                {
+                    char hash[17];
+                    snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)sink.edidHash);
+                    JsonArray standards;
+                    hdrStandardNames(sink.hdrCapabilities, standards);
+                    params["edidHash"] = string(hash);
+                    params["hdrStandards"] = standards;
+                }
+            }
+
+            //resolution and active input follow the sink and the link, check them
+            JsonArray changes;
+            const struct {
+                ShadowState::Setting setting;
+                const char* name;
+                std::function<string(const string&)> read;
+            } validated[] = {
+                { ShadowState::RESOLUTION, "resolution", [this](const string& videoDisplay) { return halResolution(videoDisplay); } },
+                { ShadowState::ACTIVE_INPUT, "activeInput", [this](const string& videoDisplay) { return halActiveInput(videoDisplay); } },
+            };
+            for (const auto& check : validated)
+            {
+                for (const auto& entry : snapshot.settings[check.setting])
+                {
+                    try
+                    {
+                        const string value = check.read(entry.first);
+                        m_shadow.Set(check.setting, entry.first, value);
+                        if (value == entry.second)
+                            continue;
+                        JsonObject change;
+                        change["setting"] = check.name;
+                        change["videoDisplay"] = entry.first;
+                        change["before"] = entry.second;
+                        change["after"] = value;
+                        changes.Add(change);
+                    }
+                    catch (const device::Exception& err)
+                    {
+                        LOG_DEVICE_EXCEPTION0();
+                    }
+                }
+            }
+            //zoom only changes through calls we see; the sound modes do too, unless a different sink came up.
+            //The standby port states are not restored, pwrMgr is asked again on use
+            m_shadow.Restore(ShadowState::ZOOM, snapshot.settings[ShadowState::ZOOM]);
+            if (!sinkChanged)
+                m_shadow.Restore(ShadowState::SOUND_MODE, snapshot.settings[ShadowState::SOUND_MODE]);
+            params["changes"] = changes;
+            params["validationMs"] = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+            sendNotify("resumeComplete", params, API_VERSION_MIN);
+            notifyComClients("resumeComplete", [&](Exchange::IDisplaySettings::INotification* client) {
+                client->ResumeComplete(sinkChanged, changes.Length());
+            });
+        }
+        uint32_t DisplaySettings::queueResolutionJob(const string& videoDisplay, const string& resolution)
+        {
+            uint32_t jobId = 0;
+            ResolutionJob replaced;
+            bool haveReplaced = false;
+            {
+                std::lock_guard<std::mutex> guard(m_resolutionLock);
+                for (ResolutionJob& queued : m_resolutionJobs)
+                {
+                    if (queued.videoDisplay == videoDisplay)
+                    {
+                        //only the latest mode of a port is applied, like the setters; the job keeps its place
+                        replaced = queued;
+                        haveReplaced = true;
+                        jobId = ++m_lastResolutionJobId;
+                        queued.id = jobId;
+                        queued.resolution = resolution;
+                        break;
+                    }
+                }
+                if (!haveReplaced)
+                {
+                    if (m_resolutionJobs.size() >= PortTable::MAX_PORTS)
+                        return 0;
+                    jobId = ++m_lastResolutionJobId;
+                    ResolutionJob job;
+                    job.id = jobId;
+                    job.videoDisplay = videoDisplay;
+                    job.resolution = resolution;
+                    m_resolutionJobs.push_back(job);
+                }
+            }
+            m_resolutionSignal.notify_all();
+            if (haveReplaced)
+            {
+                MYLOG("queueResolutionJob: job %u on %s replaced by job %u\n", replaced.id, videoDisplay.c_str(), jobId);
+                JsonObject params;
+                params["coalesced"] = true;
+                resolutionJobComplete(replaced, params, true);
+            }
+            return jobId;
+        }
+        void DisplaySettings::resolutionJobComplete(const ResolutionJob& job, JsonObject& params, bool success)
+        {
+            params["jobId"] = job.id;
+            params["videoDisplay"] = job.videoDisplay;
+            params["resolution"] = job.resolution;
+            params["success"] = success;
+            sendNotify("resolutionChangeComplete", params, API_VERSION_MIN);
+            notifyComClients("resolutionChangeComplete", [&](Exchange::IDisplaySettings::INotification* client) {
+                client->ResolutionChangeComplete(job.id, job.videoDisplay, job.resolution, success);
+            });
+        }
+        int DisplaySettings::settopHdrCapabilities(size_t decoder)
+        {
+            //a decoder's HDR support is fixed for the platform, ask the HAL once
+            if (decoder < PortTable::MAX_DECODERS)
+            {
+                std::lock_guard<std::mutex> guard(m_modeLock);
+                if (m_settopHdr[decoder] >= 0)
+                    return m_settopHdr[decoder];
+            }
+            int capabilities = halCall<int>("getHDRCapabilities", m_ports.DecoderName(decoder), [decoder]() {
+                int settopCapabilities = dsHDRSTANDARD_NONE;
+                device::VideoDevice &device = device::Host::getInstance().getVideoDevices().at(decoder);
+                device.getHDRCapabilities(&settopCapabilities);
+                return settopCapabilities;
+            });
+            if (decoder < PortTable::MAX_DECODERS)
+            {
+                std::lock_guard<std::mutex> guard(m_modeLock);
+                m_settopHdr[decoder] = capabilities;
+            }
+            return capabilities;
+        }
+        void DisplaySettings::getSupportedResolutionsHelper(const string& videoDisplay, ResolutionNameList& supportedResolutions)
+        {
+            //the modes a port supports come from the platform config and do not change, ask the HAL once per port
+            size_t port = m_ports.VideoPortIndex(videoDisplay);
+            supportedResolutions.clear();
+            if (port != PortTable::NONE)
+            {
+                std::lock_guard<std::mutex> guard(m_modeLock);
+                if (m_supportedResolutionsValid[port])
+                {
+                    for (ResolutionNames::Id id : m_supportedResolutions[port])
+                        supportedResolutions.emplace_back(m_resolutionNames.Name(id));
+                    return;
+                }
+            }
+            const ResolutionNameList reported = halCall<ResolutionNameList>("getSupportedResolutions", videoDisplay, [videoDisplay]() {
+                ResolutionNameList names;
+                device::VideoOutputPort &vPort = device::Host::getInstance().getVideoOutputPort(videoDisplay);
+                const device::List<device::VideoResolution> resolutions = device::VideoOutputPortConfig::getInstance().getPortType(vPort.getType().getId()).getSupportedResolutions();
+                for (size_t i = 0; i < resolutions.size(); i++)
+                    names.emplace_back(resolutions.at(i).getName());
+                warnIfSpilled("getSupportedResolutions", names);
+                return names;
+            });
+            //interning dedups the list; a name the table has no room for is still answered, just not cached
+            ResolutionIdList ids;
+            ResolutionNames::Set seen;
+            bool complete = true;
+            for (const string& name : reported)
+            {
+                const ResolutionNames::Id id = m_resolutionNames.Intern(name);
+                if (id == ResolutionNames::NONE)
+                {
+                    complete = false;
+                    supportedResolutions.emplace_back(name);
+                }
+                else if (!seen.test(id))
+                {
+                    seen.set(id);
+                    ids.emplace_back(id);
+                    supportedResolutions.emplace_back(name);
+                }
+            }
+            if (port != PortTable::NONE && complete && !ids.empty())
+            {
+                std::lock_guard<std::mutex> guard(m_modeLock);
+                m_supportedResolutions[port] = ids;
+                m_supportedResolutionSets[port] = seen;
+                m_supportedResolutionsValid[port] = true;
+            }
+        }
+        bool DisplaySettings::supportsResolution(const string& videoDisplay, const string& resolution, const ResolutionNameList& supported)
+        {
+            const size_t port = m_ports.VideoPortIndex(videoDisplay);
+            if (port != PortTable::NONE)
+            {
+                const ResolutionNames::Id id = m_resolutionNames.Find(resolution);
+                std::lock_guard<std::mutex> guard(m_modeLock);
+                if (m_supportedResolutionsValid[port])
+                    return id != ResolutionNames::NONE && m_supportedResolutionSets[port].test(id);
+            }
+            //not cached, the name table had no room for all of the port's modes
+            for (const string& name : supported)
+            {
+                if (name == resolution)
+                    return true;
+            }
+            return false;
+        }
+        void DisplaySettings::resolutionWorker()
+        {
+            std::unique_lock<std::mutex> lock(m_resolutionLock);
+            while (true)
+            {
+                m_resolutionSignal.wait(lock, [this]() { return m_resolutionWorkerStop || !m_resolutionJobs.empty(); });
+                if (m_resolutionWorkerStop)
+                    break;
+                ResolutionJob job = m_resolutionJobs.front();
+                m_resolutionJobs.pop_front();
+                m_resolutionJobDisplay = job.videoDisplay;
+                const size_t port = m_ports.VideoPortIndex(job.videoDisplay);
+                const uint32_t postChangeCount = (port != PortTable::NONE) ? m_postChanges[port].count : 0;
+                lock.unlock();
+
+                MYLOG("resolutionWorker: job %u setting %s on %s\n", job.id, job.resolution.c_str(), job.videoDisplay.c_str());
+                JsonObject params;
+                bool success = true;
+                bool coalesced = false;
+                try
+                {
+                    //one at a time with setCurrentResolution on the port; a newer request for it replaces this job
+                    coalesced = (applyResolution(job.videoDisplay, job.resolution) == SetterQueue::COALESCED);
+                    if (coalesced)
+                        params["coalesced"] = true;
+                }
+                catch (const device::Exception& err)
+                {
+                    MYWARN("resolutionWorker: job %u failed code=%d message=%s\n", job.id, err.getCode(), err.what());
+                    params["error_message"] = err.what();
+                    success = false;
+                }
+
+                lock.lock();
+                if (success && !coalesced && port != PortTable::NONE)
+                {
+                    //dsMgr calls ResolutionPostChange once the new mode is out, the one for this port that reads back this
+                    //resolution is ours; if it never comes (same mode, another mode won) report without size
+                    const PostChange& postChange = m_postChanges[port];
+                    const auto matched = [&]() {
+                        return postChange.count != postChangeCount && postChange.resolution == job.resolution;
+                    };
+                    if (m_resolutionSignal.wait_for(lock, std::chrono::milliseconds(RESOLUTION_POSTCHANGE_WAIT_MS), [&]() {
+                            return m_resolutionWorkerStop || matched(); })
+                        && matched())
+                    {
+                        params["width"] = postChange.width;
+                        params["height"] = postChange.height;
+                    }
+                }
+                m_resolutionJobDisplay.clear();
+                lock.unlock();
+                resolutionJobComplete(job, params, success);
+                lock.lock();
+            }
+        }
 	} // namespace Plugin
 } // namespace WPEFramework
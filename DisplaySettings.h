@@ -3,6 +3,30 @@
 #include "Module.h"
 #include "libIBus.h"
 #include "irMgr.h"
+#include "HalExecutor.h"
+#include "FixedList.h"
+#include "RequestArena.h"
+#include "NameTable.h"
+#include "PortTable.h"
+#include "SinkCapabilityStore.h"
+#include "SinkQuirks.h"
+#include "ModeSelector.h"
+#include "ShadowState.h"
+#include "SetterQueue.h"
+#include "DisplayStatePublisher.h"
+#include "IDisplaySettings.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
 
 namespace WPEFramework {
 
@@ -20,11 +44,30 @@ namespace WPEFramework {
 		// As the registration/unregistration of notifications is realized by the class PluginHost::JSONRPC,
 		// this class exposes a public method called, Notify(), using this methods, all subscribed clients
 		// will receive a JSONRPC message as a notification, in case this method is called.
-        class DisplaySettings : public PluginHost::IPlugin, public PluginHost::JSONRPC {
+        class DisplaySettings : public PluginHost::IPlugin, public PluginHost::JSONRPC, public Exchange::IDisplaySettings {
         private:
+            //"DisplaySettings.<N>.method" is served at DS API level N for N in 2..7. Interface version 1
+            //predates the levels and is served at the latest one. Each interface version has its own
+            //method set, built once by registerMethods<LEVEL>, so handlers never ask for the caller's level.
+            enum { API_VERSION_MIN = 2, API_VERSION_MAX = 7 };
+            static uint32_t apiVersionOf(uint8_t interfaceVersion) { return (interfaceVersion == 1) ? (uint32_t)API_VERSION_MAX : (uint32_t)interfaceVersion; }
+
             typedef Core::JSON::String JString;
             typedef Core::JSON::ArrayType<JString> JStringArray;
             typedef Core::JSON::Boolean JBool;
+            //bounded lists built while handling a request, see FixedList.h
+            typedef FixedList<string, 8> PortNameList;
+            typedef FixedList<string, 32> ResolutionNameList;
+            typedef FixedList<string, 16> AudioModeList;
+            //interned audio mode names of a response, they stay valid as long as the plugin
+            typedef FixedList<const char*, 16> AudioModeNameList;
+            //resolution and audio mode names are interned as the HAL reports them, the caches hold ids
+            //and the names are looked up again when a response is written, see NameTable.h
+            typedef NameTable<64> ResolutionNames;
+            typedef NameTable<32> AudioModeNames;
+            //audio and video port names, only to drop the duplicates of the HAL's port lists
+            typedef NameTable<32> PortNames;
+            typedef FixedList<ResolutionNames::Id, 32> ResolutionIdList;
 
             // We do not allow this plugin to be copied !!
             DisplaySettings(const DisplaySettings&) = delete;
@@ -39,13 +82,14 @@ namespace WPEFramework {
             uint32_t getSupportedTvResolutions(const JsonObject& parameters, JsonObject& response);
             uint32_t getSupportedSettopResolutions(const JsonObject& parameters, JsonObject& response);            
             uint32_t getSupportedAudioPorts(const JsonObject& parameters, JsonObject& response);
-            uint32_t getSupportedAudioModes(const JsonObject& parameters, JsonObject& response);
+            template<uint32_t VERSION> uint32_t getSupportedAudioModes(const JsonObject& parameters, JsonObject& response);
             uint32_t getZoomSetting(const JsonObject& parameters, JsonObject& response);
             uint32_t setZoomSetting(const JsonObject& parameters, JsonObject& response);
             uint32_t getCurrentResolution(const JsonObject& parameters, JsonObject& response);
             uint32_t setCurrentResolution(const JsonObject& parameters, JsonObject& response);
-            uint32_t getSoundMode(const JsonObject& parameters, JsonObject& response);
-            uint32_t setSoundMode(const JsonObject& parameters, JsonObject& response);
+            uint32_t setCurrentResolutionAsync(const JsonObject& parameters, JsonObject& response);
+            template<uint32_t VERSION> uint32_t getSoundMode(const JsonObject& parameters, JsonObject& response);
+            template<uint32_t VERSION> uint32_t setSoundMode(const JsonObject& parameters, JsonObject& response);
             uint32_t readEDID(const JsonObject& parameters, JsonObject& response);
             uint32_t readHostEDID(const JsonObject& parameters, JsonObject& response);
             uint32_t getActiveInput(const JsonObject& parameters, JsonObject& response);
@@ -53,6 +97,14 @@ namespace WPEFramework {
             uint32_t getSettopHDRSupport(const JsonObject& parameters, JsonObject& response);
             uint32_t setVideoPortStatusInStandby(const JsonObject& parameters, JsonObject& response);
             uint32_t getVideoPortStatusInStandby(const JsonObject& parameters, JsonObject& response);
+            uint32_t getAllVideoPortStatusInStandby(const JsonObject& parameters, JsonObject& response);
+            uint32_t getHalStatus(const JsonObject& parameters, JsonObject& response);
+            uint32_t setCaptureMode(const JsonObject& parameters, JsonObject& response);
+            uint32_t getCaptureMode(const JsonObject& parameters, JsonObject& response);
+            uint32_t setNotificationFilter(const JsonObject& parameters, JsonObject& response);
+            uint32_t getNotificationStats(const JsonObject& parameters, JsonObject& response);
+            uint32_t getSetterStats(const JsonObject& parameters, JsonObject& response);
+            uint32_t selectBestResolution(const JsonObject& parameters, JsonObject& response);
             //End methods
 
             //Begin events
@@ -61,6 +113,17 @@ namespace WPEFramework {
             void zoomSettingUpdated(const string& zoomSetting);
             void activeInputChanged(bool activeInput);
             void connectedVideoDisplaysUpdated(int hdmiHotPlugEvent);
+            void hdcpStatusChanged(int hdcpStatus);
+            void hdmiInputHotPlug(int port, bool connected);
+            void powerModeChanged(int currentState, int newState);
+            //state notifications are only sent when their payload differs from the last one sent for that event and
+            //port, or to consumers that force them; call makes the IDisplaySettings::INotification call of the event
+            template<typename CALL> void notifyIfChanged(const char* event, const string& port, const JsonObject& params, const CALL& call, uint32_t minApiVersion = API_VERSION_MIN);
+            //to the subscribers of every interface version whose API level is at least minApiVersion, each after
+            //its own notification filter; an unchanged payload only goes to the subscribers that force them
+            void notifyClients(const char* event, const JsonObject& params, uint32_t minApiVersion, bool changed = true);
+            //to the IDisplaySettings::INotification sinks, the same way
+            template<typename CALL> void notifyComClients(const char* event, const CALL& call, bool changed = true);
             //End events
         public:
             DisplaySettings();
@@ -69,11 +132,32 @@ namespace WPEFramework {
             BEGIN_INTERFACE_MAP(DisplaySettings)
             INTERFACE_ENTRY(PluginHost::IPlugin)
             INTERFACE_ENTRY(PluginHost::IDispatcher)
+            INTERFACE_ENTRY(Exchange::IDisplaySettings)
             END_INTERFACE_MAP
             //IPlugin methods
             virtual const string Initialize(PluginHost::IShell* service) override;
             virtual void Deinitialize(PluginHost::IShell* service) override;
             virtual string Information() const override;
+            //IDisplaySettings methods
+            virtual uint32_t Register(Exchange::IDisplaySettings::INotification* client) override;
+            virtual uint32_t Unregister(Exchange::IDisplaySettings::INotification* client) override;
+            virtual uint32_t SetNotificationFilter(Exchange::IDisplaySettings::INotification* client, const bool force, RPC::IStringIterator* disabledEvents) override;
+            virtual uint32_t ConnectedVideoDisplays(RPC::IStringIterator*& videoDisplays) override;
+            virtual uint32_t SupportedResolutions(const string& videoDisplay, RPC::IStringIterator*& resolutions) override;
+            virtual uint32_t CurrentResolution(const string& videoDisplay, string& resolution) override;
+            virtual uint32_t SetCurrentResolution(const string& videoDisplay, const string& resolution) override;
+            virtual uint32_t ZoomSetting(const uint8_t videoDecoder, string& zoomSetting) override;
+            virtual uint32_t SetZoomSetting(const uint8_t videoDecoder, const string& zoomSetting) override;
+            virtual uint32_t SoundMode(const string& audioPort, string& soundMode) override;
+            virtual uint32_t SetSoundMode(const string& audioPort, const string& soundMode) override;
+            virtual uint32_t SupportedAudioModes(const string& audioPort, RPC::IStringIterator*& audioModes) override;
+            virtual uint32_t ActiveInput(const string& videoDisplay, bool& activeInput) override;
+            virtual uint32_t TvHDRSupport(const string& videoDisplay, uint32_t& hdrStandards) override;
+            virtual uint32_t SettopHDRSupport(const uint8_t videoDecoder, uint32_t& hdrStandards) override;
+            virtual uint32_t SupportedTvResolutions(const string& videoDisplay, uint32_t& tvResolutions) override;
+            virtual uint32_t EDID(const string& videoDisplay, uint16_t& length, uint8_t data[]) override;
+            virtual uint32_t VideoPortStatusInStandby(const string& videoPort, bool& enabled) override;
+            virtual uint32_t SetVideoPortStatusInStandby(const string& videoPort, const bool enabled) override;
         private:
             void InitializeIARM();
             void DeinitializeIARM();
@@ -81,14 +165,230 @@ namespace WPEFramework {
 		    static IARM_Result_t ResolutionPostChange(void *arg);
             static void DisplResolutionHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
             static void dsHdmiEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
-            void getConnectedVideoDisplaysHelper(std::vector<string>& connectedDisplays);
-            //TODO/FIXME -- these are carried over from ServiceManager DisplaySettings - we need to munge this around to support the Thunder plugin version number
-            uint32_t getApiVersionNumber();
-            void setApiVersionNumber(uint32_t apiVersionNumber);
+            static void pwrMgrEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
+            void getConnectedVideoDisplaysHelper(PortNameList& connectedDisplays);
+            void getSupportedVideoDisplaysHelper(PortNameList& supportedVideoDisplays);
+            bool getVideoPortStatusInStandbyHelper(const string& portname, bool refresh, bool& enabled, string& error);
+            bool setVideoPortStatusInStandbyHelper(const string& portname, bool enabled, string& error);
+            void setStandbyVideoState(const string& portname, int8_t state);
+            bool videoDecoderParam(const JsonObject& parameters, size_t& decoder);
+            void buildPortTable();
+            void refreshAudioCapabilities();
+            //the AUTO sound mode of an HDMI port follows its sink; set from the prefetch pass, no HAL calls
+            void setAutoAudioMode(const string& hdmiPort, bool connected, int surroundMode);
+            //hotplug prefetch: once the link settled m_sinkThread reads the EDID of the sink on the primary HDMI
+            //port and its capabilities (from m_sinkStore when known) in one pass and publishes them together;
+            //requests for the primary HDMI sink wait for a pass in flight instead of reading the HAL themselves
+            void requestSinkPrefetch(bool connected, uint32_t settleMs);
+            void sinkPrefetchWorker();
+            void prefetchSink(uint64_t generation);
+            void finishSinkPrefetch(uint64_t generation);
+            bool waitForSink(std::unique_lock<std::mutex>& lock);
+            bool currentSinkCapabilities(const string& videoDisplay, SinkCapabilityStore::Sink& sink);
+            std::shared_ptr<const std::vector<uint8_t>> currentSinkEdid(const string& videoDisplay);
+            void getSupportedResolutionsHelper(const string& videoDisplay, ResolutionNameList& supportedResolutions);
+            //supported is what getSupportedResolutionsHelper answered for videoDisplay
+            bool supportsResolution(const string& videoDisplay, const string& resolution, const ResolutionNameList& supported);
+            //capability bits of the sink on videoDisplay, from the prefetch for the primary HDMI port
+            int sinkHdrCapabilities(const string& videoDisplay);
+            int sinkTvResolutions(const string& videoDisplay);
+            //hands consume the EDID where it already is, the sink cache or the HAL's buffer; false, and consume
+            //is not called, when there is no sink
+            bool readEDIDHelper(const string& videoDisplay, const std::function<void(const uint8_t* data, size_t length)>& consume);
+            //live settings come from m_shadow, the HAL is only read on a miss and by m_reconcileThread
+            string shadowRead(ShadowState::Setting setting, const string& key, const std::function<string()>& read);
+            string halResolution(const string& videoDisplay);
+            string halZoomSetting(size_t decoder);
+            string halActiveInput(const string& videoDisplay);
+            void shadowReconciler();
+            void reconcileShadow(ShadowState::Setting setting, const std::function<string(const string&)>& read);
+            //standby entry and resume, run by m_reconcileThread
+            void takeStandbySnapshot();
+            void validateResume();
+            //refreshes the shared memory display state (DisplayStateShm.h) from m_reconcileThread
+            void requestStatePublish();
+            void publishDisplayState();
+            //mode is a device::AudioStereoMode id
+            //the setters shared by JSON-RPC and IDisplaySettings, admission is up to the caller
+            SetterQueue::Outcome applyResolution(const string& videoDisplay, const string& resolution);
+            SetterQueue::Outcome applyZoomSetting(size_t decoder, const string& zoomSetting);
+            template<uint32_t VERSION> SetterQueue::Outcome applySoundMode(const string& audioPort, const string& soundMode, int mode, bool stereoAuto);
+            //the sound mode methods of one API level, for the JSON-RPC handlers and IDisplaySettings alike
+            template<uint32_t VERSION> void getSoundModeHelper(string videoDisplay, string& soundMode);
+            template<uint32_t VERSION> bool setSoundModeHelper(string videoDisplay, const string& soundMode, bool& coalesced);
+            template<uint32_t VERSION> void getSupportedAudioModesHelper(const string& audioPort, AudioModeNameList& supportedAudioModes);
+            void resolutionWorker();
+            //0 when the queue is full; a job still waiting for the same port is replaced
+            uint32_t queueResolutionJob(const string& videoDisplay, const string& resolution);
+            int settopHdrCapabilities(size_t decoder);
+            //HAL and IARM calls go through m_halExecutor so a wedged dsMgr/pwrMgr can not hold a JSON-RPC thread
+            void halApply(const char* name, const string& port, const std::function<void()>& call, uint32_t deadlineMs);
+            //only for calls whose result depends on nothing but name and port, see m_lastKnown
+            template<typename T> T halCall(const char* name, const string& port, const std::function<T()>& call);
+            //what the connected sink is (EDID, HDR, resolutions, surround): never a last known value, that may be another sink's
+            template<typename T> T sinkHalCall(const char* name, const string& port, const std::function<T()>& call);
+            template<uint32_t VERSION> void registerMethods(uint8_t interfaceVersion);
+            template<typename METHOD> void registerMethod(Core::JSONRPC::Handler& handler, uint8_t version, const char* name, const METHOD& method);
+            template<typename METHOD> void registerSetter(Core::JSONRPC::Handler& handler, uint8_t version, const char* name, const METHOD& method, bool (*limited)(const JsonObject&) = nullptr);
         public:
             static DisplaySettings* _instance;
         private:
-            uint32_t m_apiVersionNumber;
+            //every method registered by registerMethods, with the handler it went to
+            std::vector<std::pair<Core::JSONRPC::Handler*, string>> m_registeredMethods;
+            HalExecutor m_halExecutor;
+            //what halCall answers while the HAL is unavailable, per call name and port; cleared by Deinitialize
+            std::mutex m_lastKnownLock;
+            std::map<std::pair<const char*, string>, std::shared_ptr<void>> m_lastKnown;
+
+            //setCurrentResolutionAsync jobs, run one at a time by m_resolutionWorkerThread; at most one waits per port
+            struct ResolutionJob {
+                uint32_t id;
+                string videoDisplay;
+                string resolution;
+            };
+            void resolutionJobComplete(const ResolutionJob& job, JsonObject& params, bool success);
+            std::mutex m_resolutionLock;
+            std::condition_variable m_resolutionSignal;
+            std::deque<ResolutionJob> m_resolutionJobs;
+            std::thread m_resolutionWorkerThread;
+            bool m_resolutionWorkerStop;
+            uint32_t m_lastResolutionJobId;
+            //the port of the job m_resolutionWorkerThread is running, empty when idle
+            string m_resolutionJobDisplay;
+            //the last ResolutionPostChange per port and the mode read back with it; a job waits for the one
+            //of its port and resolution, not just any. dsMgr's call does not name a port, so it is recorded
+            //for the connected displays and for the port of the running job
+            //reads the port's resolution back and returns it; throws when the HAL can not answer
+            string recordPostChange(const string& videoDisplay, int width, int height);
+            struct PostChange {
+                uint32_t count = 0;
+                string resolution;
+                int width = 0;
+                int height = 0;
+            };
+            std::array<PostChange, PortTable::MAX_PORTS> m_postChanges;
+
+            //video ports and decoders, see PortTable.h; built in InitializeIARM before any handler is registered
+            PortTable m_ports;
+            //display connected per port slot, the primary HDMI slot follows the hotplug event
+            std::array<std::atomic<bool>, PortTable::MAX_PORTS> m_displayConnected;
+
+            //standby video port state per port slot, filled by successful pwrMgr get/set calls; other pwrMgr clients
+            //can change it unseen, so it is dropped on every power mode change and read again after STANDBY_STATE_TTL_MS
+            enum { STANDBY_STATE_UNKNOWN = -1, STANDBY_STATE_DISABLED = 0, STANDBY_STATE_ENABLED = 1 };
+            std::mutex m_standbyLock;
+            std::array<int8_t, PortTable::MAX_PORTS> m_standbyVideoStates;
+            std::array<std::chrono::steady_clock::time_point, PortTable::MAX_PORTS> m_standbyVideoStatesRead;
+
+            //getSupportedAudioModes answers: stereo modes per audio port and API version bucket, and the
+            //AUTO mode each HDMI sink supports. Rebuilt on hotplug and AUDIO_MODE, replaced as a whole.
+            struct AudioCapabilities {
+                enum VersionBucket { DS4 = 0, DS5 = 1, VERSION_BUCKETS = 2 };
+                struct AudioPort {
+                    string name;
+                    AudioModeNames::Set modes[VERSION_BUCKETS];
+                    bool hasSurround = false;
+                };
+                struct HdmiPort {
+                    string name;
+                    AudioModeNames::Id autoMode = AudioModeNames::NONE;
+                };
+                FixedList<AudioPort, PortTable::MAX_PORTS> audioPorts;
+                FixedList<HdmiPort, PortTable::MAX_PORTS> hdmiPorts;
+                //every mode of audioPorts once, in the order the HAL first reported it
+                FixedList<AudioModeNames::Id, 32> modeOrder;
+            };
+            std::shared_ptr<const AudioCapabilities> audioCapabilities();
+            std::mutex m_audioCapabilitiesLock;
+            std::shared_ptr<const AudioCapabilities> m_audioCapabilities;
+            AudioModeNames m_audioModeNames;
+
+            //notifyIfChanged state: last payload per event and port, and per event counters
+            struct NotificationCounters {
+                uint64_t emitted = 0;
+                uint64_t suppressed = 0;
+                uint64_t filtered = 0;     //deliveries withheld from consumers that disabled the event
+            };
+            //setNotificationFilter, per consumer: a JSON-RPC subscriber by the id it registered its events with, or an INotification sink
+            struct NotificationFilter {
+                bool force = false;
+                std::set<string> disabledEvents;
+            };
+            struct NotificationFilters {
+                std::map<string, NotificationFilter> subscribers;
+                std::map<const Exchange::IDisplaySettings::INotification*, NotificationFilter> sinks;
+            };
+            std::shared_ptr<const NotificationFilters> notificationFilters();
+            //copy, change and swap under m_notifyLock, the senders keep the snapshot they started with
+            void updateNotificationFilter(const std::function<void(NotificationFilters&)>& update);
+            void countFiltered(const char* event, uint64_t filtered);
+            std::mutex m_notifyLock;
+            //held across the JSON-RPC notify, so the notifications of an event go out in the order of the state
+            //changes; only the senders take it, the filter and stats methods do not wait for a notify
+            std::mutex m_notifyOrderLock;
+            std::shared_ptr<const NotificationFilters> m_notificationFilters;
+            std::map<std::pair<string, string>, string> m_lastNotified;
+            std::map<string, NotificationCounters> m_notificationCounters;
+
+            //capabilities of the sink on the primary HDMI port, see requestSinkPrefetch
+            std::mutex m_sinkLock;
+            SinkCapabilityStore m_sinkStore;
+            bool m_sinkConnected;
+            bool m_haveSink;
+            SinkCapabilityStore::Sink m_currentSink;
+            //replaced, never changed in place: a reader takes the pointer under m_sinkLock and reads it after
+            std::shared_ptr<const std::vector<uint8_t>> m_currentEdid;
+            bool m_sinkIdentified;
+            SinkQuirks::Id m_sinkId;
+            uint32_t m_sinkQuirks;          //SinkQuirks bits of the current sink
+            std::condition_variable m_sinkSignal;   //wakes m_sinkThread
+            std::condition_variable m_sinkReady;    //wakes requests waiting for a pass
+            std::thread m_sinkThread;
+            bool m_sinkPrefetchStop;
+            bool m_sinkPrefetchPending;
+            bool m_sinkPrefetching;
+            uint32_t m_sinkSettleMs;
+            uint64_t m_sinkGeneration;
+
+            //platform mode data that never changes at runtime, filled on first use per port/decoder slot
+            std::mutex m_modeLock;
+            ResolutionNames m_resolutionNames;
+            std::array<ResolutionIdList, PortTable::MAX_PORTS> m_supportedResolutions;
+            std::array<ResolutionNames::Set, PortTable::MAX_PORTS> m_supportedResolutionSets;
+            std::array<bool, PortTable::MAX_PORTS> m_supportedResolutionsValid;
+            PortNames m_portNames;
+            std::array<int, PortTable::MAX_DECODERS> m_settopHdr;
+
+            //resolution, zoom, sound mode and active input as last seen, see ShadowState.h
+            ShadowState m_shadow;
+            std::mutex m_reconcileLock;
+            std::condition_variable m_reconcileSignal;
+            std::thread m_reconcileThread;
+            bool m_reconcileStop;
+
+            //display state when standby was entered; on resume what can have changed is checked against
+            //the HAL and the rest is served from here again. Guarded by m_reconcileLock.
+            struct StandbySnapshot {
+                bool valid = false;
+                std::chrono::steady_clock::time_point taken;
+                std::vector<std::pair<string, string>> settings[ShadowState::SETTINGS];
+                bool haveSink = false;
+                SinkCapabilityStore::Sink sink = SinkCapabilityStore::Sink();
+            };
+            StandbySnapshot m_standbySnapshot;
+            bool m_standbyPending;
+            bool m_resumePending;
+
+            //ports, resolutions and sink capabilities for native readers, see DisplayStateShm.h
+            DisplayStatePublisher m_statePublisher;
+            bool m_publishPending;
+
+            //setCurrentResolution(Async), setSoundMode and setZoomSetting: rate limit and last writer wins per port
+            SetterQueue m_setters;
+
+            //IDisplaySettings::INotification sinks, each holding a reference
+            std::mutex m_comClientsLock;
+            std::list<Exchange::IDisplaySettings::INotification*> m_comClients;
         };
 	} // namespace Plugin
 } // namespace WPEFramework
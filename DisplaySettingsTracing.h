@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Module.h"
+
+#include <cstdarg>
+#include <string>
+
+// Trace categories of the plugin, emitted through the Thunder tracing module. Every category is
+// switched on and off at runtime per module through Thunder's tracing controls (TraceControl
+// plugin or the "tracing" section of config.json); while one is off a DS_TRACE costs a single
+// flag test and its arguments are not evaluated. DS_TRACE_ENABLED tells whether a category is on,
+// for a caller that has to build the arguments first. Configuring with -DDISPLAYSETTINGS_TRACING=OFF
+// removes every DS_TRACE from the build.
+//   MethodEntry   JSON-RPC method and its parameters
+//   MethodExit    JSON-RPC method, success and duration
+//   HalCall       DS HAL / IARM call made through the HAL executor, its result and duration
+//   IarmEvent     IARM event or call received by the plugin
+//   Notification  JSON-RPC notification sent to clients
+#ifndef DISPLAYSETTINGS_TRACING
+#define DISPLAYSETTINGS_TRACING 1
+#endif
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        namespace Tracing {
+
+            //a category is a class: Thunder lists and toggles it by its class name
+#define DISPLAYSETTINGS_TRACE_CATEGORY(CATEGORY)                                     \
+            class CATEGORY {                                                         \
+            public:                                                                  \
+                CATEGORY(const CATEGORY&) = delete;                                  \
+                CATEGORY& operator=(const CATEGORY&) = delete;                       \
+                CATEGORY(const TCHAR formatter[], ...)                               \
+                {                                                                    \
+                    va_list ap;                                                      \
+                    va_start(ap, formatter);                                         \
+                    Trace::Format(_text, formatter, ap);                             \
+                    va_end(ap);                                                      \
+                }                                                                    \
+                const char* Data() const { return _text.c_str(); }                   \
+                uint16_t Length() const { return static_cast<uint16_t>(_text.length()); } \
+            private:                                                                 \
+                std::string _text;                                                   \
+            };
+
+            DISPLAYSETTINGS_TRACE_CATEGORY(MethodEntry)
+            DISPLAYSETTINGS_TRACE_CATEGORY(MethodExit)
+            DISPLAYSETTINGS_TRACE_CATEGORY(HalCall)
+            DISPLAYSETTINGS_TRACE_CATEGORY(IarmEvent)
+            DISPLAYSETTINGS_TRACE_CATEGORY(Notification)
+
+#undef DISPLAYSETTINGS_TRACE_CATEGORY
+
+        } // namespace Tracing
+    } // namespace Plugin
+} // namespace WPEFramework
+
+//the switch TRACE_GLOBAL tests for a category
+#ifndef DS_TRACE_TYPE
+#define DS_TRACE_TYPE(CATEGORY) WPEFramework::Trace::TraceType<CATEGORY, &WPEFramework::Core::System::MODULE_NAME>
+#endif
+
+#if DISPLAYSETTINGS_TRACING
+//TRACE_GLOBAL rather than TRACE: the IARM handlers are static and have no *this to name
+#define DS_TRACE(CATEGORY, PARAMETERS) TRACE_GLOBAL(WPEFramework::Plugin::Tracing::CATEGORY, PARAMETERS)
+#define DS_TRACE_ENABLED(CATEGORY) (DS_TRACE_TYPE(WPEFramework::Plugin::Tracing::CATEGORY)::IsEnabled())
+#else
+#define DS_TRACE(CATEGORY, PARAMETERS)
+#define DS_TRACE_ENABLED(CATEGORY) (false)
+#endif
@@ -0,0 +1,100 @@
+#include "DisplayStatePublisher.h"
+
+#include <new>
+#include <stdio.h>
+#include <sys/stat.h>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        DisplayStatePublisher::DisplayStatePublisher()
+            : m_lock()
+            , m_segment(nullptr)
+        {
+        }
+        DisplayStatePublisher::~DisplayStatePublisher()
+        {
+            Close();
+        }
+        bool DisplayStatePublisher::Open()
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            if (m_segment != nullptr)
+                return true;
+            //readable by everyone, written by us only
+            int fd = shm_open(DisplayStateShm::SegmentName, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+            if (fd < 0)
+            {
+                perror("DisplayStatePublisher shm_open");
+                return false;
+            }
+            fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+            if (ftruncate(fd, sizeof(DisplayStateShm::Segment)) != 0)
+            {
+                perror("DisplayStatePublisher ftruncate");
+                close(fd);
+                return false;
+            }
+            void* address = mmap(nullptr, sizeof(DisplayStateShm::Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (address == MAP_FAILED)
+            {
+                perror("DisplayStatePublisher mmap");
+                return false;
+            }
+            //a segment left by a previous run is reused; its sequence carries on so readers see a change
+            DisplayStateShm::Segment* segment = static_cast<DisplayStateShm::Segment*>(address);
+            const bool reuse = (segment->magic == DisplayStateShm::MAGIC && segment->version == DisplayStateShm::VERSION &&
+                segment->stateSize == sizeof(DisplayStateShm::DisplayState));
+            if (!reuse)
+            {
+                memset(address, 0, sizeof(DisplayStateShm::Segment));
+                segment = new (address) DisplayStateShm::Segment();
+                segment->sequence.store(0, std::memory_order_relaxed);
+                segment->stateSize = sizeof(DisplayStateShm::DisplayState);
+                segment->version = DisplayStateShm::VERSION;
+                std::atomic_thread_fence(std::memory_order_release);
+                segment->magic = DisplayStateShm::MAGIC;
+            }
+            else if (segment->sequence.load(std::memory_order_relaxed) & 1)
+            {
+                //the previous run died in the middle of a write
+                segment->sequence.fetch_add(1, std::memory_order_release);
+            }
+            m_segment = segment;
+            return true;
+        }
+        void DisplayStatePublisher::Close()
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            if (m_segment == nullptr)
+                return;
+            const uint32_t sequence = m_segment->sequence.load(std::memory_order_relaxed);
+            m_segment->sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_segment->alive = 0;
+            m_segment->sequence.store(sequence + 2, std::memory_order_release);
+            munmap(m_segment, sizeof(DisplayStateShm::Segment));
+            m_segment = nullptr;
+            shm_unlink(DisplayStateShm::SegmentName);
+        }
+        bool DisplayStatePublisher::Publish(const DisplayStateShm::DisplayState& state)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            if (m_segment == nullptr)
+                return false;
+            //we are the only writer, so the state can be compared without the seqlock
+            if (m_segment->alive && memcmp(&m_segment->state, &state, sizeof(state)) == 0)
+                return false;
+            const uint32_t sequence = m_segment->sequence.load(std::memory_order_relaxed);
+            m_segment->sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            memcpy(&m_segment->state, &state, sizeof(state));
+            m_segment->alive = 1;
+            m_segment->sequence.store(sequence + 2, std::memory_order_release);
+            return true;
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
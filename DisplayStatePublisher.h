@@ -0,0 +1,35 @@
+#pragma once
+
+#include "DisplayStateShm.h"
+
+#include <mutex>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Writer side of DisplayStateShm.h: creates the segment, and publishes a new state with the
+        // seqlock protocol readers expect. Only the published state is kept, an update identical to
+        // it leaves the generation alone. Thread safe.
+        class DisplayStatePublisher {
+        public:
+            DisplayStatePublisher();
+            ~DisplayStatePublisher();
+
+            DisplayStatePublisher(const DisplayStatePublisher&) = delete;
+            DisplayStatePublisher& operator=(const DisplayStatePublisher&) = delete;
+
+            bool Open();
+            //marks the state stale for readers still mapping it and removes the segment name
+            void Close();
+
+            //returns true when the state differed from the published one
+            bool Publish(const DisplayStateShm::DisplayState& state);
+
+        private:
+            std::mutex m_lock;
+            DisplayStateShm::Segment* m_segment;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
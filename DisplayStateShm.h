@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Layout of the read-only shared memory segment in which DisplaySettings publishes the
+        // current display state, for native processes that would otherwise poll it over JSON-RPC.
+        // The plugin is the only writer and updates the segment under a seqlock: Segment::sequence
+        // is odd while a write is in progress and advances by two per update, so Read() copies the
+        // state without a syscall or a lock and retries when it raced a write. The sequence also
+        // serves as the generation counter, compare it with Generation() to see whether anything
+        // changed since the last Read(). Fields are only ever added at the end of DisplayState, with
+        // VERSION bumped. Include this header, Map() once and Read() as often as needed.
+        namespace DisplayStateShm {
+
+            enum { VERSION = 2, MAX_PORTS = 8, MAX_DECODERS = 4, NAME_LENGTH = 16 };
+            static const uint32_t MAGIC = 0x53534453; // "SDSS"
+            static const char* const SegmentName = "/displaysettings.state";
+
+            struct Port {
+                char name[NAME_LENGTH];         // "HDMI0"
+                char resolution[NAME_LENGTH];   // "1080p60", empty when unknown or disconnected
+                uint8_t connected;
+                uint8_t reserved[7];
+            };
+
+            struct DisplayState {
+                uint32_t portCount;
+                uint32_t primaryHdmi;           // index into ports, MAX_PORTS when there is none
+                Port ports[MAX_PORTS];
+                uint8_t sinkKnown;              // the fields below describe the sink on the primary HDMI port
+                uint8_t reserved[7];
+                uint64_t edidHash;              // FNV-1a of the EDID, changes when the sink does
+                int32_t tvHdrCapabilities;      // dsHDRSTANDARD_* bits
+                int32_t tvResolutions;          // dsTV_RESOLUTION_* bits
+                int32_t settopHdrCapabilities;  // dsHDRSTANDARD_* bits of the first decoder, -1 when unknown
+                int32_t reserved2;
+                uint32_t decoderCount;
+                int32_t decoderHdrCapabilities[MAX_DECODERS];   // dsHDRSTANDARD_* bits per decoder, -1 when unknown
+                int32_t reserved3;
+            };
+
+            struct Segment {
+                uint32_t magic;
+                uint16_t version;
+                uint16_t stateSize;             // sizeof(DisplayState) of the writer
+                std::atomic<uint32_t> sequence;
+                uint32_t alive;                 // cleared when the plugin stops, the state is then stale
+                DisplayState state;
+            };
+
+            static_assert(ATOMIC_INT_LOCK_FREE == 2, "the seqlock needs a lock free 32 bit atomic");
+
+            //nullptr when the plugin has not created the segment (yet)
+            inline const Segment* Map()
+            {
+                int fd = shm_open(SegmentName, O_RDONLY, 0);
+                if (fd < 0)
+                    return nullptr;
+                void* address = mmap(nullptr, sizeof(Segment), PROT_READ, MAP_SHARED, fd, 0);
+                close(fd);
+                if (address == MAP_FAILED)
+                    return nullptr;
+                const Segment* segment = static_cast<const Segment*>(address);
+                if (segment->magic != MAGIC || segment->version != VERSION || segment->stateSize < sizeof(DisplayState))
+                {
+                    munmap(address, sizeof(Segment));
+                    return nullptr;
+                }
+                return segment;
+            }
+            inline void Unmap(const Segment* segment)
+            {
+                if (segment != nullptr)
+                    munmap(const_cast<Segment*>(segment), sizeof(Segment));
+            }
+
+            inline uint32_t Generation(const Segment* segment)
+            {
+                return segment->sequence.load(std::memory_order_acquire);
+            }
+
+            //a consistent copy of the state and the generation it belongs to; false while the plugin is stopped
+            //or when a write kept overlapping after maxRetries attempts
+            inline bool Read(const Segment* segment, DisplayState& state, uint32_t& generation, unsigned maxRetries = 1000)
+            {
+                for (unsigned attempt = 0; attempt < maxRetries; attempt++)
+                {
+                    const uint32_t before = segment->sequence.load(std::memory_order_acquire);
+                    if (before & 1)
+                        continue;
+                    memcpy(&state, const_cast<const DisplayState*>(&segment->state), sizeof(state));
+                    const bool alive = (segment->alive != 0);
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (segment->sequence.load(std::memory_order_relaxed) == before)
+                    {
+                        generation = before;
+                        return alive;
+                    }
+                }
+                return false;
+            }
+
+        } // namespace DisplayStateShm
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Fixed capacity list with inline storage, for the short bounded lists the handlers build
+        // (ports, resolutions, audio modes). Up to CAPACITY items it never touches the heap itself, and
+        // with short names the std::string elements stay within their small string buffer, so building
+        // a response list costs no allocations. A platform that reports more items than that does not
+        // lose them: the list moves to heap storage and spilled() says so, for the caller to log. It
+        // offers the subset of std::vector used by the handlers.
+        template<typename T, size_t CAPACITY>
+        class FixedList {
+        public:
+            typedef T value_type;
+            typedef const T* const_iterator;
+            typedef T* iterator;
+
+            FixedList()
+                : m_items()
+                , m_size(0)
+                , m_spill()
+            {
+            }
+
+            void emplace_back(const T& item)
+            {
+                if (m_size < CAPACITY)
+                {
+                    m_items[m_size] = item;
+                }
+                else
+                {
+                    if (m_spill.empty())
+                    {
+                        m_spill.reserve(2 * CAPACITY);
+                        m_spill.assign(m_items.begin(), m_items.end());
+                    }
+                    m_spill.push_back(item);
+                }
+                m_size++;
+            }
+            void push_back(const T& item)
+            {
+                emplace_back(item);
+            }
+            void clear()
+            {
+                m_size = 0;
+                m_spill.clear();
+            }
+
+            size_t size() const { return m_size; }
+            bool empty() const { return m_size == 0; }
+            static size_t capacity() { return CAPACITY; }
+            //more items than CAPACITY, they are on the heap
+            bool spilled() const { return m_size > CAPACITY; }
+
+            T& at(size_t index) { return index < m_size ? data()[index] : m_items.at(CAPACITY); }
+            const T& at(size_t index) const { return index < m_size ? data()[index] : m_items.at(CAPACITY); }
+            T& operator[](size_t index) { return data()[index]; }
+            const T& operator[](size_t index) const { return data()[index]; }
+
+            iterator begin() { return data(); }
+            iterator end() { return data() + m_size; }
+            const_iterator begin() const { return data(); }
+            const_iterator end() const { return data() + m_size; }
+
+        private:
+            T* data() { return spilled() ? m_spill.data() : m_items.data(); }
+            const T* data() const { return spilled() ? m_spill.data() : m_items.data(); }
+
+            std::array<T, CAPACITY> m_items;
+            size_t m_size;
+            std::vector<T> m_spill;     //all the items once there are more than CAPACITY
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
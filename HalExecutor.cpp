@@ -0,0 +1,286 @@
+#include "HalExecutor.h"
+
+#include <dlfcn.h>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        //std::chrono takes it by reference
+        const uint32_t HalExecutor::STOP_GRACE_MS;
+
+        HalExecutor::HalExecutor(uint32_t workers, uint32_t queueDepth, uint32_t tripThreshold, uint32_t cooldownMs)
+            : m_workers(workers)
+            , m_queueDepth(queueDepth)
+            , m_tripThreshold(tripThreshold)
+            , m_cooldown(cooldownMs)
+            , m_shared()
+            , m_threads()
+            , m_started(false)
+            , m_state(CLOSED)
+            , m_probeInFlight(false)
+            , m_consecutiveTimeouts(0)
+            , m_openedAt()
+            , m_calls(0)
+            , m_timeouts(0)
+            , m_rejected(0)
+        {
+        }
+        HalExecutor::~HalExecutor()
+        {
+            Stop();
+        }
+        void HalExecutor::Start()
+        {
+            if (m_started)
+                return;
+            m_shared = std::make_shared<Shared>();
+            m_shared->busy = 0;
+            m_shared->running = m_workers;
+            m_shared->stopping = false;
+            for (uint32_t i = 0; i < m_workers; i++)
+                m_threads.emplace_back(&HalExecutor::Worker, m_shared);
+            m_started = true;
+        }
+        void HalExecutor::Stop()
+        {
+            if (!m_started)
+                return;
+            bool returned = false;
+            {
+                std::unique_lock<std::mutex> lock(m_shared->lock);
+                m_shared->stopping = true;
+                m_shared->queue.clear();
+                m_shared->wakeWorker.notify_all();
+                m_shared->jobDone.notify_all();
+                //a worker blocked in the HAL must not block Stop() for longer than this
+                returned = m_shared->jobDone.wait_for(lock, std::chrono::milliseconds(STOP_GRACE_MS), [&]() {
+                    return m_shared->running == 0;
+                });
+            }
+            if (!returned)
+                PinLibrary();
+            for (std::thread& thread : m_threads)
+            {
+                if (returned)
+                    thread.join();
+                else
+                    thread.detach();
+            }
+            m_threads.clear();
+            m_shared.reset();
+            m_started = false;
+        }
+        HalExecutor::Result HalExecutor::Run(const std::function<void()>& job, uint32_t deadlineMs, std::exception_ptr& error)
+        {
+            error = nullptr;
+            std::shared_ptr<Shared> shared = m_shared;
+            if (!shared)
+                return STOPPED;
+            bool probe = false;
+            if (!Admit(probe))
+            {
+                m_rejected++;
+                return CIRCUIT_OPEN;
+            }
+            m_calls++;
+
+            std::shared_ptr<Job> entry = std::make_shared<Job>();
+            entry->work = job;
+            entry->done = false;
+
+            std::unique_lock<std::mutex> lock(shared->lock);
+            if (shared->stopping)
+            {
+                lock.unlock();
+                Abandon(probe);
+                return STOPPED;
+            }
+            if (shared->queue.size() >= m_queueDepth)
+            {
+                lock.unlock();
+                m_rejected++;
+                Abandon(probe);
+                return QUEUE_FULL;
+            }
+            shared->queue.push_back(entry);
+            shared->wakeWorker.notify_one();
+
+            bool finished = shared->jobDone.wait_for(lock, std::chrono::milliseconds(deadlineMs), [&]() {
+                return entry->done || shared->stopping;
+            });
+            if (shared->stopping && !entry->done)
+            {
+                lock.unlock();
+                Abandon(probe);
+                return STOPPED;
+            }
+            if (!finished)
+            {
+                //drop it if no worker picked it up yet, it is of no use to anyone anymore
+                for (auto it = shared->queue.begin(); it != shared->queue.end(); ++it)
+                {
+                    if (*it == entry)
+                    {
+                        shared->queue.erase(it);
+                        break;
+                    }
+                }
+                lock.unlock();
+                Record(true, probe);
+                return TIMEOUT;
+            }
+            error = entry->error;
+            lock.unlock();
+            Record(false, probe);
+            return SUCCESS;
+        }
+        HalExecutor::Stats HalExecutor::GetStats() const
+        {
+            Stats stats;
+            {
+                std::lock_guard<std::mutex> guard(m_breakerLock);
+                stats.state = m_state;
+                stats.consecutiveTimeouts = m_consecutiveTimeouts;
+            }
+            stats.calls = m_calls;
+            stats.timeouts = m_timeouts;
+            stats.rejected = m_rejected;
+            stats.workers = m_workers;
+            stats.queued = 0;
+            stats.busyWorkers = 0;
+            std::shared_ptr<Shared> shared = m_shared;
+            if (shared)
+            {
+                std::lock_guard<std::mutex> guard(shared->lock);
+                stats.queued = (uint32_t)shared->queue.size();
+                stats.busyWorkers = shared->busy;
+            }
+            return stats;
+        }
+        const char* HalExecutor::ResultName(Result result)
+        {
+            switch (result)
+            {
+            case SUCCESS: return "success";
+            case TIMEOUT: return "timeout";
+            case CIRCUIT_OPEN: return "circuit open";
+            case QUEUE_FULL: return "queue full";
+            case STOPPED: return "stopped";
+            }
+            return "unknown";
+        }
+        const char* HalExecutor::StateName(BreakerState state)
+        {
+            switch (state)
+            {
+            case CLOSED: return "closed";
+            case OPEN: return "open";
+            case HALF_OPEN: return "halfOpen";
+            }
+            return "unknown";
+        }
+        void HalExecutor::Worker(std::shared_ptr<Shared> shared)
+        {
+            std::unique_lock<std::mutex> lock(shared->lock);
+            while (true)
+            {
+                shared->wakeWorker.wait(lock, [&]() { return shared->stopping || !shared->queue.empty(); });
+                if (shared->stopping)
+                {
+                    shared->running--;
+                    shared->jobDone.notify_all();
+                    return;
+                }
+                std::shared_ptr<Job> job = shared->queue.front();
+                shared->queue.pop_front();
+                shared->busy++;
+                lock.unlock();
+
+                std::exception_ptr error;
+                try
+                {
+                    job->work();
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+
+                lock.lock();
+                job->error = error;
+                job->done = true;
+                shared->busy--;
+                shared->jobDone.notify_all();
+            }
+        }
+        void HalExecutor::PinLibrary()
+        {
+            //never dlclose()d: the code a detached worker returns into stays mapped for the life of the process
+            Dl_info info;
+            if (dladdr(reinterpret_cast<void*>(&HalExecutor::Worker), &info) != 0 && info.dli_fname != nullptr)
+                dlopen(info.dli_fname, RTLD_NOW | RTLD_NODELETE);
+        }
+        bool HalExecutor::Admit(bool& probe)
+        {
+            std::lock_guard<std::mutex> guard(m_breakerLock);
+            probe = false;
+            switch (m_state)
+            {
+            case CLOSED:
+                return true;
+            case OPEN:
+                if (std::chrono::steady_clock::now() - m_openedAt < m_cooldown)
+                    return false;
+                m_state = HALF_OPEN;
+                m_probeInFlight = true;
+                probe = true;
+                return true;
+            case HALF_OPEN:
+                if (m_probeInFlight)
+                    return false;
+                m_probeInFlight = true;
+                probe = true;
+                return true;
+            }
+            return false;
+        }
+        void HalExecutor::Record(bool timedOut, bool probe)
+        {
+            std::lock_guard<std::mutex> guard(m_breakerLock);
+            if (timedOut)
+            {
+                m_timeouts++;
+                m_consecutiveTimeouts++;
+            }
+            if (probe)
+            {
+                m_probeInFlight = false;
+                m_state = timedOut ? OPEN : CLOSED;
+                if (timedOut)
+                    m_openedAt = std::chrono::steady_clock::now();
+                else
+                    m_consecutiveTimeouts = 0;
+            }
+            else if (m_state == CLOSED)
+            {
+                //calls admitted before a trip that end after it leave the breaker to the probe
+                if (!timedOut)
+                    m_consecutiveTimeouts = 0;
+                else if (m_consecutiveTimeouts >= m_tripThreshold)
+                {
+                    m_state = OPEN;
+                    m_openedAt = std::chrono::steady_clock::now();
+                }
+            }
+        }
+        void HalExecutor::Abandon(bool probe)
+        {
+            if (!probe)
+                return;
+            std::lock_guard<std::mutex> guard(m_breakerLock);
+            m_probeInFlight = false;
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Runs blocking HAL/IARM calls on a small fixed pool of worker threads so the calling
+        // JSON-RPC thread never waits longer than the per-call deadline.
+        // A call that misses its deadline keeps its worker busy until the HAL returns, which is
+        // why the pool and its queue are bounded: a wedged dsMgr can tie up at most the pool,
+        // never the Thunder worker threads.
+        // After a number of consecutive timeouts the circuit breaker opens and calls fail fast
+        // until the cooldown expires; the next call is then let through as a probe (half open)
+        // and its outcome alone decides whether the breaker closes again. A call admitted before
+        // the trip that completes late does not close it.
+        // Stop() joins the workers when they all return within STOP_GRACE_MS. One still stuck in
+        // the HAL is left running, detached, and the library is pinned in memory so that it can
+        // return into code that is still mapped after the plugin is unloaded.
+        class HalExecutor {
+        public:
+            enum Result {
+                SUCCESS = 0,
+                TIMEOUT,
+                CIRCUIT_OPEN,
+                QUEUE_FULL,
+                STOPPED
+            };
+
+            enum BreakerState {
+                CLOSED = 0,
+                OPEN,
+                HALF_OPEN
+            };
+
+            struct Stats {
+                BreakerState state;
+                uint32_t consecutiveTimeouts;
+                uint64_t calls;
+                uint64_t timeouts;
+                uint64_t rejected;
+                uint32_t queued;
+                uint32_t busyWorkers;
+                uint32_t workers;
+            };
+
+            static const uint32_t STOP_GRACE_MS = 1000;
+
+            HalExecutor(uint32_t workers, uint32_t queueDepth, uint32_t tripThreshold, uint32_t cooldownMs);
+            ~HalExecutor();
+
+            HalExecutor(const HalExecutor&) = delete;
+            HalExecutor& operator=(const HalExecutor&) = delete;
+
+            void Start();
+            void Stop();
+
+            // Runs job on a worker and waits at most deadlineMs for it. When SUCCESS is returned
+            // the job has completed and error holds whatever it threw (or null).
+            Result Run(const std::function<void()>& job, uint32_t deadlineMs, std::exception_ptr& error);
+
+            Stats GetStats() const;
+
+            static const char* ResultName(Result result);
+            static const char* StateName(BreakerState state);
+
+        private:
+            struct Job {
+                std::function<void()> work;
+                std::exception_ptr error;
+                bool done;
+            };
+
+            // Shared with the workers so that a worker stuck in the HAL can still finish safely
+            // after the executor itself has been stopped.
+            struct Shared {
+                std::mutex lock;
+                std::condition_variable wakeWorker;
+                std::condition_variable jobDone;
+                std::deque<std::shared_ptr<Job>> queue;
+                uint32_t busy;
+                uint32_t running;
+                bool stopping;
+            };
+
+            static void Worker(std::shared_ptr<Shared> shared);
+            static void PinLibrary();
+
+            //probe is set when the call is the one half open probe
+            bool Admit(bool& probe);
+            void Record(bool timedOut, bool probe);
+            //a probe that never reached the HAL, the breaker may admit another one
+            void Abandon(bool probe);
+
+            const uint32_t m_workers;
+            const uint32_t m_queueDepth;
+            const uint32_t m_tripThreshold;
+            const std::chrono::milliseconds m_cooldown;
+
+            std::shared_ptr<Shared> m_shared;
+            std::vector<std::thread> m_threads;
+            bool m_started;
+
+            mutable std::mutex m_breakerLock;
+            BreakerState m_state;
+            bool m_probeInFlight;
+            uint32_t m_consecutiveTimeouts;
+            std::chrono::steady_clock::time_point m_openedAt;
+
+            std::atomic<uint64_t> m_calls;
+            std::atomic<uint64_t> m_timeouts;
+            std::atomic<uint64_t> m_rejected;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Module.h"
+
+namespace WPEFramework {
+
+    namespace Exchange {
+
+        // Typed COM-RPC face of the DisplaySettings plugin, for other plugins that would otherwise go
+        // through JSON-RPC. It mirrors the JSON-RPC methods at the newest API level and answers from
+        // the same caches; capabilities are returned as the dsHDRSTANDARD_* and dsTV_RESOLUTION_*
+        // bits (see CompactSchema.h for the names). Methods return Core::ERROR_NONE on success,
+        // ERROR_BAD_REQUEST for an unknown port or decoder and ERROR_GENERAL when the HAL failed.
+        // Obtain it with QueryInterface<Exchange::IDisplaySettings>() on the plugin.
+        struct EXTERNAL IDisplaySettings : virtual public Core::IUnknown {
+            //not assigned in ThunderInterfaces' Ids.h, kept clear of its ranges until the interface moves there
+            enum { ID = RPC::ID_EXTERNAL_INTERFACE_OFFSET + 0x7D50 };
+
+            // The JSON-RPC events as calls, duplicates suppressed like the JSON-RPC events. Called on the thread
+            // that saw the change, keep them short.
+            struct EXTERNAL INotification : virtual public Core::IUnknown {
+                enum { ID = IDisplaySettings::ID + 1 };
+
+                virtual void ResolutionPreChange() {}
+                virtual void ResolutionChanged(const string& /* videoDisplay */, const string& /* resolution */, const uint32_t /* width */, const uint32_t /* height */) {}
+                virtual void ZoomSettingUpdated(const string& /* zoomSetting */) {}
+                virtual void ActiveInputChanged(const bool /* activeInput */) {}
+                virtual void ConnectedVideoDisplaysUpdated(RPC::IStringIterator* /* connectedVideoDisplays */) {}
+                virtual void HdcpStatusChanged(const string& /* videoDisplay */, const string& /* hdcpStatus */) {}
+                virtual void HdmiInputHotPlug(const uint32_t /* port */, const bool /* connected */) {}
+                // A different sink came up on videoDisplay
+                virtual void DisplayCapabilitiesChanged(const string& /* videoDisplay */, const uint32_t /* hdrStandards */, const uint32_t /* tvResolutions */) {}
+                virtual void ResolutionChangeComplete(const uint32_t /* jobId */, const string& /* videoDisplay */, const string& /* resolution */, const bool /* success */) {}
+                virtual void ResumeComplete(const bool /* sinkChanged */, const uint32_t /* changes */) {}
+            };
+
+            virtual uint32_t Register(INotification* sink) = 0;
+            virtual uint32_t Unregister(INotification* sink) = 0;
+            // setNotificationFilter for a registered sink: force delivers a state event even when unchanged,
+            // disabledEvents (JSON-RPC event names) replaces the events not delivered to it; ERROR_UNKNOWN_KEY
+            // when the sink is not registered
+            virtual uint32_t SetNotificationFilter(INotification* sink, const bool force, RPC::IStringIterator* disabledEvents /* @in */) = 0;
+
+            virtual uint32_t ConnectedVideoDisplays(RPC::IStringIterator*& videoDisplays /* @out */) = 0;
+            virtual uint32_t SupportedResolutions(const string& videoDisplay, RPC::IStringIterator*& resolutions /* @out */) = 0;
+            virtual uint32_t CurrentResolution(const string& videoDisplay, string& resolution /* @out */) = 0;
+            // Applied like setCurrentResolution: a request replaced by a newer one for the port returns
+            // ERROR_NONE without being applied
+            virtual uint32_t SetCurrentResolution(const string& videoDisplay, const string& resolution) = 0;
+            virtual uint32_t ZoomSetting(const uint8_t videoDecoder, string& zoomSetting /* @out */) = 0;
+            virtual uint32_t SetZoomSetting(const uint8_t videoDecoder, const string& zoomSetting) = 0;
+            // An empty audioPort means what a missing videoDisplay means to getSoundMode and setSoundMode
+            virtual uint32_t SoundMode(const string& audioPort, string& soundMode /* @out */) = 0;
+            virtual uint32_t SetSoundMode(const string& audioPort, const string& soundMode) = 0;
+            virtual uint32_t SupportedAudioModes(const string& audioPort, RPC::IStringIterator*& audioModes /* @out */) = 0;
+            virtual uint32_t ActiveInput(const string& videoDisplay, bool& activeInput /* @out */) = 0;
+            virtual uint32_t TvHDRSupport(const string& videoDisplay, uint32_t& hdrStandards /* @out */) = 0;
+            virtual uint32_t SettopHDRSupport(const uint8_t videoDecoder, uint32_t& hdrStandards /* @out */) = 0;
+            virtual uint32_t SupportedTvResolutions(const string& videoDisplay, uint32_t& tvResolutions /* @out */) = 0;
+            // length is the size of data on the way in and the EDID's size on the way out; ERROR_INVALID_INPUT_LENGTH
+            // when it does not fit, with length set to what is needed
+            virtual uint32_t EDID(const string& videoDisplay, uint16_t& length /* @inout */, uint8_t data[] /* @out @length:length */) = 0;
+            virtual uint32_t VideoPortStatusInStandby(const string& videoPort, bool& enabled /* @out */) = 0;
+            virtual uint32_t SetVideoPortStatusInStandby(const string& videoPort, const bool enabled) = 0;
+        };
+
+    } // namespace Exchange
+} // namespace WPEFramework
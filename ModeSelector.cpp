@@ -0,0 +1,81 @@
+#include "ModeSelector.h"
+
+#include "dsTypes.h"
+
+#include <cstdlib>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        bool ModeSelector::Parse(const std::string& name, Mode& mode)
+        {
+            const char* text = name.c_str();
+            char* end = nullptr;
+            unsigned long height = strtoul(text, &end, 10);
+            if (end == text || height == 0 || (*end != 'p' && *end != 'i'))
+                return false;
+            mode.height = (uint32_t)height;
+            mode.progressive = (*end == 'p');
+            const char* rate = end + 1;
+            if (*rate == '\0')
+            {
+                mode.frameRate = (height == 576 || height == 288) ? 50 : 60;
+                return true;
+            }
+            unsigned long frameRate = strtoul(rate, &end, 10);
+            if (end == rate || *end != '\0' || frameRate == 0)
+                return false;
+            mode.frameRate = (uint32_t)frameRate;
+            return true;
+        }
+        int ModeSelector::TvResolutionBit(const Mode& mode)
+        {
+            switch (mode.height)
+            {
+            case 480: return mode.progressive ? dsTV_RESOLUTION_480p : dsTV_RESOLUTION_480i;
+            case 576: return mode.progressive ? dsTV_RESOLUTION_576p : dsTV_RESOLUTION_576i;
+            case 720: return mode.progressive ? dsTV_RESOLUTION_720p : 0;
+            case 1080: return mode.progressive ? dsTV_RESOLUTION_1080p : dsTV_RESOLUTION_1080i;
+            case 2160: return !mode.progressive ? 0 : (mode.frameRate <= 30 ? dsTV_RESOLUTION_2160p30 : dsTV_RESOLUTION_2160p60);
+            }
+            return 0;
+        }
+        size_t ModeSelector::Select(const std::string* names, size_t count, int tvResolutions, const Policy& policy, size_t& candidates)
+        {
+            size_t best = NONE;
+            Mode bestMode = Mode();
+            candidates = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                Mode mode;
+                if (!Parse(names[i], mode))
+                    continue;
+                if (mode.height > policy.maxHeight || (policy.progressiveOnly && !mode.progressive))
+                    continue;
+                if (tvResolutions != 0 && (TvResolutionBit(mode) & tvResolutions) == 0)
+                    continue;
+                candidates++;
+                if (best == NONE || Better(mode, bestMode, policy))
+                {
+                    best = i;
+                    bestMode = mode;
+                }
+            }
+            return best;
+        }
+        bool ModeSelector::Better(const Mode& a, const Mode& b, const Policy& policy)
+        {
+            if (a.height != b.height)
+                return a.height > b.height;
+            if (a.progressive != b.progressive)
+                return a.progressive;
+            uint32_t distanceA = (a.frameRate > policy.frameRate) ? a.frameRate - policy.frameRate : policy.frameRate - a.frameRate;
+            uint32_t distanceB = (b.frameRate > policy.frameRate) ? b.frameRate - policy.frameRate : policy.frameRate - b.frameRate;
+            if (distanceA != distanceB)
+                return distanceA < distanceB;
+            return a.frameRate > b.frameRate;
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
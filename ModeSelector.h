@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Picks the output mode for a sink from what the settop supports and the TV's
+        // dsTV_RESOLUTION_* mask. Candidates above the policy's maxHeight, or interlaced ones when
+        // progressiveOnly is set, are dropped; the rest are ranked by height, then progressive over
+        // interlaced, then closeness to the preferred frame rate (higher wins a tie). A TV mask of
+        // 0 means the sink did not report any and only the settop list is used.
+        // Pure computation over names already in memory, no HAL calls.
+        class ModeSelector {
+        public:
+            struct Policy {
+                uint32_t maxHeight = 2160;
+                uint32_t frameRate = 60;
+                bool progressiveOnly = false;
+            };
+
+            struct Mode {
+                uint32_t height;
+                uint32_t frameRate;
+                bool progressive;
+            };
+
+            static const size_t NONE = (size_t)-1;
+
+            //"1080p60", "720p", "2160p30", "480i", ...; without a rate 576/288 line modes are 50Hz, others 60Hz
+            static bool Parse(const std::string& name, Mode& mode);
+            //the dsTV_RESOLUTION_* bit a mode needs from the TV, 0 when there is none for it
+            static int TvResolutionBit(const Mode& mode);
+            //index of the best of count names, NONE when no candidate is left; candidates is how many qualified
+            static size_t Select(const std::string* names, size_t count, int tvResolutions, const Policy& policy, size_t& candidates);
+
+        private:
+            static bool Better(const Mode& a, const Mode& b, const Policy& policy);
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
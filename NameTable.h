@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Interns the names the HAL hands out (resolutions, audio modes, setting values) into small
+        // dense ids, so caches hold ids, dedup is a bitset test and the string is only looked up
+        // again when a response is written. Names are only ever added: an id keeps its name, and the
+        // string it maps to never moves, for the life of the table. Intern() and Find() take a lock,
+        // Name() does not. Past CAPACITY names Intern() returns NONE and the caller keeps the string.
+        template<size_t CAPACITY>
+        class NameTable {
+        public:
+            typedef uint16_t Id;
+            typedef std::bitset<CAPACITY> Set;
+            static const Id NONE = 0xffff;
+
+            static_assert(CAPACITY < NONE, "ids are 16 bit");
+
+            NameTable()
+                : m_lock()
+                , m_names()
+                , m_size(0)
+                , m_ids()
+            {
+            }
+
+            NameTable(const NameTable&) = delete;
+            NameTable& operator=(const NameTable&) = delete;
+
+            Id Intern(const std::string& name)
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                auto it = m_ids.find(name);
+                if (it != m_ids.end())
+                    return it->second;
+                const size_t size = m_size.load(std::memory_order_relaxed);
+                if (size >= CAPACITY)
+                    return NONE;
+                m_names[size] = name;
+                m_ids.emplace(name, (Id)size);
+                //the name is in place before its id becomes visible to Name()
+                m_size.store(size + 1, std::memory_order_release);
+                return (Id)size;
+            }
+            Id Find(const std::string& name) const
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                auto it = m_ids.find(name);
+                return (it == m_ids.end()) ? NONE : it->second;
+            }
+            //empty for NONE
+            const std::string& Name(Id id) const
+            {
+                static const std::string none;
+                return (id < m_size.load(std::memory_order_acquire)) ? m_names[id] : none;
+            }
+            size_t Size() const { return m_size.load(std::memory_order_acquire); }
+
+        private:
+            mutable std::mutex m_lock;
+            std::array<std::string, CAPACITY> m_names;
+            std::atomic<size_t> m_size;
+            std::unordered_map<std::string, Id> m_ids;
+        };
+
+        //fill() and the like take NONE by reference
+        template<size_t CAPACITY>
+        const typename NameTable<CAPACITY>::Id NameTable<CAPACITY>::NONE;
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Dense index over the platform's video output ports and video decoders. It is filled once
+        // in Initialize, before any IARM handler is registered, and is read only afterwards, so
+        // handlers use it without locking. A port name is resolved to its slot once at the
+        // parameter boundary; per port state lives in arrays of MAX_PORTS entries indexed by slot.
+        class PortTable {
+        public:
+            enum { MAX_PORTS = 8, MAX_DECODERS = 4 };
+            static const size_t NONE = (size_t)-1;
+
+            PortTable()
+                : m_ports()
+                , m_decoders()
+                , m_portCount(0)
+                , m_decoderCount(0)
+                , m_primaryHdmi(NONE)
+                , m_index()
+            {
+            }
+
+            void Clear()
+            {
+                m_portCount = 0;
+                m_decoderCount = 0;
+                m_primaryHdmi = NONE;
+                m_index.clear();
+            }
+            bool AddVideoPort(const std::string& name)
+            {
+                if (m_portCount >= MAX_PORTS || m_index.count(name))
+                    return false;
+                if (m_primaryHdmi == NONE && name.compare(0, 4, "HDMI") == 0)
+                    m_primaryHdmi = m_portCount;
+                m_index[name] = m_portCount;
+                m_ports[m_portCount++] = name;
+                return true;
+            }
+            void SetDecoderCount(size_t count)
+            {
+                m_decoderCount = (count < MAX_DECODERS) ? count : (size_t)MAX_DECODERS;
+                for (size_t i = 0; i < m_decoderCount; i++)
+                    m_decoders[i] = "decoder" + std::to_string(i);
+            }
+
+            size_t VideoPortCount() const { return m_portCount; }
+            const std::string& VideoPortName(size_t index) const { return m_ports.at(index); }
+            size_t VideoPortIndex(const std::string& name) const
+            {
+                auto it = m_index.find(name);
+                return (it == m_index.end()) ? NONE : it->second;
+            }
+            bool IsHdmi(size_t index) const
+            {
+                return index < m_portCount && m_ports[index].compare(0, 4, "HDMI") == 0;
+            }
+
+            //first HDMI output; "HDMI0" when the HAL reported none, which is what the handlers assumed before
+            size_t PrimaryHdmi() const { return m_primaryHdmi; }
+            const std::string& PrimaryHdmiName() const
+            {
+                static const std::string fallback("HDMI0");
+                return (m_primaryHdmi == NONE) ? fallback : m_ports[m_primaryHdmi];
+            }
+            //the port a request addresses when it names an HDMI output, otherwise the primary one
+            const std::string& HdmiPortName(const std::string& requested) const
+            {
+                size_t index = VideoPortIndex(requested);
+                return IsHdmi(index) ? m_ports[index] : PrimaryHdmiName();
+            }
+
+            //decoder slots default to one decoder so a failed HAL query keeps the old getVideoDevices().at(0)
+            size_t DecoderCount() const { return m_decoderCount ? m_decoderCount : 1; }
+            const std::string& DecoderName(size_t index) const
+            {
+                static const std::string first("decoder0");
+                return (index < m_decoderCount) ? m_decoders[index] : first;
+            }
+
+        private:
+            std::array<std::string, MAX_PORTS> m_ports;
+            std::array<std::string, MAX_DECODERS> m_decoders;
+            size_t m_portCount;
+            size_t m_decoderCount;
+            size_t m_primaryHdmi;
+            std::unordered_map<std::string, size_t> m_index;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
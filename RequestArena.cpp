@@ -0,0 +1,68 @@
+#include "RequestArena.h"
+
+#include <new>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        namespace {
+
+            const size_t ALIGNMENT = alignof(std::max_align_t);
+
+            struct Arena {
+                alignas(std::max_align_t) uint8_t bytes[RequestArena::SIZE];
+                size_t used;
+                uint32_t scopes;
+                uint64_t spills;
+            };
+
+            Arena& local()
+            {
+                static thread_local Arena arena;
+                return arena;
+            }
+
+        } // namespace
+
+        RequestArena::Scope::Scope()
+            : m_mark(local().used)
+        {
+            local().scopes++;
+        }
+        RequestArena::Scope::~Scope()
+        {
+            Arena& arena = local();
+            arena.used = m_mark;
+            arena.scopes--;
+        }
+        void* RequestArena::Allocate(size_t size)
+        {
+            Arena& arena = local();
+            const size_t rounded = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+            if (arena.scopes == 0)
+                return ::operator new(size);
+            if (rounded > RequestArena::SIZE - arena.used)
+            {
+                arena.spills++;
+                return ::operator new(size);
+            }
+            void* memory = arena.bytes + arena.used;
+            arena.used += rounded;
+            return memory;
+        }
+        void RequestArena::Free(void* memory)
+        {
+            const Arena& arena = local();
+            const uint8_t* address = static_cast<const uint8_t*>(memory);
+            if (address >= arena.bytes && address < arena.bytes + RequestArena::SIZE)
+                return;
+            ::operator delete(memory);
+        }
+        uint64_t RequestArena::Spills()
+        {
+            return local().spills;
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
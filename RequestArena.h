@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Per thread bump allocator for what a JSON-RPC handler builds and drops again. A Scope opened
+        // at the start of the handler (MYTRACEMETHOD does) hands out memory from a fixed buffer of the
+        // calling thread and takes all of it back when the handler returns, so the scratch buffers of a
+        // request never reach the heap and do not fragment it. Scopes nest. Past the buffer, or with no
+        // Scope open, allocations go to the heap as usual; Spills() counts them on the calling thread.
+        // Containers put in the arena through ArenaAllocator must not outlive the Scope they were
+        // filled in, nor leave the thread.
+        class RequestArena {
+        public:
+            static const size_t SIZE = 4096;
+
+            class Scope {
+            public:
+                Scope();
+                ~Scope();
+
+                Scope(const Scope&) = delete;
+                Scope& operator=(const Scope&) = delete;
+
+            private:
+                size_t m_mark;
+            };
+
+            static void* Allocate(size_t size);
+            //arena memory is taken back by its Scope, only heap memory is freed here
+            static void Free(void* memory);
+            static uint64_t Spills();
+        };
+
+        // Standard allocator over the RequestArena of the calling thread, for a handler's own scratch buffers
+        template<typename T>
+        class ArenaAllocator {
+        public:
+            typedef T value_type;
+
+            ArenaAllocator() {}
+            template<typename U>
+            ArenaAllocator(const ArenaAllocator<U>&) {}
+
+            T* allocate(size_t count) { return static_cast<T*>(RequestArena::Allocate(count * sizeof(T))); }
+            void deallocate(T* memory, size_t) { RequestArena::Free(memory); }
+        };
+        template<typename T, typename U>
+        bool operator==(const ArenaAllocator<T>&, const ArenaAllocator<U>&) { return true; }
+        template<typename T, typename U>
+        bool operator!=(const ArenaAllocator<T>&, const ArenaAllocator<U>&) { return false; }
+
+    } // namespace Plugin
+} // namespace WPEFramework
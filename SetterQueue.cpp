@@ -0,0 +1,115 @@
+#include "SetterQueue.h"
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        SetterQueue::SetterQueue()
+            : m_lock()
+            , m_changed()
+            , m_slots()
+            , m_counters()
+            , m_limit(0)
+            , m_buckets()
+        {
+        }
+        void SetterQueue::SetLimit(uint32_t perSecond)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_limit = perSecond;
+            //buckets start over with the new limit
+            m_buckets.clear();
+        }
+        uint32_t SetterQueue::Limit()
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            return m_limit;
+        }
+        bool SetterQueue::Admit(const std::string& setting, const std::string& client)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            if (m_limit == 0)
+                return true;
+
+            //a full bucket allows a burst of one second's worth of requests
+            const double rate = m_limit;
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            auto it = m_buckets.find(client);
+            if (it == m_buckets.end())
+            {
+                if (m_buckets.size() >= MAX_BUCKETS)
+                {
+                    //the longest quiet client; once quiet for a second its bucket is full, forgetting it changes nothing
+                    auto oldest = m_buckets.begin();
+                    for (auto candidate = m_buckets.begin(); candidate != m_buckets.end(); ++candidate)
+                    {
+                        if (candidate->second.refilled < oldest->second.refilled)
+                            oldest = candidate;
+                    }
+                    m_buckets.erase(oldest);
+                }
+                it = m_buckets.emplace(client, Bucket{ rate, now }).first;
+            }
+            Bucket& bucket = it->second;
+            bucket.tokens += std::chrono::duration<double>(now - bucket.refilled).count() * rate;
+            if (bucket.tokens > rate)
+                bucket.tokens = rate;
+            bucket.refilled = now;
+            if (bucket.tokens < 1.0)
+            {
+                m_counters[setting].rejected++;
+                return false;
+            }
+            bucket.tokens -= 1.0;
+            return true;
+        }
+        SetterQueue::Outcome SetterQueue::Apply(const std::string& setting, const std::string& port, const std::function<void()>& apply)
+        {
+            const std::string key = setting + "/" + port;
+            std::unique_lock<std::mutex> lock(m_lock);
+            Slot& slot = m_slots[key];
+            const uint64_t ticket = ++slot.lastTicket;
+            //a request already waiting is older than this one even when the slot just went idle and
+            //it has not woken up yet, running ahead of it would let it apply the older value after us
+            if (slot.busy || slot.waiting != 0)
+            {
+                //take the waiting place, whoever held it is replaced and leaves
+                slot.waiting = ticket;
+                m_changed.notify_all();
+                m_changed.wait(lock, [&slot, ticket]() { return !slot.busy || slot.waiting != ticket; });
+                if (slot.waiting != ticket)
+                {
+                    m_counters[setting].coalesced++;
+                    return COALESCED;
+                }
+                slot.waiting = 0;
+            }
+            slot.busy = true;
+            lock.unlock();
+
+            //slot stays valid, entries are never erased from m_slots
+            struct Release {
+                SetterQueue& queue;
+                Slot& slot;
+                ~Release()
+                {
+                    std::lock_guard<std::mutex> guard(queue.m_lock);
+                    slot.busy = false;
+                    queue.m_changed.notify_all();
+                }
+            } release{ *this, slot };
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_counters[setting].applied++;
+            }
+            apply();
+            return APPLIED;
+        }
+        std::map<std::string, SetterQueue::Counters> SetterQueue::GetCounters()
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            return m_counters;
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Admission control for the setters that make the HAL resync the TV or the audio path.
+        // Apply() runs one change at a time per setting and port; requests that arrive while a
+        // change is being applied wait, and each newer one replaces the one waiting before it, so
+        // only the latest is applied once the running change finished (last writer wins). The
+        // replaced callers return at once with COALESCED.
+        // Admit() enforces the optional rate limit, a token bucket per client (the JSON-RPC channel,
+        // not anything the caller says about itself) refilled at the configured requests per second.
+        // At most MAX_BUCKETS clients are tracked, a new one replaces the one least recently heard
+        // from. Thread safe.
+        class SetterQueue {
+        public:
+            enum Outcome { APPLIED = 0, COALESCED };
+
+            static const size_t MAX_BUCKETS = 64;
+
+            struct Counters {
+                uint64_t applied = 0;
+                uint64_t coalesced = 0;
+                uint64_t rejected = 0;
+            };
+
+            SetterQueue();
+
+            SetterQueue(const SetterQueue&) = delete;
+            SetterQueue& operator=(const SetterQueue&) = delete;
+
+            //requests per second every client may make, 0 for no limit
+            void SetLimit(uint32_t perSecond);
+            uint32_t Limit();
+            //false, counted as rejected for setting, when client is over its limit
+            bool Admit(const std::string& setting, const std::string& client);
+
+            //runs apply for setting on port unless a newer request replaced this one; exceptions from apply propagate
+            Outcome Apply(const std::string& setting, const std::string& port, const std::function<void()>& apply);
+
+            std::map<std::string, Counters> GetCounters();
+
+        private:
+            struct Slot {
+                bool busy = false;
+                uint64_t lastTicket = 0;
+                uint64_t waiting = 0;   //ticket of the request that runs next, 0 for none
+            };
+            struct Bucket {
+                double tokens;
+                std::chrono::steady_clock::time_point refilled;
+            };
+
+            std::mutex m_lock;
+            std::condition_variable m_changed;
+            std::map<std::string, Slot> m_slots;    //per setting and port
+            std::map<std::string, Counters> m_counters;
+            uint32_t m_limit;
+            std::map<std::string, Bucket> m_buckets;    //per client, at most MAX_BUCKETS
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
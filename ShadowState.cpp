@@ -0,0 +1,109 @@
+#include "ShadowState.h"
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        ShadowState::ShadowState()
+            : m_lock()
+            , m_keys()
+            , m_names()
+            , m_values()
+            , m_generations()
+            , m_stats()
+        {
+            for (int setting = 0; setting < SETTINGS; setting++)
+                m_values[setting].fill(Values::NONE);
+        }
+        bool ShadowState::Get(Setting setting, const std::string& key, std::string& value)
+        {
+            const Keys::Id id = m_keys.Find(key);
+            std::lock_guard<std::mutex> guard(m_lock);
+            if (id == Keys::NONE || m_values[setting][id] == Values::NONE)
+            {
+                m_stats.misses++;
+                return false;
+            }
+            m_stats.hits++;
+            value = m_names.Name(m_values[setting][id]);
+            return true;
+        }
+        void ShadowState::Set(Setting setting, const std::string& key, const std::string& value)
+        {
+            const Keys::Id id = m_keys.Intern(key);
+            const Values::Id valueId = m_names.Intern(value);
+            std::lock_guard<std::mutex> guard(m_lock);
+            //a value that could not be interned still replaces the old one, by dropping it
+            if (id != Keys::NONE)
+                m_values[setting][id] = valueId;
+            m_generations[setting]++;
+        }
+        void ShadowState::Invalidate(Setting setting)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_values[setting].fill(Values::NONE);
+            m_generations[setting]++;
+        }
+        void ShadowState::Clear()
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            for (int setting = 0; setting < SETTINGS; setting++)
+            {
+                m_values[setting].fill(Values::NONE);
+                m_generations[setting]++;
+            }
+        }
+        void ShadowState::Restore(Setting setting, const std::vector<std::pair<std::string, std::string>>& entries)
+        {
+            for (const auto& entry : entries)
+            {
+                const Keys::Id id = m_keys.Intern(entry.first);
+                const Values::Id valueId = m_names.Intern(entry.second);
+                std::lock_guard<std::mutex> guard(m_lock);
+                if (id != Keys::NONE && m_values[setting][id] == Values::NONE)
+                    m_values[setting][id] = valueId;
+            }
+        }
+        uint64_t ShadowState::Generation(Setting setting)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            return m_generations[setting];
+        }
+        bool ShadowState::Fill(Setting setting, const std::string& key, const std::string& value, uint64_t generation)
+        {
+            const Keys::Id id = m_keys.Intern(key);
+            const Values::Id valueId = m_names.Intern(value);
+            std::lock_guard<std::mutex> guard(m_lock);
+            if (m_generations[setting] != generation || id == Keys::NONE)
+                return false;
+            Values::Id& stored = m_values[setting][id];
+            if (stored == Values::NONE)
+            {
+                stored = valueId;
+                return false;
+            }
+            if (stored == valueId)
+                return false;
+            stored = valueId;
+            m_stats.corrections++;
+            return true;
+        }
+        std::vector<std::pair<std::string, std::string>> ShadowState::Entries(Setting setting)
+        {
+            std::vector<std::pair<std::string, std::string>> entries;
+            std::lock_guard<std::mutex> guard(m_lock);
+            for (size_t id = 0; id < m_keys.Size(); id++)
+            {
+                if (m_values[setting][id] != Values::NONE)
+                    entries.emplace_back(m_keys.Name((Keys::Id)id), m_names.Name(m_values[setting][id]));
+            }
+            return entries;
+        }
+        ShadowState::Stats ShadowState::GetStats()
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            return m_stats;
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
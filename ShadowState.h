@@ -0,0 +1,70 @@
+#pragma once
+
+#include "NameTable.h"
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Last known value of the live settings the getters report: the resolution per video port,
+        // the zoom (DFC) per decoder, the sound mode per requested port and the active input per
+        // video port. An entry is filled by the first getter that reads the HAL, then kept current by
+        // the dsMgr events and the plugin's own setters, and checked against the HAL periodically by
+        // the owner. Keys and values are interned, an entry is a pair of 16 bit ids; a key or value
+        // past the tables' capacity is simply not cached. Thread safe.
+        class ShadowState {
+        public:
+            enum Setting { RESOLUTION = 0, ZOOM = 1, SOUND_MODE = 2, ACTIVE_INPUT = 3, SETTINGS = 4 };
+            enum { MAX_KEYS = 32, MAX_VALUES = 128 };
+
+            struct Stats {
+                uint64_t hits;
+                uint64_t misses;
+                uint64_t corrections;   // reconciliation found the HAL disagreeing
+            };
+
+            ShadowState();
+
+            ShadowState(const ShadowState&) = delete;
+            ShadowState& operator=(const ShadowState&) = delete;
+
+            bool Get(Setting setting, const std::string& key, std::string& value);
+            //a value the plugin knows to be current: from an event or a successful setter
+            void Set(Setting setting, const std::string& key, const std::string& value);
+            void Invalidate(Setting setting);
+            void Clear();
+            //puts back entries saved with Entries() that are missing now, the ones present are newer and kept
+            void Restore(Setting setting, const std::vector<std::pair<std::string, std::string>>& entries);
+
+            //taken before a HAL read whose result is then stored with Fill
+            uint64_t Generation(Setting setting);
+            // Stores value unless the setting was Set or Invalidated after generation was taken, so a
+            // slow HAL read never replaces what an event stored meanwhile. Returns true, and counts a
+            // correction, when an entry that was already there had a different value.
+            bool Fill(Setting setting, const std::string& key, const std::string& value, uint64_t generation);
+
+            std::vector<std::pair<std::string, std::string>> Entries(Setting setting);
+            Stats GetStats();
+
+        private:
+            typedef NameTable<MAX_KEYS> Keys;
+            typedef NameTable<MAX_VALUES> Values;
+
+            std::mutex m_lock;
+            Keys m_keys;
+            Values m_names;
+            //value id per key id, Values::NONE when there is no entry
+            std::array<Values::Id, MAX_KEYS> m_values[SETTINGS];
+            uint64_t m_generations[SETTINGS];
+            Stats m_stats;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,132 @@
+#include "SinkCapabilityStore.h"
+
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        static_assert(sizeof(SinkCapabilityStore::Sink) == 32, "sink records are persisted, keep the layout fixed");
+
+        SinkCapabilityStore::SinkCapabilityStore()
+            : m_path()
+            , m_sinks()
+            , m_count(0)
+            , m_useCounter(0)
+        {
+        }
+        bool SinkCapabilityStore::Load(const std::string& path)
+        {
+            m_path = path;
+            m_count = 0;
+            m_useCounter = 0;
+            FILE* file = fopen(path.c_str(), "rb");
+            if (file == nullptr)
+                return false;
+            Header header;
+            bool valid = fread(&header, sizeof(header), 1, file) == 1 && header.magic == MAGIC && header.version == VERSION
+                && header.recordSize == sizeof(Sink) && header.count <= CAPACITY
+                && fread(m_sinks.data(), sizeof(Sink), header.count, file) == header.count;
+            fclose(file);
+            if (valid)
+            {
+                m_count = header.count;
+                m_useCounter = header.useCounter;
+            }
+            return valid;
+        }
+        bool SinkCapabilityStore::Lookup(uint64_t edidHash, Sink& sink)
+        {
+            for (size_t i = 0; i < m_count; i++)
+            {
+                if (m_sinks[i].edidHash == edidHash)
+                {
+                    //only bumped in memory, the order is persisted with the next Save
+                    m_sinks[i].lastUsed = ++m_useCounter;
+                    sink = m_sinks[i];
+                    return true;
+                }
+            }
+            return false;
+        }
+        void SinkCapabilityStore::Store(const Sink& sink)
+        {
+            size_t slot = m_count;
+            for (size_t i = 0; i < m_count; i++)
+            {
+                if (m_sinks[i].edidHash == sink.edidHash)
+                {
+                    slot = i;
+                    break;
+                }
+            }
+            if (slot == CAPACITY)
+            {
+                slot = 0;
+                for (size_t i = 1; i < m_count; i++)
+                {
+                    if (m_sinks[i].lastUsed < m_sinks[slot].lastUsed)
+                        slot = i;
+                }
+            }
+            else if (slot == m_count)
+            {
+                m_count++;
+            }
+            m_sinks[slot] = sink;
+            m_sinks[slot].lastUsed = ++m_useCounter;
+        }
+        SinkCapabilityStore::Contents SinkCapabilityStore::Copy() const
+        {
+            Contents contents;
+            contents.sinks = m_sinks;
+            contents.count = m_count;
+            contents.useCounter = m_useCounter;
+            return contents;
+        }
+        bool SinkCapabilityStore::Save(const std::string& path, const Contents& contents)
+        {
+            if (path.empty())
+                return false;
+            const std::string temporary = path + ".tmp";
+            FILE* file = fopen(temporary.c_str(), "wb");
+            if (file == nullptr)
+                return false;
+            Header header = { MAGIC, VERSION, (uint16_t)sizeof(Sink), (uint32_t)contents.count, 0, contents.useCounter };
+            //the records reach the disk before the rename can, a power cut leaves the old file or the new one
+            bool written = fwrite(&header, sizeof(header), 1, file) == 1
+                && fwrite(contents.sinks.data(), sizeof(Sink), contents.count, file) == contents.count
+                && fflush(file) == 0 && fsync(fileno(file)) == 0;
+            written = (fclose(file) == 0) && written;
+            if (!written)
+            {
+                remove(temporary.c_str());
+                return false;
+            }
+            if (rename(temporary.c_str(), path.c_str()) != 0)
+                return false;
+            //and the rename itself is only durable once the directory entry is
+            const size_t slash = path.rfind('/');
+            const std::string directory = (slash == std::string::npos) ? "." : (slash == 0) ? "/" : path.substr(0, slash);
+            const int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+            if (fd < 0)
+                return false;
+            const bool synced = fsync(fd) == 0;
+            close(fd);
+            return synced;
+        }
+        uint64_t SinkCapabilityStore::Hash(const std::vector<uint8_t>& edid)
+        {
+            uint64_t hash = 14695981039346656037ULL;
+            for (uint8_t byte : edid)
+            {
+                hash ^= byte;
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
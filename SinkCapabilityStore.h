@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Small persistent LRU of the capabilities derived for each TV/AVR we have seen, keyed by a
+        // 64 bit FNV-1a hash of its EDID. On hotplug the EDID is read once and, when the hash is
+        // known, the HDR, TV resolution and surround capabilities are served from here instead of
+        // being discovered again. The file is a fixed header plus CAPACITY records, rewritten
+        // through a temporary file that is synced before the rename(), so neither a crash nor a
+        // power cut leaves it half written.
+        // Not synchronized, the owner serializes access. Store() only updates the memory copy: the
+        // owner takes a Copy() under its lock and hands it to Save() after releasing it, so the
+        // write and the syncs never hold up the readers of the store.
+        class SinkCapabilityStore {
+        public:
+            static const uint32_t MAGIC = 0x53434453; // "SDCS"
+            static const uint16_t VERSION = 1;
+            enum { CAPACITY = 8 };
+
+            struct Sink {
+                uint64_t edidHash;
+                uint64_t lastUsed;      // store wide use counter, the lowest one is evicted
+                int32_t hdrCapabilities;    // dsHDRSTANDARD_* bits
+                int32_t tvResolutions;      // dsTV_RESOLUTION_* bits
+                int32_t surroundMode;       // dsSURROUNDMODE_* bits
+                int32_t reserved;
+            };
+
+            //what Save() writes, the store as of one Copy()
+            struct Contents {
+                std::array<Sink, CAPACITY> sinks;
+                size_t count;
+                uint64_t useCounter;
+            };
+
+            SinkCapabilityStore();
+
+            SinkCapabilityStore(const SinkCapabilityStore&) = delete;
+            SinkCapabilityStore& operator=(const SinkCapabilityStore&) = delete;
+
+            //a missing or foreign file leaves the store empty
+            bool Load(const std::string& path);
+            bool Lookup(uint64_t edidHash, Sink& sink);
+            void Store(const Sink& sink);
+            size_t Size() const { return m_count; }
+            Contents Copy() const;
+
+            //one writer at a time per path, the owner serializes the calls
+            static bool Save(const std::string& path, const Contents& contents);
+
+            static uint64_t Hash(const std::vector<uint8_t>& edid);
+
+        private:
+            struct Header {
+                uint32_t magic;
+                uint16_t version;
+                uint16_t recordSize;
+                uint32_t count;
+                uint32_t reserved;
+                uint64_t useCounter;
+            };
+
+            std::string m_path;
+            std::array<Sink, CAPACITY> m_sinks;
+            size_t m_count;
+            uint64_t m_useCounter;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,120 @@
+#include "SinkQuirks.h"
+
+#include <algorithm>
+
+//without a platform table every sink keeps every quirk, see Resolve()
+#ifdef DISPLAYSETTINGS_QUIRKS_TABLE
+#define DISPLAYSETTINGS_QUIRKS_PLATFORM true
+#else
+#define DISPLAYSETTINGS_QUIRKS_TABLE "SinkQuirks.def"
+#define DISPLAYSETTINGS_QUIRKS_PLATFORM false
+#endif
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        namespace SinkQuirks {
+
+            namespace {
+
+                //manufacturer (15 bits), any product (1), product (16), serial (32): one compare per probe
+                struct Entry {
+                    uint64_t key;
+                    uint32_t quirks;
+                };
+
+                enum { ANY_SERIAL = 0, ANY_PRODUCT = -1 };
+
+                constexpr uint16_t pack(const char* pnp)
+                {
+                    return (uint16_t)(((pnp[0] - '@') & 0x1f) << 10 | ((pnp[1] - '@') & 0x1f) << 5 | ((pnp[2] - '@') & 0x1f));
+                }
+                constexpr uint64_t key(uint16_t manufacturer, bool anyProduct, uint16_t product, uint32_t serial)
+                {
+                    return (uint64_t)(manufacturer & 0x7fff) << 49 | (uint64_t)anyProduct << 48 | (uint64_t)product << 32 | serial;
+                }
+                constexpr uint64_t key(const char* pnp, int product, uint32_t serial)
+                {
+                    return product == ANY_PRODUCT ? key(pack(pnp), true, 0, serial) : key(pack(pnp), false, (uint16_t)product, serial);
+                }
+
+                //the terminator keeps the array non empty and sorts last
+                constexpr Entry table[] = {
+#define SINK_QUIRK(manufacturer, product, serial, quirks) { key(manufacturer, product, serial), (quirks) },
+#include DISPLAYSETTINGS_QUIRKS_TABLE
+#undef SINK_QUIRK
+                    { ~0ull, 0 }
+                };
+                constexpr size_t tableSize = sizeof(table) / sizeof(table[0]) - 1;
+
+                constexpr bool sorted(size_t i)
+                {
+                    return i >= tableSize || (table[i].key < table[i + 1].key && sorted(i + 1));
+                }
+                //a manufacturer wide entry for one serial would never be looked up
+                constexpr bool reachable(size_t i)
+                {
+                    return i >= tableSize || (!((table[i].key >> 48) & 1 && (uint32_t)table[i].key != ANY_SERIAL) && reachable(i + 1));
+                }
+                static_assert(sorted(0), "SinkQuirks.def must be sorted and free of duplicates");
+                static_assert(reachable(0), "SinkQuirks.def: ANY_PRODUCT entries take ANY_SERIAL");
+
+                const char* const names[COUNT] = { "XRE-7389", "DELIA-16415", "RDK-16024", "DELIA-18552" };
+
+                bool find(uint64_t wanted, uint32_t& quirks)
+                {
+                    const Entry* end = table + tableSize;
+                    const Entry* entry = std::lower_bound(table, end, wanted, [](const Entry& entry, uint64_t wanted) {
+                        return entry.key < wanted;
+                    });
+                    if (entry == end || entry->key != wanted)
+                        return false;
+                    quirks = entry->quirks;
+                    return true;
+                }
+            }
+
+            bool Parse(const std::vector<uint8_t>& edid, Id& id)
+            {
+                static const uint8_t header[8] = { 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00 };
+                if (edid.size() < 128 || !std::equal(header, header + sizeof(header), edid.begin()))
+                    return false;
+                //vendor big endian, product and serial little endian
+                id.manufacturer = (uint16_t)((edid[8] << 8 | edid[9]) & 0x7fff);
+                id.product = (uint16_t)(edid[10] | edid[11] << 8);
+                id.serial = (uint32_t)edid[12] | (uint32_t)edid[13] << 8 | (uint32_t)edid[14] << 16 | (uint32_t)edid[15] << 24;
+                return true;
+            }
+            uint32_t Resolve(const Id& id)
+            {
+                if (!DISPLAYSETTINGS_QUIRKS_PLATFORM || tableSize == 0)
+                    return ALL;
+                uint32_t quirks = 0;
+                if (id.serial != ANY_SERIAL && find(key(id.manufacturer, false, id.product, id.serial), quirks))
+                    return quirks;
+                if (find(key(id.manufacturer, false, id.product, ANY_SERIAL), quirks))
+                    return quirks;
+                if (find(key(id.manufacturer, true, 0, ANY_SERIAL), quirks))
+                    return quirks;
+                return 0;
+            }
+            const char* Name(unsigned bit)
+            {
+                return bit < COUNT ? names[bit] : "";
+            }
+            void ManufacturerName(uint16_t manufacturer, char* buffer)
+            {
+                buffer[0] = (char)('@' + ((manufacturer >> 10) & 0x1f));
+                buffer[1] = (char)('@' + ((manufacturer >> 5) & 0x1f));
+                buffer[2] = (char)('@' + (manufacturer & 0x1f));
+                buffer[3] = '\0';
+            }
+            size_t TableSize()
+            {
+                return tableSize;
+            }
+
+        } // namespace SinkQuirks
+    } // namespace Plugin
+} // namespace WPEFramework
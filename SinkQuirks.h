@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Workarounds that only some TVs/AVRs need, keyed by the manufacturer, product code and serial
+        // number of the sink's EDID. The table is SinkQuirks.def (or the file the DISPLAYSETTINGS_QUIRKS_TABLE
+        // cmake option names), compiled into a sorted array that Resolve() binary searches. The most specific
+        // entry wins: manufacturer, product and serial, then manufacturer and product, then the manufacturer.
+        // Until a platform builds in a table that has entries every sink resolves to ALL, as before the table.
+        namespace SinkQuirks {
+
+            //one bit per quirk, named after the ticket that introduced the workaround
+            enum : uint32_t {
+                XRE_7389 = 1u << 0,
+                DELIA_16415 = 1u << 1,
+                RDK_16024 = 1u << 2,
+                DELIA_18552 = 1u << 3,
+                COUNT = 4,
+                ALL = (1u << COUNT) - 1
+            };
+
+            struct Id {
+                uint16_t manufacturer;  // EISA id, three 5 bit letters
+                uint16_t product;
+                uint32_t serial;        // 0 when the sink does not report one
+            };
+
+            //false when edid does not start with a valid base block
+            bool Parse(const std::vector<uint8_t>& edid, Id& id);
+            //ALL without a platform table, 0 for a sink the platform table does not list
+            uint32_t Resolve(const Id& id);
+
+            //"XRE-7389" for bit 0
+            const char* Name(unsigned bit);
+            //"SAM", buffer holds at least 4 chars
+            void ManufacturerName(uint16_t manufacturer, char* buffer);
+            size_t TableSize();
+
+        } // namespace SinkQuirks
+    } // namespace Plugin
+} // namespace WPEFramework
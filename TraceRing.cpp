@@ -0,0 +1,243 @@
+#include "TraceRing.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        static_assert(sizeof(TraceRing::Record) == 32, "trace records are decoded by an offline tool, keep the layout fixed");
+
+        //for the callers that bind it by reference
+        const uint16_t TraceRing::NO_NAME;
+
+        namespace {
+
+            uint32_t slotOf(uint64_t key, uint32_t slots)
+            {
+                return (uint32_t)((key * 0x9e3779b97f4a7c15ULL) >> 32) % slots;
+            }
+            //FNV-1a over the part of the name the table keeps, never 0
+            uint64_t nameHash(const char* name, size_t length)
+            {
+                uint64_t hash = 0xcbf29ce484222325ULL;
+                for (size_t i = 0; i < length && name[i] != '\0'; i++)
+                    hash = (hash ^ (uint8_t)name[i]) * 0x100000001b3ULL;
+                return hash ? hash : 1;
+            }
+
+        } // namespace
+
+        class TraceRing::Writer {
+        public:
+            explicit Writer(TraceRing& ring)
+                : m_ring(ring)
+            {
+                //counted before the mapping is read: Close() either sees us or we see it gone
+                m_ring.m_writers.fetch_add(1);
+                header = m_ring.m_header.load();
+            }
+            ~Writer()
+            {
+                m_ring.m_writers.fetch_sub(1, std::memory_order_release);
+            }
+
+            Writer(const Writer&) = delete;
+            Writer& operator=(const Writer&) = delete;
+
+            Header* header;
+
+        private:
+            TraceRing& m_ring;
+        };
+
+        TraceRing::TraceRing()
+            : m_header(nullptr)
+            , m_size(0)
+            , m_writers(0)
+            , m_namesLock()
+        {
+            ClearSlots();
+        }
+        TraceRing::~TraceRing()
+        {
+            Close();
+        }
+        bool TraceRing::Open(const char* path)
+        {
+            Close();
+            int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (fd < 0)
+                return false;
+            size_t size = FileSize();
+            struct stat info;
+            bool fresh = (fstat(fd, &info) != 0) || ((size_t)info.st_size != size);
+            if (fresh && ftruncate(fd, size) != 0)
+            {
+                close(fd);
+                return false;
+            }
+            void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (base == MAP_FAILED)
+                return false;
+
+            Header* header = static_cast<Header*>(base);
+            if (fresh || header->magic != MAGIC || header->version != VERSION
+                || header->recordSize != sizeof(Record) || header->capacity != CAPACITY)
+            {
+                memset(base, 0, size);
+                header->version = VERSION;
+                header->recordSize = sizeof(Record);
+                header->capacity = CAPACITY;
+                __atomic_store_n(&header->magic, MAGIC, __ATOMIC_RELEASE);
+            }
+            header->session++;
+
+            std::lock_guard<std::mutex> guard(m_namesLock);
+            ClearSlots();
+            m_size = size;
+            m_header.store(header, std::memory_order_release);
+            return true;
+        }
+        void TraceRing::Close()
+        {
+            Header* header;
+            {
+                std::lock_guard<std::mutex> guard(m_namesLock);
+                header = m_header.exchange(nullptr);
+                ClearSlots();
+            }
+            if (header == nullptr)
+                return;
+            //a writer that got the mapping before it went away finishes its record first
+            while (m_writers.load(std::memory_order_acquire) != 0)
+                std::this_thread::yield();
+            munmap(header, m_size);
+            m_size = 0;
+        }
+        uint16_t TraceRing::Id(const char* literal)
+        {
+            if (literal == nullptr)
+                return NO_NAME;
+            Writer writer(*this);
+            if (writer.header == nullptr)
+                return NO_NAME;
+            const uint64_t key = (uint64_t)(uintptr_t)literal;
+            uint16_t id = Cached(writer.header, m_literals, key, literal, false);
+            return (id != NO_NAME) ? id : Resolve(m_literals, key, literal, false);
+        }
+        uint16_t TraceRing::NameId(const std::string& name)
+        {
+            if (name.empty())
+                return NO_NAME;
+            Writer writer(*this);
+            if (writer.header == nullptr)
+                return NO_NAME;
+            const uint64_t key = nameHash(name.c_str(), NAME_LENGTH - 1);
+            uint16_t id = Cached(writer.header, m_names, key, name.c_str(), true);
+            return (id != NO_NAME) ? id : Resolve(m_names, key, name.c_str(), true);
+        }
+        uint16_t TraceRing::Cached(const Header* header, const Slot* slots, uint64_t key, const char* name, bool verify) const
+        {
+            uint32_t slot = slotOf(key, SLOTS);
+            for (uint32_t probe = 0; probe < SLOTS; probe++, slot = (slot + 1) % SLOTS)
+            {
+                const uint64_t found = slots[slot].key.load(std::memory_order_acquire);
+                if (found == 0)
+                    break;
+                if (found != key)
+                    continue;
+                //a hash can collide, the name in the table decides
+                const uint16_t id = slots[slot].id.load(std::memory_order_relaxed);
+                if (!verify || strncmp(header->names[id], name, NAME_LENGTH - 1) == 0)
+                    return id;
+            }
+            return NO_NAME;
+        }
+        uint16_t TraceRing::Resolve(Slot* slots, uint64_t key, const char* name, bool verify)
+        {
+            std::lock_guard<std::mutex> guard(m_namesLock);
+            Header* header = m_header.load(std::memory_order_relaxed);
+            if (header == nullptr)
+                return NO_NAME;
+            uint16_t id = Cached(header, slots, key, name, verify);
+            if (id != NO_NAME)
+                return id;
+            id = Lookup(header, name);
+            if (id == NO_NAME)
+                return id;
+            uint32_t slot = slotOf(key, SLOTS);
+            for (uint32_t probe = 0; probe < SLOTS; probe++, slot = (slot + 1) % SLOTS)
+            {
+                if (slots[slot].key.load(std::memory_order_relaxed) == 0)
+                {
+                    //the id is in place before the key makes the slot visible
+                    slots[slot].id.store(id, std::memory_order_relaxed);
+                    slots[slot].key.store(key, std::memory_order_release);
+                    break;
+                }
+            }
+            return id;
+        }
+        void TraceRing::ClearSlots()
+        {
+            for (uint32_t slot = 0; slot < SLOTS; slot++)
+            {
+                m_literals[slot].key.store(0, std::memory_order_relaxed);
+                m_names[slot].key.store(0, std::memory_order_relaxed);
+            }
+        }
+        uint16_t TraceRing::Lookup(Header* header, const char* name)
+        {
+            //ids survive restarts: a name already in the file keeps its index
+            uint32_t count = header->nameCount;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                if (strncmp(header->names[i], name, NAME_LENGTH - 1) == 0)
+                    return (uint16_t)i;
+            }
+            if (count >= MAX_NAMES)
+                return NO_NAME;
+            strncpy(header->names[count], name, NAME_LENGTH - 1);
+            header->names[count][NAME_LENGTH - 1] = '\0';
+            __atomic_store_n(&header->nameCount, count + 1, __ATOMIC_RELEASE);
+            return (uint16_t)count;
+        }
+        void TraceRing::Add(Kind kind, uint16_t id, uint16_t port, uint64_t start, int32_t value0, int32_t value1, int32_t result)
+        {
+            Writer writer(*this);
+            Header* header = writer.header;
+            if (header == nullptr)
+                return;
+            Record* records = reinterpret_cast<Record*>(reinterpret_cast<uint8_t*>(header) + sizeof(Header));
+            uint64_t now = Now();
+            uint64_t index = __atomic_fetch_add(&header->writeIndex, 1, __ATOMIC_RELAXED);
+            Record& record = records[index % CAPACITY];
+            __atomic_store_n(&record.sequence, (uint16_t)~index, __ATOMIC_RELAXED);
+            record.timestamp = start ? start : now;
+            record.durationUs = start ? (uint32_t)((now - start) / 1000) : 0;
+            record.id = id;
+            record.port = port;
+            record.kind = (uint8_t)kind;
+            record.session = header->session;
+            record.value0 = value0;
+            record.value1 = value1;
+            record.result = result;
+            __atomic_store_n(&record.sequence, (uint16_t)index, __ATOMIC_RELEASE);
+        }
+        uint64_t TraceRing::Now()
+        {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Flight recorder: a fixed-size binary ring of compact records in a memory-mapped file.
+        // The mapping is MAP_SHARED, so records written before a crash or restart are still in
+        // the file afterwards and the next process continues the ring (with a new session number)
+        // instead of truncating it. Writing a record is a clock read, an atomic increment and a
+        // 32 byte store; no locks, no formatting, no syscalls.
+        //
+        // Names (methods, HAL calls, events, ports) are stored once in a table in the file header
+        // and records refer to them by index, which makes the file self-describing for the
+        // host-side decoder (tools/TraceDecoder.cpp). A name is looked up in the table once; after
+        // that Id() and NameId() find its index in a lock free cache.
+        //
+        // Close() waits for the writers in Add() to leave before it unmaps the file, so records can
+        // be added from any thread up to and across Close().
+        class TraceRing {
+        public:
+            static const uint32_t MAGIC = 0x52545344; // "DSTR"
+            static const uint16_t VERSION = 1;
+            static const uint32_t CAPACITY = 8192;
+            static const uint32_t MAX_NAMES = 256;
+            static const uint32_t NAME_LENGTH = 32;
+            static const uint16_t NO_NAME = 0xffff;
+
+            enum Kind {
+                METHOD = 1,     // JSON-RPC handler; value0 unused, result 0 = success
+                HAL_CALL = 2,   // executor call; port = port name, value0 = device exception code, result = HalExecutor::Result
+                IARM_EVENT = 3, // IARM event/call; port = IARM event id, value0/value1 = first two payload words
+                NOTIFY = 4      // Thunder notification sent
+            };
+
+            struct Record {
+                uint64_t timestamp;     // CLOCK_REALTIME ns, so timelines line up across restarts
+                uint32_t durationUs;
+                uint16_t id;            // index into Header::names
+                uint16_t port;          // index into Header::names or NO_NAME; event id for IARM_EVENT
+                uint8_t kind;
+                uint8_t session;        // bumped every time the plugin opens the file
+                uint16_t sequence;      // low bits of the slot index, written last to detect torn records
+                int32_t value0;
+                int32_t value1;
+                int32_t result;
+            };
+
+            struct Header {
+                uint32_t magic;
+                uint16_t version;
+                uint16_t recordSize;
+                uint32_t capacity;
+                uint32_t nameCount;
+                uint64_t writeIndex;    // total records ever written; slot = writeIndex % capacity
+                uint8_t session;
+                uint8_t reserved[39];
+                char names[MAX_NAMES][NAME_LENGTH];
+            };
+
+            TraceRing();
+            ~TraceRing();
+
+            TraceRing(const TraceRing&) = delete;
+            TraceRing& operator=(const TraceRing&) = delete;
+
+            bool Open(const char* path);
+            void Close();
+
+            // Returns the name table index for a string literal, adding it on first sight. The
+            // pointer is remembered so repeated lookups do not compare strings.
+            uint16_t Id(const char* literal);
+            // Same for a runtime string such as a port name, remembered by its hash; one compare.
+            uint16_t NameId(const std::string& name);
+
+            void Add(Kind kind, uint16_t id, uint16_t port, uint64_t start, int32_t value0, int32_t value1, int32_t result);
+
+            static uint64_t Now();
+
+            static size_t FileSize()
+            {
+                return sizeof(Header) + (size_t)CAPACITY * sizeof(Record);
+            }
+
+        private:
+            //open addressed, twice the name table so probes stay short; a key of 0 is a free slot
+            static const uint32_t SLOTS = 2 * MAX_NAMES;
+            struct Slot {
+                std::atomic<uint64_t> key;
+                std::atomic<uint16_t> id;
+            };
+
+            //Add(), Id() and NameId() work on the mapping inside a Writer, see Close()
+            class Writer;
+
+            uint16_t Lookup(Header* header, const char* name);
+            uint16_t Cached(const Header* header, const Slot* slots, uint64_t key, const char* name, bool verify) const;
+            uint16_t Resolve(Slot* slots, uint64_t key, const char* name, bool verify);
+            void ClearSlots();
+
+            std::atomic<Header*> m_header;
+            size_t m_size;
+            //writers inside Add(), Close() unmaps when it drops to 0
+            std::atomic<uint32_t> m_writers;
+            //serializes additions to the name table and to the slots
+            std::mutex m_namesLock;
+            Slot m_literals[SLOTS];     //by pointer
+            Slot m_names[SLOTS];        //by hash of the name
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,253 @@
+// Replays a DisplaySettings capture (see CaptureLog.h, enabled with setCaptureMode) against the plugin
+// in process, on the fake Thunder, DS HAL and IARM bus of tests/fake, and reports how long the plugin
+// took per method and per event. Requests go to the dispatcher on the interface version and channel
+// they were captured with, so the setter rate limit sees them as it did on the box; IARM events and
+// calls are delivered to the handlers the plugin registered, on the bus thread, and timed there.
+// The HAL answers from the fake's default platform (see FakeHal.h), every call delayed by --latency.
+//
+//   CaptureReplay [-v] [--paced] [--latency ms] <capture file>
+//
+// Back to back by default; --paced keeps the gaps of the capture, for what depends on them (the rate
+// limit, the resolution jobs). A request the dispatcher refuses or an event nothing is registered for
+// fails the replay; "success":false answers are counted, that is the plugin answering.
+//
+// The plugin logs to stderr when /opt/logs is not writable; that goes to /dev/null unless -v.
+
+#include "DisplaySettings.h"
+
+#include "FakeHal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace WPEFramework;
+
+namespace {
+
+    struct Entry {
+        uint64_t t;
+        string type;
+        uint8_t version;
+        uint32_t channel;
+        string method;   //request: method, call: name
+        string owner;
+        int eventId;
+        string params;
+        std::vector<uint8_t> payload;
+    };
+
+    struct Shell : public PluginHost::IShell {
+    };
+
+    //the capture is written by CaptureLog with a fixed key order, so a full JSON parser is not needed
+    string field(const string& line, const char* key)
+    {
+        string pattern = string("\"") + key + "\":";
+        size_t at = line.find(pattern);
+        if (at == string::npos)
+            return "";
+        at += pattern.size();
+        if (line[at] == '"')
+        {
+            size_t end = line.find('"', at + 1);
+            return line.substr(at + 1, end == string::npos ? string::npos : end - at - 1);
+        }
+        size_t end = line.find_first_of(",}", at);
+        return line.substr(at, end == string::npos ? string::npos : end - at);
+    }
+
+    bool parse(const string& line, Entry& entry)
+    {
+        entry.t = strtoull(field(line, "t").c_str(), nullptr, 10);
+        entry.type = field(line, "type");
+        if (entry.type == "request")
+        {
+            //captures from before the version and channel were recorded went to version 1
+            string version = field(line, "version");
+            string channel = field(line, "channel");
+            entry.version = version.empty() ? 1 : (uint8_t)atoi(version.c_str());
+            entry.channel = channel.empty() ? 1 : (uint32_t)strtoul(channel.c_str(), nullptr, 10);
+            entry.method = field(line, "method");
+            //params is the last member: everything up to the closing brace of the line
+            size_t at = line.find("\"params\":");
+            size_t end = line.rfind('}');
+            if (at == string::npos || end == string::npos || end <= at + 9)
+                return false;
+            entry.params = line.substr(at + 9, end - at - 9);
+            return !entry.method.empty();
+        }
+        entry.owner = field(line, "owner");
+        string hex = field(line, "payload");
+        for (size_t i = 0; i + 1 < hex.size(); i += 2)
+            entry.payload.push_back((uint8_t)strtoul(hex.substr(i, 2).c_str(), nullptr, 16));
+        if (entry.type == "event")
+        {
+            entry.eventId = atoi(field(line, "id").c_str());
+            return !entry.owner.empty();
+        }
+        if (entry.type == "call")
+        {
+            entry.method = field(line, "name");
+            return !entry.owner.empty() && !entry.method.empty();
+        }
+        return false;
+    }
+
+    struct Stats {
+        std::vector<double> times;   //milliseconds
+        unsigned unsuccessful = 0;
+        unsigned failures = 0;
+    };
+
+    void report(const std::map<string, Stats>& stats, double wallSeconds)
+    {
+        printf("%-44s %7s %6s %6s %9s %9s %9s %9s\n", "name", "count", "unsucc", "fail", "min ms", "mean ms", "p95 ms", "max ms");
+        size_t total = 0;
+        for (const auto& it : stats)
+        {
+            std::vector<double> sorted = it.second.times;
+            std::sort(sorted.begin(), sorted.end());
+            total += sorted.size();
+            if (sorted.empty())
+            {
+                printf("%-44s %7u %6u %6u\n", it.first.c_str(), 0u, it.second.unsuccessful, it.second.failures);
+                continue;
+            }
+            double sum = 0;
+            for (double value : sorted)
+                sum += value;
+            size_t p95 = std::min(sorted.size() - 1, (size_t)(sorted.size() * 0.95));
+            printf("%-44s %7zu %6u %6u %9.3f %9.3f %9.3f %9.3f\n", it.first.c_str(), sorted.size(), it.second.unsuccessful,
+                it.second.failures, sorted.front(), sum / sorted.size(), sorted[p95], sorted.back());
+        }
+        printf("%zu replayed in %.3f s, %.1f/s\n", total, wallSeconds, wallSeconds > 0 ? total / wallSeconds : 0.0);
+    }
+
+    int usage(const char* self)
+    {
+        fprintf(stderr, "usage: %s [-v] [--paced] [--latency ms] <capture file>\n", self);
+        return 2;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    bool verbose = false;
+    bool paced = false;
+    int latency = 0;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-v") == 0)
+            verbose = true;
+        else if (strcmp(argv[i], "--paced") == 0)
+            paced = true;
+        else if (strcmp(argv[i], "--latency") == 0 && i + 1 < argc)
+            latency = atoi(argv[++i]);
+        else if (argv[i][0] == '-')
+            return usage(argv[0]);
+        else
+            path = argv[i];
+    }
+    if (path == nullptr)
+        return usage(argv[0]);
+
+    std::ifstream input(path);
+    if (!input)
+    {
+        perror(path);
+        return 1;
+    }
+    std::vector<Entry> entries;
+    string line;
+    unsigned skipped = 0;
+    while (std::getline(input, line))
+    {
+        Entry entry;
+        if (parse(line, entry))
+            entries.push_back(entry);
+        else if (!line.empty())
+            skipped++;
+    }
+    if (skipped)
+        fprintf(stdout, "%u malformed lines skipped\n", skipped);
+    if (!verbose && freopen("/dev/null", "w", stderr) == nullptr)
+        perror("freopen");
+
+    FakeHal::Reset();
+    FakeHal::SetLatency(std::chrono::milliseconds(latency));
+    PluginHost::IPlugin* plugin = Core::Service<Plugin::DisplaySettings>::Create<PluginHost::IPlugin>();
+    PluginHost::IDispatcher* dispatcher = static_cast<PluginHost::IDispatcher*>(plugin->QueryInterface(PluginHost::IDispatcher::ID));
+    Shell shell;
+    plugin->Initialize(&shell);
+    FakeHal::Drain();
+
+    std::map<string, Stats> stats;
+    unsigned failures = 0;
+    uint32_t sequence = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (const Entry& entry : entries)
+    {
+        if (paced)
+            std::this_thread::sleep_until(begin + std::chrono::microseconds(entry.t));
+        string name;
+        double elapsed = 0;
+        bool dispatched = true;
+        bool success = true;
+        if (entry.type == "request")
+        {
+            name = entry.method + " v" + std::to_string(entry.version);
+            string result;
+            auto start = std::chrono::steady_clock::now();
+            const uint32_t error = dispatcher->Invoke(Core::JSONRPC::Context(entry.channel, ++sequence, string()),
+                entry.version, entry.method, entry.params, result);
+            elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            JsonObject response;
+            dispatched = (error == Core::ERROR_NONE) && response.FromString(result);
+            success = dispatched && response["success"].Boolean();
+        }
+        else
+        {
+            std::chrono::nanoseconds handler;
+            if (entry.type == "event")
+            {
+                name = "event " + entry.owner + "/" + std::to_string(entry.eventId);
+                handler = FakeHal::DeliverEvent(entry.owner.c_str(), (IARM_EventId_t)entry.eventId, entry.payload.data(), entry.payload.size());
+            }
+            else
+            {
+                name = "call " + entry.owner + "/" + entry.method;
+                handler = FakeHal::DeliverCall(entry.method.c_str(), entry.payload.data(), entry.payload.size());
+            }
+            dispatched = handler.count() >= 0;
+            elapsed = std::chrono::duration<double, std::milli>(handler).count();
+        }
+        Stats& entryStats = stats[name];
+        if (!dispatched)
+        {
+            entryStats.failures++;
+            failures++;
+            continue;
+        }
+        if (!success)
+            entryStats.unsuccessful++;
+        entryStats.times.push_back(elapsed);
+    }
+    FakeHal::Drain();
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    plugin->Deinitialize(&shell);
+    dispatcher->Release();
+    plugin->Release();
+
+    report(stats, wallSeconds);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,163 @@
+// Heap allocations per JSON-RPC method, against the fake Thunder, DS HAL and IARM bus of tests/fake.
+// Every method is called once to fill the caches, then again while operator new counts; a method
+// that allocates more than its budget fails the run. The counts include what the fake JSON-RPC
+// layer allocates to parse the parameters and write the response, so they are comparable run to
+// run rather than with a device. Lower a budget when a change brings a method under it.
+//
+//   DisplaySettingsAllocations [-v]
+//
+// -v also shows the plugin log, which goes to /dev/null otherwise.
+
+#include "DisplaySettings.h"
+
+#include "FakeHal.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+using namespace WPEFramework;
+
+namespace {
+
+    std::atomic<bool> counting(false);
+    std::atomic<uint64_t> allocations(0);
+
+    void* allocate(size_t size)
+    {
+        if (counting)
+            allocations++;
+        void* memory = malloc(size == 0 ? 1 : size);
+        if (memory == nullptr)
+            throw std::bad_alloc();
+        return memory;
+    }
+
+    struct Budget {
+        const char* method;
+        const char* parameters;
+        uint64_t allocations;
+    };
+
+    //calls on interface version 1, the newest API level
+    const Budget budgets[] = {
+        { "getConnectedVideoDisplays", "{}", 14 },
+        { "getConnectedAudioPorts", "{}", 16 },
+        { "getSupportedVideoDisplays", "{}", 14 },
+        { "getSupportedAudioPorts", "{}", 16 },
+        { "getSupportedResolutions", "{\"videoDisplay\":\"HDMI0\"}", 13 },
+        { "getSupportedSettopResolutions", "{}", 23 },
+        { "getSupportedTvResolutions", "{\"videoDisplay\":\"HDMI0\"}", 12 },
+        { "getTvHDRSupport", "{\"videoDisplay\":\"HDMI0\"}", 9 },
+        { "getSettopHDRSupport", "{}", 7 },
+        { "getCurrentResolution", "{\"videoDisplay\":\"HDMI0\"}", 6 },
+        { "getZoomSetting", "{}", 3 },
+        { "getSoundMode", "{\"videoDisplay\":\"HDMI0\"}", 5 },
+        { "getSupportedAudioModes", "{\"audioPort\":\"HDMI0\"}", 16 },
+        { "getActiveInput", "{\"videoDisplay\":\"HDMI0\"}", 6 },
+        { "readEDID", "{}", 6 },
+        { "getQuirks", "{}", 14 },
+    };
+
+    struct Shell : public PluginHost::IShell {
+    };
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    return allocate(size);
+}
+void* operator new[](size_t size)
+{
+    return allocate(size);
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return allocate(size);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+void operator delete[](void* memory) noexcept
+{
+    free(memory);
+}
+void operator delete(void* memory, size_t) noexcept
+{
+    free(memory);
+}
+void operator delete[](void* memory, size_t) noexcept
+{
+    free(memory);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && strcmp(argv[1], "-v") != 0)
+    {
+        fprintf(stderr, "usage: %s [-v]\n", argv[0]);
+        return 2;
+    }
+    if (argc == 1 && freopen("/dev/null", "w", stderr) == nullptr)
+        perror("freopen");
+
+    FakeHal::Reset();
+    PluginHost::IPlugin* plugin = Core::Service<Plugin::DisplaySettings>::Create<PluginHost::IPlugin>();
+    PluginHost::IDispatcher* dispatcher = static_cast<PluginHost::IDispatcher*>(plugin->QueryInterface(PluginHost::IDispatcher::ID));
+    Shell shell;
+    plugin->Initialize(&shell);
+    FakeHal::Drain();
+
+    bool passed = true;
+    uint32_t sequence = 0;
+    for (const Budget& budget : budgets)
+    {
+        string result;
+        const string method(budget.method);
+        const string parameters(budget.parameters);
+        const Core::JSONRPC::Context context(1, ++sequence, string());
+        //the first call fills the caches and the shadow state
+        dispatcher->Invoke(context, 1, method, parameters, result);
+        FakeHal::Drain();
+
+        //the least of a few runs, a background thread of the plugin may allocate meanwhile
+        uint64_t least = ~(uint64_t)0;
+        uint32_t error = Core::ERROR_NONE;
+        for (int run = 0; run < 5; run++)
+        {
+            result.clear();
+            result.reserve(1024);
+            allocations = 0;
+            counting = true;
+            error = dispatcher->Invoke(context, 1, method, parameters, result);
+            counting = false;
+            if (allocations < least)
+                least = allocations;
+        }
+        const bool ok = (error == Core::ERROR_NONE) && (least <= budget.allocations);
+        fprintf(stdout, "%-30s %4llu allocations, budget %4llu: %s\n", budget.method, (unsigned long long)least,
+            (unsigned long long)budget.allocations, ok ? "ok" : (error != Core::ERROR_NONE ? "FAILED (error)" : "FAILED"));
+        passed = passed && ok;
+    }
+    fflush(stdout);
+
+    plugin->Deinitialize(&shell);
+    dispatcher->Release();
+    plugin->Release();
+    return passed ? 0 : 1;
+}
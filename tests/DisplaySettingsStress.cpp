@@ -0,0 +1,275 @@
+// Multi-client stress of the plugin against the fake Thunder, DS HAL and IARM bus of tests/fake.
+// For 1, 2, 4 ... 32 clients, each on a JSON-RPC channel of its own and subscribed on one of the
+// interface versions, every client keeps calling getters and setSoundMode while an injector fires
+// a numbered series of resolution post change calls and zoom events at the IARM handlers. Every client must
+// receive every one of those notifications exactly once, in the order of the events; a lost,
+// duplicated or out of order notification fails the run. With more than one client the last one
+// disables zoomSettingUpdated with setNotificationFilter, it must get none while the others still get
+// them all. Requests per second are reported per client count.
+//
+//   DisplaySettingsStress [-v] [-e events] [-c maxClients]
+//
+// Requests the plugin answers with "success":false are counted, not failed: under this load that is
+// mostly the HAL executor shedding calls once its queue is full, which is what it is meant to do.
+//
+// The plugin logs to stderr when /opt/logs is not writable; that goes to /dev/null unless -v.
+
+#include "DisplaySettings.h"
+
+#include "FakeHal.h"
+#include "dsMgr.h"
+#include "dsTypes.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace WPEFramework;
+
+namespace {
+
+    const uint8_t INTERFACE_VERSIONS = 7;
+
+    struct Client {
+        uint32_t channel;
+        uint8_t version;
+        std::string designator;
+
+        std::mutex lock;
+        std::vector<int> widths;        // width of every resolutionChanged, in arrival order
+        std::vector<std::string> zooms; // zoomSetting of every zoomSettingUpdated
+        uint32_t unexpected = 0;        // notifications for a designator or event not subscribed
+        bool zoomDisabled = false;      // filtered out by its own setNotificationFilter
+
+        std::atomic<uint64_t> requests{ 0 };
+        std::atomic<uint64_t> failures{ 0 };    // not dispatched, or a response that does not parse
+        std::atomic<uint64_t> shed{ 0 };        // "success":false, mostly the HAL executor's queue being full
+    };
+
+    struct Shell : public PluginHost::IShell {
+    };
+
+    bool invoke(PluginHost::IDispatcher* dispatcher, Client& client, uint32_t sequence, const char* method, const string& parameters)
+    {
+        string result;
+        const uint32_t error = dispatcher->Invoke(Core::JSONRPC::Context(client.channel, sequence, string()),
+            client.version, method, parameters, result);
+        client.requests++;
+        JsonObject response;
+        if (error != Core::ERROR_NONE || !response.FromString(result))
+        {
+            client.failures++;
+            return false;
+        }
+        if (!response["success"].Boolean())
+        {
+            client.shed++;
+            return false;
+        }
+        return true;
+    }
+
+    void clientLoop(PluginHost::IDispatcher* dispatcher, Client& client, const std::atomic<bool>& stop)
+    {
+        static const char* const modes[] = { "stereo", "mono", "surround", "passthru" };
+        uint32_t sequence = 0;
+        while (!stop)
+        {
+            invoke(dispatcher, client, ++sequence, "getCurrentResolution", "{\"videoDisplay\":\"HDMI0\"}");
+            invoke(dispatcher, client, ++sequence, "getZoomSetting", "{}");
+            invoke(dispatcher, client, ++sequence, "getConnectedVideoDisplays", "{}");
+            invoke(dispatcher, client, ++sequence, "getSoundMode", "{\"videoDisplay\":\"HDMI0\"}");
+            const string mode = modes[sequence % 4];
+            invoke(dispatcher, client, ++sequence, "setSoundMode", "{\"videoDisplay\":\"HDMI0\",\"soundMode\":\"" + mode + "\"}");
+        }
+    }
+
+    //on the IARM bus thread, as dsMgr would send them: the post change call and the zoom event
+    void injectEvents(int events)
+    {
+        for (int k = 1; k <= events; k++)
+        {
+            IARM_Bus_CommonAPI_ResChange_Param_t change;
+            change.width = k;
+            change.height = 720;
+            FakeHal::PostCall(IARM_BUS_COMMON_API_ResolutionPostChange, &change, sizeof(change));
+
+            IARM_Bus_DSMgr_EventData_t data;
+            memset(&data, 0, sizeof(data));
+            data.data.dfc.zoomsettings = (k % 2) ? dsVIDEO_ZOOM_NONE : dsVIDEO_ZOOM_FULL;
+            FakeHal::PostEvent(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_ZOOM_SETTINGS, &data, sizeof(data));
+            if (k % 16 == 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    //lost, duplicated or out of order: anything but 1..events once each, in that order
+    bool check(Client& client, int events, int round)
+    {
+        std::lock_guard<std::mutex> guard(client.lock);
+        bool passed = true;
+        if (client.unexpected != 0)
+        {
+            fprintf(stdout, "  client %u: %u unexpected notifications\n", client.channel, client.unexpected);
+            passed = false;
+        }
+        int expected = 1;
+        int lost = 0, duplicated = 0, reordered = 0;
+        int previous = 0;
+        for (int width : client.widths)
+        {
+            if (width == previous)
+                duplicated++;
+            else if (width < previous)
+                reordered++;
+            else if (width > expected)
+                lost += width - expected;
+            if (width >= expected)
+                expected = width + 1;
+            previous = width;
+        }
+        lost += (events + 1) - expected;
+        if (lost || duplicated || reordered || (int)client.widths.size() != events)
+        {
+            fprintf(stdout, "  client %u (v%u, round %d): resolutionChanged %zu of %d, lost %d, duplicated %d, out of order %d\n",
+                client.channel, client.version, round, client.widths.size(), events, lost, duplicated, reordered);
+            passed = false;
+        }
+        //zoom alternates, so every event is a change and must be seen as one, unless the client disabled them
+        bool zoomsInOrder = ((int)client.zooms.size() == (client.zoomDisabled ? 0 : events));
+        for (size_t i = 0; zoomsInOrder && i < client.zooms.size(); i++)
+            zoomsInOrder = (client.zooms[i] == ((i % 2) ? "FULL" : "NONE"));
+        if (!zoomsInOrder)
+        {
+            fprintf(stdout, "  client %u (v%u, round %d): zoomSettingUpdated %zu of %d or out of order\n",
+                client.channel, client.version, round, client.zooms.size(), events);
+            passed = false;
+        }
+        if (client.failures != 0)
+        {
+            fprintf(stdout, "  client %u: %llu of %llu requests failed\n", client.channel,
+                (unsigned long long)client.failures.load(), (unsigned long long)client.requests.load());
+            passed = false;
+        }
+        return passed;
+    }
+
+    bool run(int clientCount, int events, int round)
+    {
+        FakeHal::Reset();
+        PluginHost::IPlugin* plugin = Core::Service<Plugin::DisplaySettings>::Create<PluginHost::IPlugin>();
+        PluginHost::IDispatcher* dispatcher = static_cast<PluginHost::IDispatcher*>(plugin->QueryInterface(PluginHost::IDispatcher::ID));
+        Shell shell;
+        plugin->Initialize(&shell);
+        FakeHal::Drain();
+
+        std::vector<std::unique_ptr<Client>> clients;
+        for (int i = 0; i < clientCount; i++)
+        {
+            clients.emplace_back(new Client());
+            Client& client = *clients.back();
+            client.channel = (uint32_t)i + 1;
+            client.version = (uint8_t)(i % INTERFACE_VERSIONS) + 1;
+            client.designator = "client" + std::to_string(i) + ".1";
+            dispatcher->Subscribe(client.channel, client.version, "resolutionChanged", client.designator);
+            dispatcher->Subscribe(client.channel, client.version, "zoomSettingUpdated", client.designator);
+        }
+        if (clientCount > 1)
+        {
+            Client& client = *clients.back();
+            client.zoomDisabled = invoke(dispatcher, client, 0, "setNotificationFilter",
+                "{\"id\":\"" + client.designator + "\",\"disabledEvents\":[\"zoomSettingUpdated\"]}");
+            if (!client.zoomDisabled)
+                client.failures++;
+        }
+        Core::JSONRPC::Handler::SetNotificationSink([&clients](uint32_t channel, const string& designator, const string& event, const string& parameters) {
+            if (channel == 0 || channel > clients.size())
+                return;
+            Client& client = *clients[channel - 1];
+            JsonObject params;
+            params.FromString(parameters);
+            std::lock_guard<std::mutex> guard(client.lock);
+            if (designator != client.designator)
+                client.unexpected++;
+            else if (event == "resolutionChanged")
+                client.widths.push_back((int)params["width"].Number());
+            else if (event == "zoomSettingUpdated")
+                client.zooms.push_back(params["zoomSetting"].String());
+            else
+                client.unexpected++;
+        });
+
+        std::atomic<bool> stop(false);
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (auto& client : clients)
+            threads.emplace_back(clientLoop, dispatcher, std::ref(*client), std::cref(stop));
+        injectEvents(events);
+        FakeHal::Drain();
+        stop = true;
+        for (std::thread& thread : threads)
+            thread.join();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        bool passed = true;
+        uint64_t requests = 0;
+        uint64_t shed = 0;
+        for (auto& client : clients)
+        {
+            passed = check(*client, events, round) && passed;
+            requests += client->requests;
+            shed += client->shed;
+        }
+        //shedding is the executor's back pressure working, reported but not a failure
+        fprintf(stdout, "%2d clients: %7llu requests in %6.2f s, %9.0f requests/s, %6llu unsuccessful, %d events: %s\n", clientCount,
+            (unsigned long long)requests, seconds, requests / seconds, (unsigned long long)shed, events, passed ? "ok" : "FAILED");
+        fflush(stdout);
+
+        Core::JSONRPC::Handler::SetNotificationSink(Core::JSONRPC::Handler::NotificationSink());
+        for (auto& client : clients)
+        {
+            dispatcher->Unsubscribe(client->channel, client->version, "resolutionChanged", client->designator);
+            dispatcher->Unsubscribe(client->channel, client->version, "zoomSettingUpdated", client->designator);
+        }
+        plugin->Deinitialize(&shell);
+        dispatcher->Release();
+        plugin->Release();
+        return passed;
+    }
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bool verbose = false;
+    int events = 200;
+    int maxClients = 32;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-v") == 0)
+            verbose = true;
+        else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+            events = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+            maxClients = atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [-v] [-e events] [-c maxClients]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (!verbose && freopen("/dev/null", "w", stderr) == nullptr)
+        perror("freopen");
+
+    bool passed = true;
+    int round = 0;
+    for (int clients = 1; clients <= maxClients; clients *= 2)
+        passed = run(clients, events, ++round) && passed;
+    return passed ? 0 : 1;
+}
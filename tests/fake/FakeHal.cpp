@@ -0,0 +1,724 @@
+#include "FakeHal.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "host.hpp"
+#include "dsMgr.h"
+#include "rdk/iarmmgrs-hal/pwrMgr.h"
+#include "tracing/tracing.h"
+
+namespace {
+
+    const int VIDEO_PORT_HDMI = 1;
+
+    struct VideoPortState {
+        int type;
+        bool connected;
+        std::string resolution;
+        std::vector<uint8_t> edid;
+        int tvResolutions;
+        int hdrCapabilities;
+        int surroundMode;
+        bool standbyEnabled;
+    };
+
+    struct AudioPortState {
+        int type;
+        int stereoMode;
+        bool stereoAuto;
+    };
+
+    const char* const SUPPORTED_RESOLUTIONS[] = { "480p", "576p50", "720p", "1080i", "1080p24", "1080p60", "2160p30", "2160p60" };
+
+    const char* const STEREO_MODE_NAMES[] = { "UNKNOWN", "MONO", "STEREO", "SURROUND", "PASSTHRU" };
+
+    class Platform {
+    public:
+        static Platform& Instance()
+        {
+            static Platform* platform = new Platform();
+            return *platform;
+        }
+
+        void Reset()
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            VideoPortState hdmi;
+            hdmi.type = VIDEO_PORT_HDMI;
+            hdmi.connected = true;
+            hdmi.resolution = "720p";
+            //a minimal base block: manufacturer "TST", product 0x1234, serial 1
+            hdmi.edid.assign(128, 0);
+            const uint8_t header[] = { 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x52, 0x93, 0x34, 0x12, 0x01, 0x00, 0x00, 0x00 };
+            memcpy(hdmi.edid.data(), header, sizeof(header));
+            hdmi.tvResolutions = dsTV_RESOLUTION_480p | dsTV_RESOLUTION_720p | dsTV_RESOLUTION_1080i | dsTV_RESOLUTION_1080p;
+            hdmi.hdrCapabilities = dsHDRSTANDARD_HDR10;
+            hdmi.surroundMode = dsSURROUNDMODE_DD;
+            hdmi.standbyEnabled = false;
+            videoPorts.clear();
+            videoPorts["HDMI0"] = hdmi;
+
+            audioPorts.clear();
+            audioPorts["HDMI0"] = AudioPortState{ device::AudioOutputPortType::kHDMI, device::AudioStereoMode::kStereo, false };
+            audioPorts["SPDIF0"] = AudioPortState{ device::AudioOutputPortType::kSPDIF, device::AudioStereoMode::kStereo, false };
+            zoom = "Full";
+            latency = std::chrono::milliseconds(0);
+            calls = 0;
+        }
+
+        //counts the call and applies the latency, outside of the lock
+        void Enter()
+        {
+            calls++;
+            std::chrono::milliseconds delay;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                delay = latency;
+            }
+            if (delay.count() > 0)
+                std::this_thread::sleep_for(delay);
+        }
+
+        VideoPortState& Video(const std::string& name)
+        {
+            auto it = videoPorts.find(name);
+            if (it == videoPorts.end())
+                throw device::Exception(-1, "unknown video port");
+            return it->second;
+        }
+        AudioPortState& Audio(const std::string& name)
+        {
+            auto it = audioPorts.find(name);
+            if (it == audioPorts.end())
+                throw device::Exception(-1, "unknown audio port");
+            return it->second;
+        }
+
+        //the DS classes hand out references, so every object handed out lives as long as the process
+        template <typename T>
+        T& Intern(std::map<std::string, std::unique_ptr<T>>& objects, const std::string& name)
+        {
+            std::unique_ptr<T>& object = objects[name];
+            if (!object)
+                object.reset(new T(name));
+            return *object;
+        }
+
+        std::mutex lock;
+        std::map<std::string, VideoPortState> videoPorts;
+        std::map<std::string, AudioPortState> audioPorts;
+        std::string zoom;
+        std::chrono::milliseconds latency;
+        std::atomic<uint32_t> calls;
+
+        std::map<std::string, std::unique_ptr<device::VideoOutputPort>> videoPortObjects;
+        std::map<std::string, std::unique_ptr<device::AudioOutputPort>> audioPortObjects;
+        std::map<std::string, std::unique_ptr<device::VideoResolution>> resolutionObjects;
+        std::map<std::string, std::unique_ptr<device::DFC>> dfcObjects;
+        std::map<int, std::unique_ptr<device::VideoOutputPortType>> portTypeObjects;
+        std::shared_ptr<std::vector<device::VideoDevice>> videoDevices;
+
+    private:
+        Platform()
+            : calls(0)
+            , videoDevices(std::make_shared<std::vector<device::VideoDevice>>(1))
+        {
+            Reset();
+        }
+    };
+
+    // The bus thread: events and calls are delivered in the order they were queued
+    class Bus {
+    public:
+        static Bus& Instance()
+        {
+            static Bus* bus = new Bus();
+            return *bus;
+        }
+
+        void Post(const std::function<void()>& delivery)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            queue.push_back(delivery);
+            queued++;
+            signal.notify_all();
+        }
+        void Drain()
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            const uint64_t target = queued;
+            signal.wait(guard, [this, target]() { return delivered >= target; });
+        }
+
+        std::mutex lock;
+        std::map<std::pair<std::string, IARM_EventId_t>, IARM_EventHandler_t> handlers;
+        std::map<std::string, IARM_BusCall_t> calls;
+
+    private:
+        Bus()
+            : queued(0)
+            , delivered(0)
+        {
+            std::thread(&Bus::Run, this).detach();
+        }
+        void Run()
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            for (;;)
+            {
+                signal.wait(guard, [this]() { return !queue.empty(); });
+                std::function<void()> delivery = queue.front();
+                queue.pop_front();
+                guard.unlock();
+                delivery();
+                guard.lock();
+                delivered++;
+                signal.notify_all();
+            }
+        }
+
+        std::condition_variable signal;
+        std::deque<std::function<void()>> queue;
+        uint64_t queued;
+        uint64_t delivered;
+    };
+
+    //the time the handler took, negative when there is none
+    std::chrono::nanoseconds deliverEvent(const std::string& owner, IARM_EventId_t event, std::vector<uint8_t> data)
+    {
+        IARM_EventHandler_t handler = nullptr;
+        {
+            Bus& bus = Bus::Instance();
+            std::lock_guard<std::mutex> guard(bus.lock);
+            auto it = bus.handlers.find(std::make_pair(owner, event));
+            if (it != bus.handlers.end())
+                handler = it->second;
+        }
+        if (handler == nullptr)
+            return std::chrono::nanoseconds(-1);
+        const auto start = std::chrono::steady_clock::now();
+        handler(owner.c_str(), event, data.data(), data.size());
+        return std::chrono::steady_clock::now() - start;
+    }
+
+    std::chrono::nanoseconds deliverCall(const std::string& method, std::vector<uint8_t> argument)
+    {
+        IARM_BusCall_t call = nullptr;
+        {
+            Bus& bus = Bus::Instance();
+            std::lock_guard<std::mutex> guard(bus.lock);
+            auto it = bus.calls.find(method);
+            if (it != bus.calls.end())
+                call = it->second;
+        }
+        if (call == nullptr)
+            return std::chrono::nanoseconds(-1);
+        const auto start = std::chrono::steady_clock::now();
+        call(argument.data());
+        return std::chrono::steady_clock::now() - start;
+    }
+
+} // namespace
+
+namespace FakeHal {
+
+    void Reset()
+    {
+        Platform::Instance().Reset();
+    }
+    void SetConnected(const std::string& port, bool connected)
+    {
+        Platform& platform = Platform::Instance();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        platform.Video(port).connected = connected;
+    }
+    void SetResolution(const std::string& port, const std::string& resolution)
+    {
+        Platform& platform = Platform::Instance();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        platform.Video(port).resolution = resolution;
+    }
+    void SetEdid(const std::string& port, const std::vector<uint8_t>& edid)
+    {
+        Platform& platform = Platform::Instance();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        platform.Video(port).edid = edid;
+    }
+    void SetTvResolutions(const std::string& port, int resolutions)
+    {
+        Platform& platform = Platform::Instance();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        platform.Video(port).tvResolutions = resolutions;
+    }
+    void SetHdrCapabilities(const std::string& port, int capabilities)
+    {
+        Platform& platform = Platform::Instance();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        platform.Video(port).hdrCapabilities = capabilities;
+    }
+    void SetSurroundMode(const std::string& port, int surroundMode)
+    {
+        Platform& platform = Platform::Instance();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        platform.Video(port).surroundMode = surroundMode;
+    }
+    void SetLatency(std::chrono::milliseconds latency)
+    {
+        Platform& platform = Platform::Instance();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        platform.latency = latency;
+    }
+    std::string Resolution(const std::string& port)
+    {
+        Platform& platform = Platform::Instance();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        return platform.Video(port).resolution;
+    }
+    std::string StereoMode(const std::string& port)
+    {
+        Platform& platform = Platform::Instance();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        return STEREO_MODE_NAMES[platform.Audio(port).stereoMode];
+    }
+    std::string Zoom()
+    {
+        Platform& platform = Platform::Instance();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        return platform.zoom;
+    }
+    uint32_t Calls()
+    {
+        return Platform::Instance().calls;
+    }
+    void PostEvent(const char* owner, IARM_EventId_t event, const void* data, size_t length)
+    {
+        std::vector<uint8_t> copy((const uint8_t*)data, (const uint8_t*)data + length);
+        std::string name(owner);
+        Bus::Instance().Post([name, event, copy]() { deliverEvent(name, event, copy); });
+    }
+    void PostCall(const char* method, const void* argument, size_t length)
+    {
+        std::vector<uint8_t> copy((const uint8_t*)argument, (const uint8_t*)argument + length);
+        std::string name(method);
+        Bus::Instance().Post([name, copy]() { deliverCall(name, copy); });
+    }
+    void Drain()
+    {
+        Bus::Instance().Drain();
+    }
+    std::chrono::nanoseconds DeliverEvent(const char* owner, IARM_EventId_t event, const void* data, size_t length)
+    {
+        std::vector<uint8_t> copy((const uint8_t*)data, (const uint8_t*)data + length);
+        std::string name(owner);
+        std::chrono::nanoseconds elapsed(0);
+        Bus::Instance().Post([name, event, copy, &elapsed]() { elapsed = deliverEvent(name, event, copy); });
+        Bus::Instance().Drain();
+        return elapsed;
+    }
+    std::chrono::nanoseconds DeliverCall(const char* method, const void* argument, size_t length)
+    {
+        std::vector<uint8_t> copy((const uint8_t*)argument, (const uint8_t*)argument + length);
+        std::string name(method);
+        std::chrono::nanoseconds elapsed(0);
+        Bus::Instance().Post([name, copy, &elapsed]() { elapsed = deliverCall(name, copy); });
+        Bus::Instance().Drain();
+        return elapsed;
+    }
+    size_t Handlers(const char* owner, IARM_EventId_t event)
+    {
+        Bus& bus = Bus::Instance();
+        std::lock_guard<std::mutex> guard(bus.lock);
+        return bus.handlers.count(std::make_pair(std::string(owner), event));
+    }
+    void ResolutionSize(const std::string& resolution, int& width, int& height)
+    {
+        height = atoi(resolution.c_str());
+        width = height * 16 / 9;
+    }
+
+} // namespace FakeHal
+
+namespace device {
+
+    void Display::getEDIDBytes(std::vector<uint8_t>& edid)
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        VideoPortState& port = platform.Video(m_port);
+        if (!port.connected)
+            throw Exception(-1, "no sink connected");
+        edid = port.edid;
+    }
+    int Display::getSurroundMode()
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        VideoPortState& port = platform.Video(m_port);
+        return port.connected ? port.surroundMode : dsSURROUNDMODE_NONE;
+    }
+
+    AudioStereoMode::AudioStereoMode(int id)
+        : m_id(id)
+        , m_name((id >= kMono && id <= kPassThru) ? STEREO_MODE_NAMES[id] : STEREO_MODE_NAMES[0])
+    {
+    }
+
+    AudioOutputPort::AudioOutputPort(const std::string& name)
+        : m_name(name)
+        , m_type(name.compare(0, 5, "SPDIF") == 0 ? AudioOutputPortType::kSPDIF : AudioOutputPortType::kHDMI)
+    {
+    }
+    bool AudioOutputPort::isConnected()
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        platform.Audio(m_name);
+        auto video = platform.videoPorts.find(m_name);
+        return video == platform.videoPorts.end() || video->second.connected;
+    }
+    const List<AudioStereoMode> AudioOutputPort::getSupportedStereoModes() const
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        List<AudioStereoMode> modes;
+        std::lock_guard<std::mutex> guard(platform.lock);
+        const AudioPortState& port = platform.Audio(m_name);
+        //HAL order, not id order
+        modes.push_back(AudioStereoMode(AudioStereoMode::kStereo));
+        modes.push_back(AudioStereoMode(AudioStereoMode::kMono));
+        if (port.type == AudioOutputPortType::kHDMI)
+        {
+            auto video = platform.videoPorts.find(m_name);
+            if (video != platform.videoPorts.end() && video->second.surroundMode != dsSURROUNDMODE_NONE)
+                modes.push_back(AudioStereoMode(AudioStereoMode::kSurround));
+        }
+        modes.push_back(AudioStereoMode(AudioStereoMode::kPassThru));
+        return modes;
+    }
+    AudioStereoMode AudioOutputPort::getStereoMode(bool)
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        return AudioStereoMode(platform.Audio(m_name).stereoMode);
+    }
+    void AudioOutputPort::setStereoMode(const std::string& mode)
+    {
+        for (int id = AudioStereoMode::kMono; id <= AudioStereoMode::kPassThru; id++)
+        {
+            if (mode == STEREO_MODE_NAMES[id])
+            {
+                setStereoMode(id);
+                return;
+            }
+        }
+        throw Exception(-1, "unknown stereo mode");
+    }
+    void AudioOutputPort::setStereoMode(int mode)
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        platform.Audio(m_name).stereoMode = mode;
+    }
+    void AudioOutputPort::setStereoAuto(bool enable)
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        platform.Audio(m_name).stereoAuto = enable;
+    }
+    bool AudioOutputPort::getStereoAuto()
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        return platform.Audio(m_name).stereoAuto;
+    }
+
+    const List<VideoResolution> VideoOutputPortType::getSupportedResolutions() const
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        List<VideoResolution> resolutions;
+        for (const char* name : SUPPORTED_RESOLUTIONS)
+            resolutions.push_back(VideoResolution(name));
+        return resolutions;
+    }
+
+    VideoOutputPort::VideoOutputPort(const std::string& name)
+        : m_name(name)
+        , m_type(VIDEO_PORT_HDMI)
+        , m_display(name)
+    {
+    }
+    const VideoResolution& VideoOutputPort::getResolution()
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        return platform.Intern(platform.resolutionObjects, platform.Video(m_name).resolution);
+    }
+    void VideoOutputPort::setResolution(const std::string& resolution)
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        bool changed = false;
+        {
+            std::lock_guard<std::mutex> guard(platform.lock);
+            VideoPortState& port = platform.Video(m_name);
+            bool supported = false;
+            for (const char* name : SUPPORTED_RESOLUTIONS)
+                supported = supported || (resolution == name);
+            if (!supported)
+                throw Exception(-1, "unsupported resolution");
+            changed = (port.resolution != resolution);
+            port.resolution = resolution;
+        }
+        if (changed)
+        {
+            //DSMgr tells the registered listeners around the mode switch
+            IARM_Bus_CommonAPI_ResChange_Param_t change;
+            FakeHal::ResolutionSize(resolution, change.width, change.height);
+            FakeHal::PostCall(IARM_BUS_COMMON_API_ResolutionPreChange, &change, sizeof(change));
+            FakeHal::PostCall(IARM_BUS_COMMON_API_ResolutionPostChange, &change, sizeof(change));
+        }
+    }
+    bool VideoOutputPort::isDisplayConnected()
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        return platform.Video(m_name).connected;
+    }
+    bool VideoOutputPort::isActive()
+    {
+        return isDisplayConnected();
+    }
+    void VideoOutputPort::getSupportedTvResolutions(int* resolutions)
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        VideoPortState& port = platform.Video(m_name);
+        if (!port.connected)
+            throw Exception(-1, "no sink connected");
+        *resolutions = port.tvResolutions;
+    }
+    void VideoOutputPort::getTVHDRCapabilities(int* capabilities)
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        VideoPortState& port = platform.Video(m_name);
+        if (!port.connected)
+            throw Exception(-1, "no sink connected");
+        *capabilities = port.hdrCapabilities;
+    }
+    AudioOutputPort& VideoOutputPort::getAudioOutputPort()
+    {
+        return Host::getInstance().getAudioOutputPort(m_name);
+    }
+
+    const DFC& VideoDevice::getDFC()
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        return platform.Intern(platform.dfcObjects, platform.zoom);
+    }
+    void VideoDevice::setDFC(const std::string& name)
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        if (name != "Full" && name != "None")
+            throw Exception(-1, "unknown zoom setting");
+        std::lock_guard<std::mutex> guard(platform.lock);
+        platform.zoom = name;
+    }
+    void VideoDevice::getSettopSupportedResolutions(std::list<std::string>& resolutions)
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        resolutions.assign(std::begin(SUPPORTED_RESOLUTIONS), std::end(SUPPORTED_RESOLUTIONS));
+    }
+    void VideoDevice::getHDRCapabilities(int* capabilities)
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        *capabilities = dsHDRSTANDARD_HDR10 | dsHDRSTANDARD_HLG;
+    }
+
+    Host& Host::getInstance()
+    {
+        static Host host;
+        return host;
+    }
+    VideoOutputPort& Host::getVideoOutputPort(const std::string& name)
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        platform.Video(name);
+        return platform.Intern(platform.videoPortObjects, name);
+    }
+    List<VideoOutputPort> Host::getVideoOutputPorts()
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        List<VideoOutputPort> ports;
+        std::lock_guard<std::mutex> guard(platform.lock);
+        for (const auto& port : platform.videoPorts)
+            ports.push_back(VideoOutputPort(port.first));
+        return ports;
+    }
+    AudioOutputPort& Host::getAudioOutputPort(const std::string& name)
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        platform.Audio(name);
+        return platform.Intern(platform.audioPortObjects, name);
+    }
+    List<AudioOutputPort> Host::getAudioOutputPorts()
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        List<AudioOutputPort> ports;
+        std::lock_guard<std::mutex> guard(platform.lock);
+        for (const auto& port : platform.audioPorts)
+            ports.push_back(AudioOutputPort(port.first));
+        return ports;
+    }
+    List<VideoDevice> Host::getVideoDevices()
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        return List<VideoDevice>(platform.videoDevices);
+    }
+    void Host::getHostEDID(std::vector<uint8_t>& edid)
+    {
+        Platform& platform = Platform::Instance();
+        platform.Enter();
+        edid.assign(128, 0);
+    }
+
+    VideoOutputPortConfig& VideoOutputPortConfig::getInstance()
+    {
+        static VideoOutputPortConfig config;
+        return config;
+    }
+    const VideoOutputPortType& VideoOutputPortConfig::getPortType(int id)
+    {
+        Platform& platform = Platform::Instance();
+        std::lock_guard<std::mutex> guard(platform.lock);
+        std::unique_ptr<VideoOutputPortType>& type = platform.portTypeObjects[id];
+        if (!type)
+            type.reset(new VideoOutputPortType(id));
+        return *type;
+    }
+    VideoOutputPort& VideoOutputPortConfig::getPort(const std::string& name)
+    {
+        return Host::getInstance().getVideoOutputPort(name);
+    }
+
+    void Manager::Initialize()
+    {
+    }
+    void Manager::DeInitialize()
+    {
+    }
+
+} // namespace device
+
+IARM_Result_t IARM_Bus_Init(const char*)
+{
+    return IARM_RESULT_SUCCESS;
+}
+IARM_Result_t IARM_Bus_Connect()
+{
+    return IARM_RESULT_SUCCESS;
+}
+IARM_Result_t IARM_Bus_Disconnect()
+{
+    return IARM_RESULT_SUCCESS;
+}
+IARM_Result_t IARM_Bus_Term()
+{
+    return IARM_RESULT_SUCCESS;
+}
+IARM_Result_t IARM_Bus_RegisterEventHandler(const char* owner, IARM_EventId_t event, IARM_EventHandler_t handler)
+{
+    Bus& bus = Bus::Instance();
+    std::lock_guard<std::mutex> guard(bus.lock);
+    bus.handlers[std::make_pair(std::string(owner), event)] = handler;
+    return IARM_RESULT_SUCCESS;
+}
+IARM_Result_t IARM_Bus_UnRegisterEventHandler(const char* owner, IARM_EventId_t event)
+{
+    Bus& bus = Bus::Instance();
+    std::lock_guard<std::mutex> guard(bus.lock);
+    bus.handlers.erase(std::make_pair(std::string(owner), event));
+    return IARM_RESULT_SUCCESS;
+}
+IARM_Result_t IARM_Bus_RegisterCall(const char* method, IARM_BusCall_t call)
+{
+    Bus& bus = Bus::Instance();
+    std::lock_guard<std::mutex> guard(bus.lock);
+    bus.calls[method] = call;
+    return IARM_RESULT_SUCCESS;
+}
+IARM_Result_t IARM_Bus_Call(const char* owner, const char* method, void* argument, size_t)
+{
+    if (strcmp(owner, IARM_BUS_PWRMGR_NAME) != 0)
+        return IARM_RESULT_INVALID_PARAM;
+    IARM_Bus_PWRMgr_StandbyVideoState_Param_t* param = (IARM_Bus_PWRMgr_StandbyVideoState_Param_t*)argument;
+    Platform& platform = Platform::Instance();
+    std::lock_guard<std::mutex> guard(platform.lock);
+    auto port = platform.videoPorts.find(param->port);
+    param->result = (port == platform.videoPorts.end()) ? -1 : 0;
+    if (port == platform.videoPorts.end())
+        return IARM_RESULT_SUCCESS;
+    if (strcmp(method, IARM_BUS_PWRMGR_API_SetStandbyVideoState) == 0)
+        port->second.standbyEnabled = (param->isEnabled != 0);
+    else if (strcmp(method, IARM_BUS_PWRMGR_API_GetStandbyVideoState) == 0)
+        param->isEnabled = port->second.standbyEnabled ? 1 : 0;
+    else
+        return IARM_RESULT_INVALID_PARAM;
+    return IARM_RESULT_SUCCESS;
+}
+
+namespace WPEFramework {
+    namespace Trace {
+
+        namespace {
+            std::mutex traceLock;
+            TraceSink traceSink;
+        }
+
+        void SetTraceSink(const TraceSink& sink)
+        {
+            std::lock_guard<std::mutex> guard(traceLock);
+            traceSink = sink;
+        }
+        void Emit(const char* category, const char* text)
+        {
+            std::lock_guard<std::mutex> guard(traceLock);
+            if (traceSink)
+                traceSink(category, text);
+        }
+
+    } // namespace Trace
+} // namespace WPEFramework
@@ -0,0 +1,49 @@
+#pragma once
+
+// Control side of the fake DS HAL and IARM bus the plugin runs against in the tests.
+// Reset() brings back the default platform: video port HDMI0 with a connected sink at 720p,
+// audio ports HDMI0 and SPDIF0, one decoder. IARM events and calls are delivered on a bus thread
+// of their own, like the real bus does.
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "libIBus.h"
+
+namespace FakeHal {
+
+    void Reset();
+
+    void SetConnected(const std::string& port, bool connected);
+    //changes the port resolution without the pre/post change calls a HAL setResolution makes
+    void SetResolution(const std::string& port, const std::string& resolution);
+    void SetEdid(const std::string& port, const std::vector<uint8_t>& edid);
+    void SetTvResolutions(const std::string& port, int resolutions);
+    void SetHdrCapabilities(const std::string& port, int capabilities);
+    void SetSurroundMode(const std::string& port, int surroundMode);
+    //every HAL call sleeps this long first
+    void SetLatency(std::chrono::milliseconds latency);
+
+    std::string Resolution(const std::string& port);
+    std::string StereoMode(const std::string& port);
+    std::string Zoom();
+    uint32_t Calls();
+
+    //queues an event for the handlers registered on owner/event
+    void PostEvent(const char* owner, IARM_EventId_t event, const void* data, size_t length);
+    //queues a call of a method registered with IARM_Bus_RegisterCall
+    void PostCall(const char* method, const void* argument, size_t length);
+    //returns once everything queued so far has been delivered
+    void Drain();
+    //delivers on the bus thread after everything queued so far and waits for the handler; returns how long
+    //the handler ran, or a negative duration when nothing is registered for the event or call
+    std::chrono::nanoseconds DeliverEvent(const char* owner, IARM_EventId_t event, const void* data, size_t length);
+    std::chrono::nanoseconds DeliverCall(const char* method, const void* argument, size_t length);
+    size_t Handlers(const char* owner, IARM_EventId_t event);
+
+    //width is derived from the height of the resolution name, 16:9
+    void ResolutionSize(const std::string& resolution, int& width, int& height);
+
+} // namespace FakeHal
@@ -0,0 +1,597 @@
+#include "FakeThunder.h"
+
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+    void quote(const string& value, string& text)
+    {
+        text += '"';
+        for (char c : value)
+        {
+            switch (c)
+            {
+            case '"': text += "\\\""; break;
+            case '\\': text += "\\\\"; break;
+            case '\n': text += "\\n"; break;
+            case '\r': text += "\\r"; break;
+            case '\t': text += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20)
+                {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned)(unsigned char)c);
+                    text += escaped;
+                }
+                else
+                {
+                    text += c;
+                }
+            }
+        }
+        text += '"';
+    }
+
+    std::mutex sinkLock;
+    WPEFramework::Core::JSONRPC::Handler::NotificationSink notificationSink;
+
+} // namespace
+
+// Recursive descent over the JSON text, fills a JsonValue
+class JsonParser {
+public:
+    JsonParser(const string& text)
+        : m_text(text)
+        , m_position(0)
+    {
+    }
+
+    bool Parse(JsonValue& value)
+    {
+        if (!ParseValue(value))
+            return false;
+        SkipSpace();
+        return m_position == m_text.size();
+    }
+
+private:
+    void SkipSpace()
+    {
+        while (m_position < m_text.size() && strchr(" \t\r\n", m_text[m_position]) != nullptr)
+            m_position++;
+    }
+    bool Expect(char c)
+    {
+        SkipSpace();
+        if (m_position >= m_text.size() || m_text[m_position] != c)
+            return false;
+        m_position++;
+        return true;
+    }
+    bool Literal(const char* word)
+    {
+        size_t length = strlen(word);
+        if (m_text.compare(m_position, length, word) != 0)
+            return false;
+        m_position += length;
+        return true;
+    }
+    bool ParseString(string& value)
+    {
+        if (!Expect('"'))
+            return false;
+        value.clear();
+        while (m_position < m_text.size())
+        {
+            char c = m_text[m_position++];
+            if (c == '"')
+                return true;
+            if (c != '\\')
+            {
+                value += c;
+                continue;
+            }
+            if (m_position >= m_text.size())
+                return false;
+            c = m_text[m_position++];
+            switch (c)
+            {
+            case 'n': value += '\n'; break;
+            case 'r': value += '\r'; break;
+            case 't': value += '\t'; break;
+            case 'b': value += '\b'; break;
+            case 'f': value += '\f'; break;
+            case 'u':
+                {
+                    if (m_position + 4 > m_text.size())
+                        return false;
+                    unsigned long code = strtoul(m_text.substr(m_position, 4).c_str(), nullptr, 16);
+                    m_position += 4;
+                    //only the ASCII range is ever escaped by the plugin
+                    value += (char)(code & 0x7f);
+                }
+                break;
+            default: value += c; break;
+            }
+        }
+        return false;
+    }
+    bool ParseValue(JsonValue& value)
+    {
+        SkipSpace();
+        if (m_position >= m_text.size())
+            return false;
+        value = JsonValue();
+        const char c = m_text[m_position];
+        if (c == '{')
+        {
+            m_position++;
+            value.m_type = JsonValue::type::OBJECT;
+            if (Expect('}'))
+                return true;
+            do
+            {
+                string label;
+                JsonValue member;
+                if (!ParseString(label) || !Expect(':') || !ParseValue(member))
+                    return false;
+                value.m_members.emplace_back(label, member);
+            } while (Expect(','));
+            return Expect('}');
+        }
+        if (c == '[')
+        {
+            m_position++;
+            value.m_type = JsonValue::type::ARRAY;
+            if (Expect(']'))
+                return true;
+            do
+            {
+                JsonValue item;
+                if (!ParseValue(item))
+                    return false;
+                value.m_items.push_back(item);
+            } while (Expect(','));
+            return Expect(']');
+        }
+        if (c == '"')
+        {
+            value.m_type = JsonValue::type::STRING;
+            return ParseString(value.m_text);
+        }
+        if (Literal("true"))
+        {
+            value = JsonValue(true);
+            return true;
+        }
+        if (Literal("false"))
+        {
+            value = JsonValue(false);
+            return true;
+        }
+        if (Literal("null"))
+            return true;
+        const size_t start = m_position;
+        while (m_position < m_text.size() && strchr("+-0123456789.eE", m_text[m_position]) != nullptr)
+            m_position++;
+        if (m_position == start)
+            return false;
+        value.m_type = JsonValue::type::NUMBER;
+        value.m_text = m_text.substr(start, m_position - start);
+        return true;
+    }
+
+    const string& m_text;
+    size_t m_position;
+};
+
+JsonValue::JsonValue() : m_type(type::EMPTY), m_text(), m_items(), m_members() {}
+JsonValue::JsonValue(const string& value) : m_type(type::STRING), m_text(value), m_items(), m_members() {}
+JsonValue::JsonValue(const char* value) : m_type(type::STRING), m_text(value ? value : ""), m_items(), m_members() {}
+JsonValue::JsonValue(bool value) : m_type(type::BOOLEAN), m_text(value ? "true" : "false"), m_items(), m_members() {}
+JsonValue::JsonValue(int value) : m_type(type::NUMBER), m_text(std::to_string(value)), m_items(), m_members() {}
+JsonValue::JsonValue(unsigned int value) : m_type(type::NUMBER), m_text(std::to_string(value)), m_items(), m_members() {}
+JsonValue::JsonValue(long value) : m_type(type::NUMBER), m_text(std::to_string(value)), m_items(), m_members() {}
+JsonValue::JsonValue(unsigned long value) : m_type(type::NUMBER), m_text(std::to_string(value)), m_items(), m_members() {}
+JsonValue::JsonValue(long long value) : m_type(type::NUMBER), m_text(std::to_string(value)), m_items(), m_members() {}
+JsonValue::JsonValue(unsigned long long value) : m_type(type::NUMBER), m_text(std::to_string(value)), m_items(), m_members() {}
+JsonValue::JsonValue(double value) : m_type(type::NUMBER), m_text(), m_items(), m_members()
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%.17g", value);
+    m_text = text;
+}
+JsonValue::JsonValue(const JsonArray& value) : m_type(type::ARRAY), m_text(), m_items(value.m_items), m_members() {}
+JsonValue::JsonValue(const JsonObject& value) : m_type(type::OBJECT), m_text(), m_items(), m_members(value.m_members) {}
+
+const char* JsonValue::String() const
+{
+    if (m_type == type::ARRAY || m_type == type::OBJECT)
+    {
+        string text;
+        ToString(text);
+        m_text = text;
+    }
+    return m_text.c_str();
+}
+bool JsonValue::Boolean() const
+{
+    return m_text == "true";
+}
+int64_t JsonValue::Number() const
+{
+    if (m_type == type::NUMBER && m_text.find_first_of(".eE") != string::npos)
+        return (int64_t)strtod(m_text.c_str(), nullptr);
+    return (int64_t)strtoll(m_text.c_str(), nullptr, 10);
+}
+double JsonValue::Float() const
+{
+    return strtod(m_text.c_str(), nullptr);
+}
+JsonArray JsonValue::Array() const
+{
+    JsonArray array;
+    if (m_type == type::ARRAY)
+        array.m_items = m_items;
+    return array;
+}
+JsonObject JsonValue::Object() const
+{
+    JsonObject object;
+    if (m_type == type::OBJECT)
+        object.m_members = m_members;
+    return object;
+}
+void JsonValue::ToString(string& text) const
+{
+    switch (m_type)
+    {
+    case type::EMPTY:
+        text += "null";
+        break;
+    case type::BOOLEAN:
+    case type::NUMBER:
+        text += m_text;
+        break;
+    case type::STRING:
+        quote(m_text, text);
+        break;
+    case type::ARRAY:
+        text += '[';
+        for (size_t i = 0; i < m_items.size(); i++)
+        {
+            if (i)
+                text += ',';
+            m_items[i].ToString(text);
+        }
+        text += ']';
+        break;
+    case type::OBJECT:
+        text += '{';
+        {
+            bool first = true;
+            for (const auto& member : m_members)
+            {
+                //unset members are left out, like Thunder's
+                if (!member.second.IsSet())
+                    continue;
+                if (!first)
+                    text += ',';
+                first = false;
+                quote(member.first, text);
+                text += ':';
+                member.second.ToString(text);
+            }
+        }
+        text += '}';
+        break;
+    }
+}
+
+const JsonValue& JsonArray::operator[](uint32_t index) const
+{
+    static const JsonValue empty;
+    return index < m_items.size() ? m_items[index] : empty;
+}
+JsonValue& JsonArray::operator[](uint32_t index)
+{
+    if (index >= m_items.size())
+        m_items.resize(index + 1);
+    return m_items[index];
+}
+void JsonArray::ToString(string& text) const
+{
+    text.clear();
+    JsonValue(*this).ToString(text);
+}
+bool JsonArray::FromString(const string& text)
+{
+    JsonValue value;
+    if (!JsonParser(text).Parse(value) || value.Content() != JsonValue::type::ARRAY)
+        return false;
+    m_items = value.m_items;
+    return true;
+}
+
+JsonValue& JsonObject::operator[](const char* label)
+{
+    for (auto& member : m_members)
+    {
+        if (member.first == label)
+            return member.second;
+    }
+    m_members.emplace_back(label, JsonValue());
+    return m_members.back().second;
+}
+const JsonValue& JsonObject::operator[](const char* label) const
+{
+    static const JsonValue empty;
+    for (const auto& member : m_members)
+    {
+        if (member.first == label)
+            return member.second;
+    }
+    return empty;
+}
+bool JsonObject::HasLabel(const char* label) const
+{
+    for (const auto& member : m_members)
+    {
+        if (member.first == label)
+            return true;
+    }
+    return false;
+}
+void JsonObject::Remove(const char* label)
+{
+    for (auto it = m_members.begin(); it != m_members.end(); ++it)
+    {
+        if (it->first == label)
+        {
+            m_members.erase(it);
+            return;
+        }
+    }
+}
+void JsonObject::ToString(string& text) const
+{
+    text.clear();
+    JsonValue(*this).ToString(text);
+}
+bool JsonObject::FromString(const string& text)
+{
+    JsonValue value;
+    if (!JsonParser(text).Parse(value) || value.Content() != JsonValue::type::OBJECT)
+        return false;
+    m_members = value.m_members;
+    return true;
+}
+
+namespace WPEFramework {
+
+    namespace Core {
+
+        void ToString(const uint8_t object[], const uint16_t length, const bool padding, string& result)
+        {
+            static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            result.clear();
+            uint16_t index = 0;
+            while (index + 2 < length)
+            {
+                const uint32_t triple = (uint32_t)object[index] << 16 | (uint32_t)object[index + 1] << 8 | object[index + 2];
+                result += alphabet[(triple >> 18) & 0x3f];
+                result += alphabet[(triple >> 12) & 0x3f];
+                result += alphabet[(triple >> 6) & 0x3f];
+                result += alphabet[triple & 0x3f];
+                index += 3;
+            }
+            if (index < length)
+            {
+                const bool two = (index + 1 < length);
+                const uint32_t triple = (uint32_t)object[index] << 16 | (two ? (uint32_t)object[index + 1] << 8 : 0);
+                result += alphabet[(triple >> 18) & 0x3f];
+                result += alphabet[(triple >> 12) & 0x3f];
+                if (two)
+                    result += alphabet[(triple >> 6) & 0x3f];
+                if (padding)
+                    result += two ? "=" : "==";
+            }
+        }
+
+        namespace JSONRPC {
+
+            Handler::Handler(uint8_t version)
+                : m_version(version)
+                , m_lock()
+                , m_methods()
+                , m_subscribers()
+            {
+            }
+            void Handler::Register(const string& methodName, const CallbackFunction& callback)
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_methods[methodName] = std::make_shared<CallbackFunction>(callback);
+            }
+            void Handler::Unregister(const string& methodName)
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_methods.erase(methodName);
+            }
+            bool Handler::Exists(const string& methodName) const
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                return m_methods.count(methodName) != 0;
+            }
+            uint32_t Handler::Invoke(const Context& context, const string& method, const string& parameters, string& result)
+            {
+                std::shared_ptr<CallbackFunction> callback;
+                {
+                    std::lock_guard<std::mutex> guard(m_lock);
+                    auto it = m_methods.find(method);
+                    if (it == m_methods.end())
+                        return Core::ERROR_UNKNOWN_KEY;
+                    callback = it->second;
+                }
+                return (*callback)(context, method, parameters, result);
+            }
+            void Handler::Subscribe(uint32_t channel, const string& event, const string& designator)
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_subscribers[event].push_back(Subscriber{ channel, designator });
+            }
+            void Handler::Unsubscribe(uint32_t channel, const string& event, const string& designator)
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                auto it = m_subscribers.find(event);
+                if (it == m_subscribers.end())
+                    return;
+                it->second.remove_if([channel, &designator](const Subscriber& subscriber) {
+                    return subscriber.channel == channel && subscriber.designator == designator;
+                });
+            }
+            uint32_t Handler::Notify(const string& event) const
+            {
+                return Notify(event, JsonObject());
+            }
+            uint32_t Handler::Notify(const string& event, const JsonObject& parameters) const
+            {
+                return Notify(event, parameters, [](const string&) { return true; });
+            }
+            uint32_t Handler::Notify(const string& event, const JsonObject& parameters, const std::function<bool(const string& designator)>& sendif) const
+            {
+                std::list<Subscriber> subscribers;
+                {
+                    std::lock_guard<std::mutex> guard(m_lock);
+                    auto it = m_subscribers.find(event);
+                    if (it == m_subscribers.end())
+                        return Core::ERROR_NONE;
+                    subscribers = it->second;
+                }
+                NotificationSink sink;
+                {
+                    std::lock_guard<std::mutex> guard(sinkLock);
+                    sink = notificationSink;
+                }
+                string text;
+                parameters.ToString(text);
+                for (const Subscriber& subscriber : subscribers)
+                {
+                    if (sink && sendif(subscriber.designator))
+                        sink(subscriber.channel, subscriber.designator, event, text);
+                }
+                return Core::ERROR_NONE;
+            }
+            void Handler::SetNotificationSink(const NotificationSink& sink)
+            {
+                std::lock_guard<std::mutex> guard(sinkLock);
+                notificationSink = sink;
+            }
+
+        } // namespace JSONRPC
+    } // namespace Core
+
+    namespace RPC {
+
+        StringIterator::StringIterator(const std::list<string>& container)
+            : m_items(container.begin(), container.end())
+            , m_index(0)
+        {
+        }
+        bool StringIterator::Next(string& info)
+        {
+            if (m_index <= m_items.size())
+                m_index++;
+            if (!IsValid())
+                return false;
+            info = m_items[m_index - 1];
+            return true;
+        }
+        bool StringIterator::Previous(string& info)
+        {
+            if (m_index > 0)
+                m_index--;
+            if (!IsValid())
+                return false;
+            info = m_items[m_index - 1];
+            return true;
+        }
+        void StringIterator::Reset(const uint32_t position)
+        {
+            m_index = (position <= m_items.size()) ? position : (uint32_t)m_items.size() + 1;
+        }
+        bool StringIterator::IsValid() const
+        {
+            return m_index > 0 && m_index <= m_items.size();
+        }
+        uint32_t StringIterator::Count() const
+        {
+            return (uint32_t)m_items.size();
+        }
+        string StringIterator::Current() const
+        {
+            return IsValid() ? m_items[m_index - 1] : string();
+        }
+
+    } // namespace RPC
+
+    namespace PluginHost {
+
+        JSONRPC::JSONRPC()
+            : JSONRPC({ 1 })
+        {
+        }
+        JSONRPC::JSONRPC(const std::vector<uint8_t>& versions)
+            : m_handlers()
+        {
+            for (uint8_t version : versions)
+                m_handlers.emplace_back(new Core::JSONRPC::Handler(version));
+        }
+        JSONRPC::JSONRPC(std::initializer_list<uint8_t> versions)
+            : JSONRPC(std::vector<uint8_t>(versions))
+        {
+        }
+        JSONRPC::~JSONRPC()
+        {
+        }
+        Core::JSONRPC::Handler* JSONRPC::GetHandler(uint8_t version)
+        {
+            for (const auto& handler : m_handlers)
+            {
+                if (handler->Version() == version)
+                    return handler.get();
+            }
+            return nullptr;
+        }
+        uint32_t JSONRPC::Invoke(const Core::JSONRPC::Context& context, uint8_t version, const string& method, const string& parameters, string& result)
+        {
+            Core::JSONRPC::Handler* handler = GetHandler(version);
+            return (handler == nullptr) ? (uint32_t)Core::ERROR_UNKNOWN_KEY : handler->Invoke(context, method, parameters, result);
+        }
+        uint32_t JSONRPC::Subscribe(uint32_t channel, uint8_t version, const string& event, const string& designator)
+        {
+            Core::JSONRPC::Handler* handler = GetHandler(version);
+            if (handler == nullptr)
+                return Core::ERROR_UNKNOWN_KEY;
+            handler->Subscribe(channel, event, designator);
+            return Core::ERROR_NONE;
+        }
+        uint32_t JSONRPC::Unsubscribe(uint32_t channel, uint8_t version, const string& event, const string& designator)
+        {
+            Core::JSONRPC::Handler* handler = GetHandler(version);
+            if (handler == nullptr)
+                return Core::ERROR_UNKNOWN_KEY;
+            handler->Unsubscribe(channel, event, designator);
+            return Core::ERROR_NONE;
+        }
+        uint32_t JSONRPC::Notify(const string& event)
+        {
+            return Notify(event, JsonObject());
+        }
+        uint32_t JSONRPC::Notify(const string& event, const JsonObject& parameters)
+        {
+            return m_handlers.empty() ? (uint32_t)Core::ERROR_NONE : m_handlers.front()->Notify(event, parameters);
+        }
+
+    } // namespace PluginHost
+} // namespace WPEFramework
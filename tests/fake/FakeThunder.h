@@ -0,0 +1,393 @@
+#pragma once
+
+// Functional stand-in for the parts of the Thunder core, JSON-RPC and plugin host API the plugin
+// uses, so its sources build and run in the tests without a Thunder install. The JSON types keep
+// real values and round trip through text; the JSON-RPC handlers dispatch registered methods and
+// deliver notifications to the subscribers of an event through the sink a test installs with
+// Core::JSONRPC::Handler::SetNotificationSink. Only what the plugin and the tests need is here.
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::string;
+
+#define EXTERNAL
+#ifndef TCHAR
+#define TCHAR char
+#endif
+#ifndef _T
+#define _T(x) x
+#endif
+#define MODULE_NAME_DECLARATION(x)
+#define SERVICE_REGISTRATION(ACTUALCLASS, MAJOR, MINOR)
+
+#define BEGIN_INTERFACE_MAP(ACTUALCLASS)                                            \
+    void* QueryInterface(const uint32_t interfaceNumber) override                   \
+    {                                                                               \
+        if (interfaceNumber == WPEFramework::Core::IUnknown::ID) {                  \
+            AddRef();                                                               \
+            return static_cast<WPEFramework::Core::IUnknown*>(this);                \
+        }
+#define INTERFACE_ENTRY(TYPE)                                                       \
+        if (interfaceNumber == TYPE::ID) {                                          \
+            AddRef();                                                               \
+            return static_cast<TYPE*>(this);                                        \
+        }
+#define END_INTERFACE_MAP                                                           \
+        return nullptr;                                                             \
+    }
+
+class JsonArray;
+class JsonObject;
+
+// Core::JSON::Variant: a scalar keeps its text, so String() of a number or a boolean is its JSON text
+class JsonValue {
+public:
+    enum class type { EMPTY, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+    JsonValue();
+    JsonValue(const string& value);
+    JsonValue(const char* value);
+    JsonValue(bool value);
+    JsonValue(int value);
+    JsonValue(unsigned int value);
+    JsonValue(long value);
+    JsonValue(unsigned long value);
+    JsonValue(long long value);
+    JsonValue(unsigned long long value);
+    JsonValue(double value);
+    JsonValue(const JsonArray& value);
+    JsonValue(const JsonObject& value);
+
+    type Content() const { return m_type; }
+    bool IsSet() const { return m_type != type::EMPTY; }
+    bool IsNull() const { return m_type == type::EMPTY; }
+
+    const char* String() const;
+    bool Boolean() const;
+    int64_t Number() const;
+    double Float() const;
+    JsonArray Array() const;
+    JsonObject Object() const;
+
+    void ToString(string& text) const;
+
+private:
+    friend class JsonArray;
+    friend class JsonObject;
+    friend class JsonParser;
+
+    type m_type;
+    mutable string m_text;      // scalar value, or the serialized container for String()
+    std::vector<JsonValue> m_items;
+    std::vector<std::pair<string, JsonValue>> m_members;
+};
+
+class JsonArray {
+public:
+    JsonArray() : m_items() {}
+
+    void Add(const JsonValue& value) { m_items.push_back(value); }
+    uint32_t Length() const { return (uint32_t)m_items.size(); }
+    const JsonValue& operator[](uint32_t index) const;
+    JsonValue& operator[](uint32_t index);
+    void Clear() { m_items.clear(); }
+
+    void ToString(string& text) const;
+    bool FromString(const string& text);
+
+private:
+    friend class JsonValue;
+    std::vector<JsonValue> m_items;
+};
+
+class JsonObject {
+public:
+    class Iterator {
+    public:
+        Iterator(const std::vector<std::pair<string, JsonValue>>& members) : m_members(&members), m_index(-1) {}
+        bool Next() { return ++m_index < (int)m_members->size(); }
+        const char* Label() const { return (*m_members)[m_index].first.c_str(); }
+        const JsonValue& Current() const { return (*m_members)[m_index].second; }
+    private:
+        const std::vector<std::pair<string, JsonValue>>* m_members;
+        int m_index;
+    };
+
+    JsonObject() : m_members() {}
+
+    JsonValue& operator[](const char* label);
+    //an empty value when label is not there, like Thunder's
+    const JsonValue& operator[](const char* label) const;
+    bool HasLabel(const char* label) const;
+    void Remove(const char* label);
+    void Clear() { m_members.clear(); }
+    Iterator Variants() const { return Iterator(m_members); }
+
+    void ToString(string& text) const;
+    bool FromString(const string& text);
+
+private:
+    friend class JsonValue;
+    std::vector<std::pair<string, JsonValue>> m_members;
+};
+
+namespace WPEFramework {
+
+    namespace Core {
+
+        enum {
+            ERROR_NONE = 0,
+            ERROR_GENERAL = 1,
+            ERROR_UNAVAILABLE = 2,
+            ERROR_ILLEGAL_STATE = 5,
+            ERROR_INVALID_INPUT_LENGTH = 6,
+            ERROR_ALREADY_CONNECTED = 7,
+            ERROR_NOT_SUPPORTED = 8,
+            ERROR_TIMEDOUT = 11,
+            ERROR_UNKNOWN_KEY = 22,
+            ERROR_BAD_REQUEST = 30
+        };
+
+        struct EXTERNAL IUnknown {
+            enum { ID = 0 };
+            virtual ~IUnknown() {}
+            virtual void AddRef() const = 0;
+            virtual uint32_t Release() const = 0;
+            virtual void* QueryInterface(const uint32_t interfaceNumber) = 0;
+        };
+
+        // Reference counting for a class that implements interfaces; deleted on the last Release()
+        template<typename ACTUALSERVICE>
+        class Service : public ACTUALSERVICE {
+        public:
+            template<typename... ARGS>
+            Service(ARGS&&... args)
+                : ACTUALSERVICE(std::forward<ARGS>(args)...)
+                , m_refCount(1)
+            {
+            }
+            template<typename INTERFACE, typename... ARGS>
+            static INTERFACE* Create(ARGS&&... args)
+            {
+                return static_cast<INTERFACE*>(new Service<ACTUALSERVICE>(std::forward<ARGS>(args)...));
+            }
+            void AddRef() const override
+            {
+                m_refCount.fetch_add(1);
+            }
+            uint32_t Release() const override
+            {
+                if (m_refCount.fetch_sub(1) == 1)
+                {
+                    delete this;
+                    return 1;   // Core::ERROR_DESTRUCTION_SUCCEEDED
+                }
+                return 0;
+            }
+        private:
+            mutable std::atomic<uint32_t> m_refCount;
+        };
+
+        //base64, the text without padding when padding is false
+        void ToString(const uint8_t object[], const uint16_t length, const bool padding, string& result);
+
+        namespace JSON {
+            class String {
+            public:
+                String() : m_value() {}
+                const string& Value() const { return m_value; }
+            private:
+                string m_value;
+            };
+            class Boolean {
+            public:
+                Boolean() : m_value(false) {}
+                bool Value() const { return m_value; }
+            private:
+                bool m_value;
+            };
+            template<typename ELEMENT>
+            class ArrayType {
+            };
+        } // namespace JSON
+
+        namespace JSONRPC {
+
+            class Context {
+            public:
+                Context(uint32_t channelId, uint32_t sequence, const string& token)
+                    : m_channelId(channelId)
+                    , m_sequence(sequence)
+                    , m_token(token)
+                {
+                }
+                uint32_t ChannelId() const { return m_channelId; }
+                uint32_t Sequence() const { return m_sequence; }
+                const string& Token() const { return m_token; }
+            private:
+                uint32_t m_channelId;
+                uint32_t m_sequence;
+                string m_token;
+            };
+
+            // The methods and event subscriptions of one interface version
+            class Handler {
+            public:
+                typedef std::function<uint32_t(const Context& context, const string& method, const string& parameters, string& result)> CallbackFunction;
+                //receives every notification sent to a subscriber: its channel, the designator it subscribed with, the event and the parameters
+                typedef std::function<void(uint32_t channel, const string& designator, const string& event, const string& parameters)> NotificationSink;
+
+                Handler(uint8_t version);
+                Handler(const Handler&) = delete;
+                Handler& operator=(const Handler&) = delete;
+
+                uint8_t Version() const { return m_version; }
+
+                template<typename PARAMETER, typename RESPONSE, typename REALOBJECT>
+                void Register(const string& methodName, uint32_t (REALOBJECT::*method)(const PARAMETER&, RESPONSE&), REALOBJECT* objectPtr)
+                {
+                    Register(methodName, [method, objectPtr](const Context&, const string&, const string& parameters, string& result) -> uint32_t {
+                        PARAMETER request;
+                        if (!parameters.empty() && !request.FromString(parameters))
+                            return Core::ERROR_BAD_REQUEST;
+                        RESPONSE response;
+                        uint32_t code = (objectPtr->*method)(request, response);
+                        response.ToString(result);
+                        return code;
+                    });
+                }
+                void Register(const string& methodName, const CallbackFunction& callback);
+                void Unregister(const string& methodName);
+                bool Exists(const string& methodName) const;
+
+                // Core::ERROR_UNKNOWN_KEY for a method that is not registered
+                uint32_t Invoke(const Context& context, const string& method, const string& parameters, string& result);
+
+                void Subscribe(uint32_t channel, const string& event, const string& designator);
+                void Unsubscribe(uint32_t channel, const string& event, const string& designator);
+
+                uint32_t Notify(const string& event) const;
+                uint32_t Notify(const string& event, const JsonObject& parameters) const;
+                //only to the subscribers for which sendif(designator) is true
+                uint32_t Notify(const string& event, const JsonObject& parameters, const std::function<bool(const string& designator)>& sendif) const;
+
+                static void SetNotificationSink(const NotificationSink& sink);
+
+            private:
+                struct Subscriber {
+                    uint32_t channel;
+                    string designator;
+                };
+
+                const uint8_t m_version;
+                mutable std::mutex m_lock;
+                std::map<string, std::shared_ptr<CallbackFunction>> m_methods;
+                std::map<string, std::list<Subscriber>> m_subscribers;
+            };
+
+        } // namespace JSONRPC
+    } // namespace Core
+
+    namespace RPC {
+
+        enum { ID_EXTERNAL_INTERFACE_OFFSET = 0x80000000 };
+
+        struct EXTERNAL IStringIterator : virtual public Core::IUnknown {
+            enum { ID = 0x00000060 };
+            virtual bool Next(string& info) = 0;
+            virtual bool Previous(string& info) = 0;
+            virtual void Reset(const uint32_t position) = 0;
+            virtual bool IsValid() const = 0;
+            virtual uint32_t Count() const = 0;
+            virtual string Current() const = 0;
+        };
+
+        // Abstract like Thunder's, create it through Core::Service<RPC::StringIterator>
+        class StringIterator : public IStringIterator {
+        public:
+            StringIterator(const std::list<string>& container);
+
+            bool Next(string& info) override;
+            bool Previous(string& info) override;
+            void Reset(const uint32_t position) override;
+            bool IsValid() const override;
+            uint32_t Count() const override;
+            string Current() const override;
+
+            BEGIN_INTERFACE_MAP(StringIterator)
+            INTERFACE_ENTRY(RPC::IStringIterator)
+            END_INTERFACE_MAP
+
+        private:
+            std::vector<string> m_items;
+            uint32_t m_index;   // 0 is before the first item
+        };
+
+    } // namespace RPC
+
+    namespace PluginHost {
+
+        struct EXTERNAL IShell {
+            virtual ~IShell() {}
+            virtual string ConfigLine() const { return string("{}"); }
+            virtual string Callsign() const { return string("org.rdk.DisplaySettings"); }
+            virtual string DataPath() const { return string(); }
+            virtual string PersistentPath() const { return string(); }
+        };
+
+        struct EXTERNAL IPlugin : virtual public Core::IUnknown {
+            enum { ID = 0x00000020 };
+            virtual const string Initialize(IShell* service) = 0;
+            virtual void Deinitialize(IShell* service) = 0;
+            virtual string Information() const = 0;
+        };
+
+        struct EXTERNAL IDispatcher : virtual public Core::IUnknown {
+            enum { ID = 0x00000021 };
+            // "method" or "event" of interface version; Core::ERROR_UNKNOWN_KEY for a version the plugin does not serve
+            virtual uint32_t Invoke(const Core::JSONRPC::Context& context, uint8_t version, const string& method, const string& parameters, string& result) = 0;
+            virtual uint32_t Subscribe(uint32_t channel, uint8_t version, const string& event, const string& designator) = 0;
+            virtual uint32_t Unsubscribe(uint32_t channel, uint8_t version, const string& event, const string& designator) = 0;
+        };
+
+        // One Core::JSONRPC::Handler per interface version
+        class JSONRPC : public IDispatcher {
+        public:
+            JSONRPC();
+            JSONRPC(const std::vector<uint8_t>& versions);
+            JSONRPC(std::initializer_list<uint8_t> versions);
+            ~JSONRPC() override;
+            JSONRPC(const JSONRPC&) = delete;
+            JSONRPC& operator=(const JSONRPC&) = delete;
+
+            Core::JSONRPC::Handler* GetHandler(uint8_t version);
+
+            uint32_t Invoke(const Core::JSONRPC::Context& context, uint8_t version, const string& method, const string& parameters, string& result) override;
+            uint32_t Subscribe(uint32_t channel, uint8_t version, const string& event, const string& designator) override;
+            uint32_t Unsubscribe(uint32_t channel, uint8_t version, const string& event, const string& designator) override;
+
+            //to the subscribers of the first interface version
+            uint32_t Notify(const string& event);
+            uint32_t Notify(const string& event, const JsonObject& parameters);
+
+        private:
+            std::vector<std::unique_ptr<Core::JSONRPC::Handler>> m_handlers;
+        };
+
+    } // namespace PluginHost
+} // namespace WPEFramework
+
+using namespace WPEFramework;
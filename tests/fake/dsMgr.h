@@ -0,0 +1,8 @@
+#pragma once
+#define IARM_BUS_DSMGR_NAME "DSMgr"
+#define IARM_BUS_COMMON_API_ResolutionPreChange "ResolutionPreChange"
+#define IARM_BUS_COMMON_API_ResolutionPostChange "ResolutionPostChange"
+typedef enum { IARM_BUS_DSMGR_EVENT_RES_PRECHANGE=0, IARM_BUS_DSMGR_EVENT_RES_POSTCHANGE, IARM_BUS_DSMGR_EVENT_ZOOM_SETTINGS, IARM_BUS_DSMGR_EVENT_HDMI_HOTPLUG, IARM_BUS_DSMGR_EVENT_HDMI_IN_HOTPLUG, IARM_BUS_DSMGR_EVENT_AUDIO_MODE, IARM_BUS_DSMGR_EVENT_HDCP_STATUS, IARM_BUS_DSMGR_EVENT_RX_SENSE } IARM_Bus_DSMgr_EventId_t;
+typedef enum { dsHDMI_IN_PORT_NONE=-1, dsHDMI_IN_PORT_0, dsHDMI_IN_PORT_1, dsHDMI_IN_PORT_2, dsHDMI_IN_PORT_MAX } dsHdmiInPort_t;
+typedef struct { union { struct { int width; int height; } resn; struct { int zoomsettings; } dfc; struct { int type; int mode; } Audioport; struct { int event; } hdmi_hpd; struct { int hdcpStatus; } hdmi_hdcp; struct { int status; } hdmi_rxsense; struct { dsHdmiInPort_t port; bool isPortConnected; } hdmi_in_connect; } data; } IARM_Bus_DSMgr_EventData_t;
+typedef struct { int width; int height; } IARM_Bus_CommonAPI_ResChange_Param_t;
@@ -0,0 +1,7 @@
+#pragma once
+enum { dsTV_RESOLUTION_480i=1, dsTV_RESOLUTION_480p=2, dsTV_RESOLUTION_576i=4, dsTV_RESOLUTION_576p=8, dsTV_RESOLUTION_720p=16, dsTV_RESOLUTION_1080i=32, dsTV_RESOLUTION_1080p=64, dsTV_RESOLUTION_2160p30=128, dsTV_RESOLUTION_2160p60=256 };
+enum { dsHDRSTANDARD_NONE=0, dsHDRSTANDARD_HDR10=1, dsHDRSTANDARD_HLG=2, dsHDRSTANDARD_DolbyVision=4, dsHDRSTANDARD_TechnicolorPrime=8 };
+enum { dsSURROUNDMODE_NONE=0, dsSURROUNDMODE_DD=1, dsSURROUNDMODE_DDPLUS=2 };
+enum { dsVIDEO_ZOOM_UNKNOWN=-1, dsVIDEO_ZOOM_NONE=0, dsVIDEO_ZOOM_FULL=1 };
+enum { dsDISPLAY_RXSENSE_OFF=0, dsDISPLAY_RXSENSE_ON=1 };
+typedef enum { dsHDCP_STATUS_UNPOWERED=0, dsHDCP_STATUS_UNAUTHENTICATED, dsHDCP_STATUS_AUTHENTICATED, dsHDCP_STATUS_AUTHENTICATIONFAILURE, dsHDCP_STATUS_INPROGRESS, dsHDCP_STATUS_PORTDISABLED, dsHDCP_STATUS_MAX } dsHdcpStatus_t;
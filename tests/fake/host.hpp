@@ -0,0 +1,194 @@
+#pragma once
+
+// Functional stand-in for the device settings (DS) client classes: every object is a handle by name
+// onto the platform state kept by FakeHal, so the plugin sees connects, resolution changes and HAL
+// latency the way a test scripts them.
+
+#include <cstdint>
+#include <exception>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dsTypes.h"
+
+namespace device {
+
+    class Exception : public std::exception {
+    public:
+        Exception(int code = 0, const char* message = "No Message for this exception") throw()
+            : m_code(code)
+            , m_message(message)
+        {
+        }
+        Exception(const char* message) throw()
+            : m_code(0)
+            , m_message(message)
+        {
+        }
+        virtual ~Exception() throw() {}
+        int getCode() const { return m_code; }
+        const char* what() const throw() override { return m_message.c_str(); }
+
+    private:
+        int m_code;
+        std::string m_message;
+    };
+
+    // The plugin binds references to elements of a returned List, so a List shares its storage
+    // and Host keeps the storage of the lists it hands out alive
+    template <typename T>
+    class List {
+    public:
+        List() : m_items(std::make_shared<std::vector<T>>()) {}
+        explicit List(const std::shared_ptr<std::vector<T>>& items) : m_items(items) {}
+        size_t size() const { return m_items->size(); }
+        T& at(size_t index) { return m_items->at(index); }
+        const T& at(size_t index) const { return m_items->at(index); }
+        void push_back(const T& item) { m_items->push_back(item); }
+
+    private:
+        std::shared_ptr<std::vector<T>> m_items;
+    };
+
+    class VideoResolution {
+    public:
+        explicit VideoResolution(const std::string& name = std::string()) : m_name(name) {}
+        const std::string& getName() const { return m_name; }
+
+    private:
+        std::string m_name;
+    };
+
+    class Display {
+    public:
+        explicit Display(const std::string& port = std::string()) : m_port(port) {}
+        void getEDIDBytes(std::vector<uint8_t>& edid);
+        int getSurroundMode();
+
+    private:
+        std::string m_port;
+    };
+
+    class AudioStereoMode {
+    public:
+        static const int kMono = 1;
+        static const int kStereo = 2;
+        static const int kSurround = 3;
+        static const int kPassThru = 4;
+
+        AudioStereoMode(int id = kStereo);
+        bool operator==(int id) const { return m_id == id; }
+        bool operator==(const AudioStereoMode& other) const { return m_id == other.m_id; }
+        const std::string& toString() const { return m_name; }
+        const std::string& getName() const { return m_name; }
+        int getId() const { return m_id; }
+
+    private:
+        int m_id;
+        std::string m_name;
+    };
+
+    class AudioOutputPortType {
+    public:
+        static const int kHDMI = 1;
+        static const int kSPDIF = 2;
+
+        explicit AudioOutputPortType(int id = kHDMI) : m_id(id) {}
+        int getId() const { return m_id; }
+
+    private:
+        int m_id;
+    };
+
+    class AudioOutputPort {
+    public:
+        explicit AudioOutputPort(const std::string& name = std::string());
+        const std::string& getName() const { return m_name; }
+        bool isConnected();
+        const List<AudioStereoMode> getSupportedStereoModes() const;
+        AudioStereoMode getStereoMode(bool persist = false);
+        void setStereoMode(const std::string& mode);
+        void setStereoMode(int mode);
+        void setStereoAuto(bool enable);
+        bool getStereoAuto();
+        const AudioOutputPortType& getType() const { return m_type; }
+
+    private:
+        std::string m_name;
+        AudioOutputPortType m_type;
+    };
+
+    class VideoOutputPortType {
+    public:
+        explicit VideoOutputPortType(int id = 0) : m_id(id) {}
+        int getId() const { return m_id; }
+        const List<VideoResolution> getSupportedResolutions() const;
+
+    private:
+        int m_id;
+    };
+
+    class VideoOutputPort {
+    public:
+        explicit VideoOutputPort(const std::string& name = std::string());
+        const std::string& getName() const { return m_name; }
+        const VideoOutputPortType& getType() const { return m_type; }
+        const VideoResolution& getResolution();
+        void setResolution(const std::string& resolution);
+        bool isDisplayConnected();
+        bool isActive();
+        Display& getDisplay() { return m_display; }
+        void getSupportedTvResolutions(int* resolutions);
+        void getTVHDRCapabilities(int* capabilities);
+        AudioOutputPort& getAudioOutputPort();
+
+    private:
+        std::string m_name;
+        VideoOutputPortType m_type;
+        Display m_display;
+    };
+
+    class DFC {
+    public:
+        explicit DFC(const std::string& name = std::string()) : m_name(name) {}
+        const std::string& getName() const { return m_name; }
+
+    private:
+        std::string m_name;
+    };
+
+    class VideoDevice {
+    public:
+        const DFC& getDFC();
+        void setDFC(const std::string& name);
+        void getSettopSupportedResolutions(std::list<std::string>& resolutions);
+        void getHDRCapabilities(int* capabilities);
+    };
+
+    class Host {
+    public:
+        static Host& getInstance();
+        VideoOutputPort& getVideoOutputPort(const std::string& name);
+        List<VideoOutputPort> getVideoOutputPorts();
+        AudioOutputPort& getAudioOutputPort(const std::string& name);
+        List<AudioOutputPort> getAudioOutputPorts();
+        List<VideoDevice> getVideoDevices();
+        void getHostEDID(std::vector<uint8_t>& edid);
+    };
+
+    class VideoOutputPortConfig {
+    public:
+        static VideoOutputPortConfig& getInstance();
+        const VideoOutputPortType& getPortType(int id);
+        VideoOutputPort& getPort(const std::string& name);
+    };
+
+    class Manager {
+    public:
+        static void Initialize();
+        static void DeInitialize();
+    };
+
+} // namespace device
@@ -0,0 +1,11 @@
+#pragma once
+#include <cstddef>
+typedef enum { IARM_RESULT_SUCCESS, IARM_RESULT_INVALID_PARAM, IARM_RESULT_INVALID_STATE, IARM_RESULT_IPCCORE_FAIL, IARM_RESULT_OOM } IARM_Result_t;
+typedef int IARM_EventId_t;
+typedef void (*IARM_EventHandler_t)(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
+typedef IARM_Result_t (*IARM_BusCall_t)(void *arg);
+IARM_Result_t IARM_Bus_Init(const char*); IARM_Result_t IARM_Bus_Connect(); IARM_Result_t IARM_Bus_Disconnect(); IARM_Result_t IARM_Bus_Term();
+IARM_Result_t IARM_Bus_RegisterEventHandler(const char*, IARM_EventId_t, IARM_EventHandler_t);
+IARM_Result_t IARM_Bus_UnRegisterEventHandler(const char*, IARM_EventId_t);
+IARM_Result_t IARM_Bus_RegisterCall(const char*, IARM_BusCall_t);
+IARM_Result_t IARM_Bus_Call(const char*, const char*, void*, size_t);
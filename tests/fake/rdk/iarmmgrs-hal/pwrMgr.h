@@ -0,0 +1,11 @@
+#pragma once
+#define IARM_BUS_PWRMGR_NAME "PWRMgr"
+#define IARM_BUS_PWRMGR_API_SetStandbyVideoState "SetStandbyVideoState"
+#define IARM_BUS_PWRMGR_API_GetStandbyVideoState "GetStandbyVideoState"
+#define IARM_BUS_PWRMGR_API_GetPowerState "GetPowerState"
+#define PWRMGR_MAX_VIDEO_PORT_NAME_LENGTH 16
+typedef enum { IARM_BUS_PWRMGR_POWERSTATE_OFF, IARM_BUS_PWRMGR_POWERSTATE_STANDBY, IARM_BUS_PWRMGR_POWERSTATE_ON, IARM_BUS_PWRMGR_POWERSTATE_STANDBY_LIGHT_SLEEP, IARM_BUS_PWRMGR_POWERSTATE_STANDBY_DEEP_SLEEP } IARM_Bus_PWRMgr_PowerState_t;
+typedef enum { IARM_BUS_PWRMGR_EVENT_MODECHANGED = 0 } IARM_Bus_PWRMgr_EventId_t;
+typedef struct { union { struct { IARM_Bus_PWRMgr_PowerState_t curState; IARM_Bus_PWRMgr_PowerState_t newState; } state; } data; } IARM_Bus_PWRMgr_EventData_t;
+typedef struct { IARM_Bus_PWRMgr_PowerState_t curState; } IARM_Bus_PWRMgr_GetPowerState_Param_t;
+typedef struct { char port[PWRMGR_MAX_VIDEO_PORT_NAME_LENGTH]; int isEnabled; int result; } IARM_Bus_PWRMgr_StandbyVideoState_Param_t;
@@ -0,0 +1,54 @@
+#pragma once
+
+// Thunder tracing as the plugin uses it: every category starts disabled, a test enables one with
+// Trace::TraceType<CATEGORY, void>::Enable(true) and reads what was emitted through SetTraceSink.
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+#include "../FakeThunder.h"
+
+namespace WPEFramework {
+    namespace Trace {
+
+        inline void Format(std::string& text, const TCHAR formatter[], va_list ap)
+        {
+            char buffer[1024];
+            vsnprintf(buffer, sizeof(buffer), formatter, ap);
+            text = buffer;
+        }
+
+        typedef std::function<void(const char* category, const char* text)> TraceSink;
+        void SetTraceSink(const TraceSink& sink);
+        void Emit(const char* category, const char* text);
+
+        template <typename CATEGORY, typename MODULE>
+        class TraceType {
+        public:
+            static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+            static void Enable(bool enable) { s_enabled = enable; }
+
+        private:
+            static std::atomic<bool> s_enabled;
+        };
+
+        template <typename CATEGORY, typename MODULE>
+        std::atomic<bool> TraceType<CATEGORY, MODULE>::s_enabled(false);
+
+    } // namespace Trace
+} // namespace WPEFramework
+
+#define TRACE_GLOBAL(CATEGORY, PARAMETERS)                                           \
+    do {                                                                             \
+        if (WPEFramework::Trace::TraceType<CATEGORY, void>::IsEnabled()) {           \
+            CATEGORY __data__ PARAMETERS;                                            \
+            WPEFramework::Trace::Emit(#CATEGORY, __data__.Data());                   \
+        }                                                                            \
+    } while (0)
+
+#define TRACE(CATEGORY, PARAMETERS) TRACE_GLOBAL(CATEGORY, PARAMETERS)
+//the fake has no module name to key the switches on
+#define DS_TRACE_TYPE(CATEGORY) WPEFramework::Trace::TraceType<CATEGORY, void>
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include "Base64.h"
+
+#include <string>
+#include <vector>
+
+using WPEFramework::Plugin::Base64Encoder;
+
+namespace {
+
+    std::string reference(const std::vector<uint8_t>& data, bool padding)
+    {
+        static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string text;
+        size_t i = 0;
+        for (; i + 2 < data.size(); i += 3)
+        {
+            const uint32_t triple = data[i] << 16 | data[i + 1] << 8 | data[i + 2];
+            for (int shift = 18; shift >= 0; shift -= 6)
+                text += alphabet[(triple >> shift) & 0x3f];
+        }
+        if (i < data.size())
+        {
+            const bool two = (i + 1 < data.size());
+            const uint32_t triple = data[i] << 16 | (two ? data[i + 1] << 8 : 0);
+            text += alphabet[(triple >> 18) & 0x3f];
+            text += alphabet[(triple >> 12) & 0x3f];
+            if (two)
+                text += alphabet[(triple >> 6) & 0x3f];
+            if (padding)
+                text += two ? "=" : "==";
+        }
+        return text;
+    }
+
+    std::vector<uint8_t> pattern(size_t length)
+    {
+        std::vector<uint8_t> data(length);
+        for (size_t i = 0; i < length; i++)
+            data[i] = (uint8_t)(i * 131 + 7);
+        return data;
+    }
+
+} // namespace
+
+TEST(Base64, KnownVectors)
+{
+    std::string text;
+    const uint8_t foobar[] = { 'f', 'o', 'o', 'b', 'a', 'r' };
+    Base64Encoder::Encode(foobar, 0, true, text);
+    EXPECT_EQ("", text);
+    Base64Encoder::Encode(foobar, 1, true, text);
+    EXPECT_EQ("Zg==", text);
+    Base64Encoder::Encode(foobar, 2, true, text);
+    EXPECT_EQ("Zm8=", text);
+    Base64Encoder::Encode(foobar, 2, false, text);
+    EXPECT_EQ("Zm8", text);
+    Base64Encoder::Encode(foobar, 6, true, text);
+    EXPECT_EQ("Zm9vYmFy", text);
+}
+
+// every length around the vector step sizes, EDID sizes included
+TEST(Base64, MatchesReferenceForAllLengths)
+{
+    for (size_t length = 0; length <= 520; length++)
+    {
+        const std::vector<uint8_t> data = pattern(length);
+        for (int padding = 0; padding < 2; padding++)
+        {
+            std::string text;
+            Base64Encoder::Encode(data.data(), data.size(), padding != 0, text);
+            ASSERT_EQ(reference(data, padding != 0), text) << "length " << length;
+            EXPECT_EQ(text.size(), Base64Encoder::EncodedLength(length, padding != 0));
+        }
+    }
+}
+
+TEST(Base64, ChunkedUpdateMatchesOneShot)
+{
+    const std::vector<uint8_t> data = pattern(256);
+    for (size_t chunk = 1; chunk <= 50; chunk++)
+    {
+        std::string text;
+        Base64Encoder encoder(text, true);
+        for (size_t offset = 0; offset < data.size(); offset += chunk)
+            encoder.Update(data.data() + offset, std::min(chunk, data.size() - offset));
+        encoder.Finish();
+        ASSERT_EQ(reference(data, true), text) << "chunk " << chunk;
+    }
+}
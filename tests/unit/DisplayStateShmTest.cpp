@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include "DisplayStatePublisher.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace WPEFramework::Plugin;
+
+namespace {
+
+    //every field derives from k, so a torn copy shows up as fields that disagree
+    DisplayStateShm::DisplayState stateOf(uint32_t k)
+    {
+        DisplayStateShm::DisplayState state;
+        memset(&state, 0, sizeof(state));
+        state.portCount = k;
+        state.primaryHdmi = k;
+        for (int i = 0; i < DisplayStateShm::MAX_PORTS; i++)
+        {
+            snprintf(state.ports[i].name, sizeof(state.ports[i].name), "%u", k);
+            snprintf(state.ports[i].resolution, sizeof(state.ports[i].resolution), "%u", k);
+        }
+        state.edidHash = k;
+        state.tvHdrCapabilities = (int32_t)k;
+        state.tvResolutions = (int32_t)k;
+        state.settopHdrCapabilities = (int32_t)k;
+        state.decoderCount = k;
+        for (int i = 0; i < DisplayStateShm::MAX_DECODERS; i++)
+            state.decoderHdrCapabilities[i] = (int32_t)k;
+        return state;
+    }
+
+    bool consistent(const DisplayStateShm::DisplayState& state)
+    {
+        const DisplayStateShm::DisplayState expected = stateOf(state.portCount);
+        return memcmp(&state, &expected, sizeof(state)) == 0;
+    }
+
+} // namespace
+
+TEST(DisplayStateShm, PublishAndRead)
+{
+    DisplayStatePublisher publisher;
+    ASSERT_TRUE(publisher.Open());
+    const DisplayStateShm::Segment* segment = DisplayStateShm::Map();
+    ASSERT_NE(nullptr, segment);
+
+    EXPECT_TRUE(publisher.Publish(stateOf(1)));
+    const uint32_t generation = DisplayStateShm::Generation(segment);
+    //an identical state leaves the generation alone
+    EXPECT_FALSE(publisher.Publish(stateOf(1)));
+    EXPECT_EQ(generation, DisplayStateShm::Generation(segment));
+
+    DisplayStateShm::DisplayState state;
+    uint32_t readGeneration = 0;
+    ASSERT_TRUE(DisplayStateShm::Read(segment, state, readGeneration));
+    EXPECT_EQ(generation, readGeneration);
+    EXPECT_EQ(1u, state.portCount);
+
+    publisher.Close();
+    //stale once the plugin stopped
+    EXPECT_FALSE(DisplayStateShm::Read(segment, state, readGeneration));
+    DisplayStateShm::Unmap(segment);
+}
+
+TEST(DisplayStateShm, ReadersNeverSeeATornState)
+{
+    DisplayStatePublisher publisher;
+    ASSERT_TRUE(publisher.Open());
+    publisher.Publish(stateOf(1));
+    const DisplayStateShm::Segment* segment = DisplayStateShm::Map();
+    ASSERT_NE(nullptr, segment);
+
+    std::atomic<bool> stop(false);
+    std::thread writer([&]() {
+        for (uint32_t k = 2; !stop; k++)
+            publisher.Publish(stateOf(k));
+    });
+
+    const int READERS = 4;
+    std::atomic<int> torn(0);
+    std::atomic<int> reads(0);
+    std::thread readers[READERS];
+    for (std::thread& reader : readers)
+    {
+        reader = std::thread([&]() {
+            uint32_t lastGeneration = 0;
+            uint32_t lastK = 0;
+            for (int i = 0; i < 20000; i++)
+            {
+                DisplayStateShm::DisplayState state;
+                uint32_t generation = 0;
+                if (!DisplayStateShm::Read(segment, state, generation))
+                    continue;
+                reads++;
+                if (!consistent(state) || generation < lastGeneration || state.portCount < lastK)
+                    torn++;
+                lastGeneration = generation;
+                lastK = state.portCount;
+            }
+        });
+    }
+    for (std::thread& reader : readers)
+        reader.join();
+    stop = true;
+    writer.join();
+
+    EXPECT_EQ(0, torn.load());
+    EXPECT_GT(reads.load(), 0);
+    publisher.Close();
+    DisplayStateShm::Unmap(segment);
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include "HalExecutor.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using WPEFramework::Plugin::HalExecutor;
+
+namespace {
+
+    //a HAL call that blocks until released
+    class Gate {
+    public:
+        Gate()
+            : m_lock()
+            , m_signal()
+            , m_open(false)
+        {
+        }
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_signal.wait(lock, [this]() { return m_open; });
+        }
+        void Open()
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_open = true;
+            m_signal.notify_all();
+        }
+
+    private:
+        std::mutex m_lock;
+        std::condition_variable m_signal;
+        bool m_open;
+    };
+
+    HalExecutor::Result run(HalExecutor& executor, const std::function<void()>& job, uint32_t deadlineMs)
+    {
+        std::exception_ptr error;
+        return executor.Run(job, deadlineMs, error);
+    }
+
+} // namespace
+
+TEST(HalExecutor, LateSuccessLeavesTheBreakerOpen)
+{
+    HalExecutor executor(4, 8, 2, 60000);
+    executor.Start();
+    Gate slow;
+    Gate stuck;
+    //admitted while closed, answers only after the breaker opened
+    std::thread late([&]() { EXPECT_EQ(HalExecutor::SUCCESS, run(executor, [&]() { slow.Wait(); }, 5000)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(HalExecutor::TIMEOUT, run(executor, [&]() { stuck.Wait(); }, 10));
+    EXPECT_EQ(HalExecutor::TIMEOUT, run(executor, [&]() { stuck.Wait(); }, 10));
+    EXPECT_EQ(HalExecutor::OPEN, executor.GetStats().state);
+    slow.Open();
+    late.join();
+    EXPECT_EQ(HalExecutor::OPEN, executor.GetStats().state);
+    EXPECT_EQ(HalExecutor::CIRCUIT_OPEN, run(executor, []() {}, 100));
+    stuck.Open();
+    executor.Stop();
+}
+
+TEST(HalExecutor, ProbeDecidesAfterCooldown)
+{
+    HalExecutor executor(2, 4, 1, 20);
+    executor.Start();
+    Gate stuck;
+    EXPECT_EQ(HalExecutor::TIMEOUT, run(executor, [&]() { stuck.Wait(); }, 10));
+    EXPECT_EQ(HalExecutor::OPEN, executor.GetStats().state);
+    stuck.Open();
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    EXPECT_EQ(HalExecutor::SUCCESS, run(executor, []() {}, 1000));
+    EXPECT_EQ(HalExecutor::CLOSED, executor.GetStats().state);
+    executor.Stop();
+}
+
+TEST(HalExecutor, StoppedProbeIsReleased)
+{
+    HalExecutor executor(1, 4, 1, 0);
+    executor.Start();
+    Gate stuck;
+    EXPECT_EQ(HalExecutor::TIMEOUT, run(executor, [&]() { stuck.Wait(); }, 10));
+    //the only worker is stuck, the probe waits behind it until Stop()
+    std::thread probe([&]() { EXPECT_EQ(HalExecutor::STOPPED, run(executor, []() {}, 5000)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(HalExecutor::HALF_OPEN, executor.GetStats().state);
+    std::thread stopper([&]() { executor.Stop(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    probe.join();
+    stuck.Open();
+    stopper.join();
+    //restarted, the breaker admits a new probe instead of waiting for the abandoned one
+    executor.Start();
+    EXPECT_EQ(HalExecutor::SUCCESS, run(executor, []() {}, 1000));
+    EXPECT_EQ(HalExecutor::CLOSED, executor.GetStats().state);
+    executor.Stop();
+}
+
+TEST(HalExecutor, StopDoesNotWaitForAStuckWorker)
+{
+    HalExecutor executor(2, 4, 3, 1000);
+    executor.Start();
+    static Gate stuck;
+    EXPECT_EQ(HalExecutor::TIMEOUT, run(executor, []() { stuck.Wait(); }, 10));
+    const auto start = std::chrono::steady_clock::now();
+    executor.Stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(HalExecutor::STOP_GRACE_MS + 500));
+    //the detached worker returns and exits on its own
+    stuck.Open();
+}
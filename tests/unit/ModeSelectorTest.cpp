@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include "ModeSelector.h"
+#include "dsTypes.h"
+
+#include <string>
+
+using WPEFramework::Plugin::ModeSelector;
+
+TEST(ModeSelector, Parse)
+{
+    ModeSelector::Mode mode;
+    ASSERT_TRUE(ModeSelector::Parse("1080p60", mode));
+    EXPECT_EQ(1080u, mode.height);
+    EXPECT_EQ(60u, mode.frameRate);
+    EXPECT_TRUE(mode.progressive);
+
+    ASSERT_TRUE(ModeSelector::Parse("576i", mode));
+    EXPECT_EQ(50u, mode.frameRate);
+    EXPECT_FALSE(mode.progressive);
+
+    ASSERT_TRUE(ModeSelector::Parse("720p", mode));
+    EXPECT_EQ(60u, mode.frameRate);
+
+    EXPECT_FALSE(ModeSelector::Parse("", mode));
+    EXPECT_FALSE(ModeSelector::Parse("p60", mode));
+    EXPECT_FALSE(ModeSelector::Parse("1080x", mode));
+    EXPECT_FALSE(ModeSelector::Parse("1080p60Hz", mode));
+}
+
+TEST(ModeSelector, TvResolutionBit)
+{
+    ModeSelector::Mode mode;
+    ModeSelector::Parse("2160p30", mode);
+    EXPECT_EQ(dsTV_RESOLUTION_2160p30, ModeSelector::TvResolutionBit(mode));
+    ModeSelector::Parse("2160p60", mode);
+    EXPECT_EQ(dsTV_RESOLUTION_2160p60, ModeSelector::TvResolutionBit(mode));
+    ModeSelector::Parse("1080i", mode);
+    EXPECT_EQ(dsTV_RESOLUTION_1080i, ModeSelector::TvResolutionBit(mode));
+    ModeSelector::Parse("720i", mode);
+    EXPECT_EQ(0, ModeSelector::TvResolutionBit(mode));
+}
+
+TEST(ModeSelector, PicksHighestTheTvSupports)
+{
+    const std::string names[] = { "480p", "720p", "1080i", "1080p60", "2160p60" };
+    ModeSelector::Policy policy;
+    size_t candidates = 0;
+    EXPECT_EQ(3u, ModeSelector::Select(names, 5, dsTV_RESOLUTION_720p | dsTV_RESOLUTION_1080p, policy, candidates));
+    EXPECT_EQ(2u, candidates);
+    //no TV mask: the settop list alone
+    EXPECT_EQ(4u, ModeSelector::Select(names, 5, 0, policy, candidates));
+    EXPECT_EQ(5u, candidates);
+}
+
+TEST(ModeSelector, Policy)
+{
+    const std::string names[] = { "1080i", "1080p24", "1080p60", "2160p30" };
+    ModeSelector::Policy policy;
+    size_t candidates = 0;
+
+    policy.maxHeight = 1080;
+    policy.frameRate = 24;
+    EXPECT_EQ(1u, ModeSelector::Select(names, 4, 0, policy, candidates));
+
+    policy.frameRate = 60;
+    EXPECT_EQ(2u, ModeSelector::Select(names, 4, 0, policy, candidates));
+
+    const std::string interlaced[] = { "480i", "1080i" };
+    policy.progressiveOnly = true;
+    EXPECT_EQ((size_t)ModeSelector::NONE, ModeSelector::Select(interlaced, 2, 0, policy, candidates));
+    EXPECT_EQ(0u, candidates);
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include "FixedList.h"
+#include "RequestArena.h"
+
+#include <string>
+#include <vector>
+
+using WPEFramework::Plugin::ArenaAllocator;
+using WPEFramework::Plugin::FixedList;
+using WPEFramework::Plugin::RequestArena;
+
+namespace {
+
+    typedef std::vector<uint8_t, ArenaAllocator<uint8_t>> Bytes;
+
+} // namespace
+
+TEST(FixedList, KeepsItemsPastCapacity)
+{
+    FixedList<std::string, 4> list;
+    for (int i = 0; i < 4; i++)
+        list.push_back(std::to_string(i));
+    EXPECT_FALSE(list.spilled());
+    for (int i = 4; i < 11; i++)
+        list.push_back(std::to_string(i));
+    EXPECT_TRUE(list.spilled());
+    ASSERT_EQ(11u, list.size());
+    int expected = 0;
+    for (const std::string& item : list)
+        EXPECT_EQ(std::to_string(expected++), item);
+    EXPECT_EQ("10", list.at(10));
+    EXPECT_THROW(list.at(11), std::out_of_range);
+
+    list.clear();
+    EXPECT_TRUE(list.empty());
+    EXPECT_FALSE(list.spilled());
+    list.push_back("a");
+    EXPECT_EQ("a", list[0]);
+}
+
+TEST(RequestArena, ScopeTakesMemoryBack)
+{
+    const uint64_t spills = RequestArena::Spills();
+    const uint8_t* first = nullptr;
+    {
+        RequestArena::Scope scope;
+        Bytes bytes(256, 0x5a);
+        first = bytes.data();
+    }
+    {
+        RequestArena::Scope scope;
+        Bytes bytes(256, 0xa5);
+        //the same bytes again, the first scope gave them back
+        EXPECT_EQ(first, bytes.data());
+        {
+            RequestArena::Scope inner;
+            Bytes nested(128, 0);
+            EXPECT_NE(first, nested.data());
+        }
+        EXPECT_EQ(0xa5, bytes[255]);
+    }
+    EXPECT_EQ(spills, RequestArena::Spills());
+}
+
+TEST(RequestArena, SpillsToTheHeap)
+{
+    const uint64_t spills = RequestArena::Spills();
+    {
+        //no scope open, nothing to count
+        Bytes bytes(64, 1);
+        EXPECT_EQ(1, bytes[63]);
+    }
+    EXPECT_EQ(spills, RequestArena::Spills());
+    {
+        RequestArena::Scope scope;
+        Bytes bytes(RequestArena::SIZE + 1, 2);
+        EXPECT_EQ(2, bytes[RequestArena::SIZE]);
+    }
+    EXPECT_EQ(spills + 1, RequestArena::Spills());
+}
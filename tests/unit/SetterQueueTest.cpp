@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include "SetterQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using WPEFramework::Plugin::SetterQueue;
+
+TEST(SetterQueue, AppliesAloneRequest)
+{
+    SetterQueue queue;
+    int applied = 0;
+    EXPECT_EQ(SetterQueue::APPLIED, queue.Apply("setResolution", "HDMI0", [&applied]() { applied++; }));
+    EXPECT_EQ(1, applied);
+    EXPECT_EQ(1u, queue.GetCounters()["setResolution"].applied);
+}
+
+TEST(SetterQueue, ExceptionReleasesTheSlot)
+{
+    SetterQueue queue;
+    EXPECT_THROW(queue.Apply("setZoomSetting", "0", []() { throw 1; }), int);
+    EXPECT_EQ(SetterQueue::APPLIED, queue.Apply("setZoomSetting", "0", []() {}));
+}
+
+// While one change is applied, of the requests that arrive meanwhile only the last one runs
+TEST(SetterQueue, LastWriterWins)
+{
+    SetterQueue queue;
+    std::mutex lock;
+    std::condition_variable changed;
+    bool started = false;
+    bool release = false;
+    std::vector<int> applied;
+
+    std::thread first([&]() {
+        queue.Apply("setSoundMode", "HDMI0", [&]() {
+            std::unique_lock<std::mutex> guard(lock);
+            started = true;
+            changed.notify_all();
+            changed.wait(guard, [&release]() { return release; });
+            applied.push_back(0);
+        });
+    });
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        changed.wait(guard, [&started]() { return started; });
+    }
+
+    const int WRITERS = 8;
+    std::atomic<int> coalesced(0);
+    std::vector<std::thread> writers;
+    for (int i = 1; i <= WRITERS; i++)
+    {
+        writers.emplace_back([&, i]() {
+            if (queue.Apply("setSoundMode", "HDMI0", [&, i]() {
+                    std::lock_guard<std::mutex> guard(lock);
+                    applied.push_back(i);
+                }) == SetterQueue::COALESCED)
+                coalesced++;
+        });
+        //each writer is queued before the next one starts, so the order of arrival is known
+        while (queue.GetCounters()["setSoundMode"].coalesced != (uint64_t)(i - 1))
+            std::this_thread::yield();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        release = true;
+        changed.notify_all();
+    }
+    first.join();
+    for (std::thread& writer : writers)
+        writer.join();
+
+    ASSERT_EQ(2u, applied.size());
+    EXPECT_EQ(0, applied[0]);
+    EXPECT_EQ(WRITERS, applied[1]);
+    EXPECT_EQ(WRITERS - 1, coalesced.load());
+}
+
+TEST(SetterQueue, SlotsAreIndependentPerPort)
+{
+    SetterQueue queue;
+    std::atomic<bool> inner(false);
+    queue.Apply("setResolution", "HDMI0", [&]() {
+        //a different port does not wait for HDMI0
+        EXPECT_EQ(SetterQueue::APPLIED, queue.Apply("setResolution", "HDMI1", [&]() { inner = true; }));
+    });
+    EXPECT_TRUE(inner);
+}
+
+TEST(SetterQueue, NoLimitAdmitsEverything)
+{
+    SetterQueue queue;
+    for (int i = 0; i < 1000; i++)
+        EXPECT_TRUE(queue.Admit("setResolution", "1"));
+}
+
+TEST(SetterQueue, RateLimitRejectsOverBurst)
+{
+    SetterQueue queue;
+    queue.SetLimit(5);
+    int admitted = 0;
+    for (int i = 0; i < 20; i++)
+        admitted += queue.Admit("setResolution", "1") ? 1 : 0;
+    EXPECT_EQ(5, admitted);
+    EXPECT_EQ(15u, queue.GetCounters()["setResolution"].rejected);
+    //another client has a bucket of its own
+    EXPECT_TRUE(queue.Admit("setResolution", "2"));
+}
+
+TEST(SetterQueue, BucketRefills)
+{
+    SetterQueue queue;
+    queue.SetLimit(100);
+    while (queue.Admit("setZoomSetting", "1"))
+        ;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_TRUE(queue.Admit("setZoomSetting", "1"));
+}
+
+TEST(SetterQueue, ZeroLimitRemovesIt)
+{
+    SetterQueue queue;
+    queue.SetLimit(1);
+    EXPECT_TRUE(queue.Admit("setSoundMode", "1"));
+    EXPECT_FALSE(queue.Admit("setSoundMode", "1"));
+    queue.SetLimit(0);
+    EXPECT_EQ(0u, queue.Limit());
+    EXPECT_TRUE(queue.Admit("setSoundMode", "1"));
+}
+
+// At most MAX_BUCKETS clients are tracked, a new one replaces the one least recently heard from
+TEST(SetterQueue, BucketsAreBounded)
+{
+    SetterQueue queue;
+    queue.SetLimit(1);
+    EXPECT_TRUE(queue.Admit("setResolution", "busy"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    for (size_t i = 0; i < SetterQueue::MAX_BUCKETS - 1; i++)
+        EXPECT_TRUE(queue.Admit("setResolution", std::to_string(i)));
+    //full: the next new client replaces the longest quiet one, "busy", which is then new again
+    EXPECT_TRUE(queue.Admit("setResolution", "another"));
+    EXPECT_TRUE(queue.Admit("setResolution", "busy"));
+    //while a client still tracked stays limited
+    EXPECT_FALSE(queue.Admit("setResolution", "another"));
+}
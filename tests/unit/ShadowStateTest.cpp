@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "ShadowState.h"
+
+#include <string>
+
+using WPEFramework::Plugin::ShadowState;
+
+TEST(ShadowState, SetGetInvalidate)
+{
+    ShadowState shadow;
+    std::string value;
+    EXPECT_FALSE(shadow.Get(ShadowState::RESOLUTION, "HDMI0", value));
+    shadow.Set(ShadowState::RESOLUTION, "HDMI0", "1080p60");
+    ASSERT_TRUE(shadow.Get(ShadowState::RESOLUTION, "HDMI0", value));
+    EXPECT_EQ("1080p60", value);
+    //settings do not share entries
+    EXPECT_FALSE(shadow.Get(ShadowState::ZOOM, "HDMI0", value));
+
+    shadow.Invalidate(ShadowState::RESOLUTION);
+    EXPECT_FALSE(shadow.Get(ShadowState::RESOLUTION, "HDMI0", value));
+    const ShadowState::Stats stats = shadow.GetStats();
+    EXPECT_EQ(1u, stats.hits);
+    EXPECT_EQ(3u, stats.misses);
+}
+
+// a slow HAL read does not replace what an event stored while it was in flight
+TEST(ShadowState, FillLosesToNewerSet)
+{
+    ShadowState shadow;
+    const uint64_t generation = shadow.Generation(ShadowState::ZOOM);
+    shadow.Set(ShadowState::ZOOM, "0", "FULL");
+    EXPECT_FALSE(shadow.Fill(ShadowState::ZOOM, "0", "NONE", generation));
+    std::string value;
+    ASSERT_TRUE(shadow.Get(ShadowState::ZOOM, "0", value));
+    EXPECT_EQ("FULL", value);
+}
+
+TEST(ShadowState, FillCountsCorrections)
+{
+    ShadowState shadow;
+    EXPECT_FALSE(shadow.Fill(ShadowState::SOUND_MODE, "HDMI0", "STEREO", shadow.Generation(ShadowState::SOUND_MODE)));
+    EXPECT_FALSE(shadow.Fill(ShadowState::SOUND_MODE, "HDMI0", "STEREO", shadow.Generation(ShadowState::SOUND_MODE)));
+    EXPECT_TRUE(shadow.Fill(ShadowState::SOUND_MODE, "HDMI0", "SURROUND", shadow.Generation(ShadowState::SOUND_MODE)));
+    EXPECT_EQ(1u, shadow.GetStats().corrections);
+}
+
+TEST(ShadowState, RestoreKeepsNewerEntries)
+{
+    ShadowState shadow;
+    shadow.Set(ShadowState::RESOLUTION, "HDMI0", "720p");
+    shadow.Set(ShadowState::RESOLUTION, "HDMI1", "480p");
+    const auto saved = shadow.Entries(ShadowState::RESOLUTION);
+    ASSERT_EQ(2u, saved.size());
+
+    shadow.Clear();
+    shadow.Set(ShadowState::RESOLUTION, "HDMI0", "2160p60");
+    shadow.Restore(ShadowState::RESOLUTION, saved);
+    std::string value;
+    ASSERT_TRUE(shadow.Get(ShadowState::RESOLUTION, "HDMI0", value));
+    EXPECT_EQ("2160p60", value);
+    ASSERT_TRUE(shadow.Get(ShadowState::RESOLUTION, "HDMI1", value));
+    EXPECT_EQ("480p", value);
+}
+
+TEST(ShadowState, KeysPastCapacityAreNotCached)
+{
+    ShadowState shadow;
+    for (int i = 0; i < ShadowState::MAX_KEYS + 8; i++)
+        shadow.Set(ShadowState::ACTIVE_INPUT, "port" + std::to_string(i), "true");
+    std::string value;
+    EXPECT_TRUE(shadow.Get(ShadowState::ACTIVE_INPUT, "port0", value));
+    EXPECT_FALSE(shadow.Get(ShadowState::ACTIVE_INPUT, "port" + std::to_string(ShadowState::MAX_KEYS + 1), value));
+    EXPECT_EQ((size_t)ShadowState::MAX_KEYS, shadow.Entries(ShadowState::ACTIVE_INPUT).size());
+}
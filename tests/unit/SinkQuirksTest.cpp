@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include "SinkQuirks.h"
+
+#include <vector>
+
+namespace SinkQuirks = WPEFramework::Plugin::SinkQuirks;
+
+namespace {
+
+    std::vector<uint8_t> edid(const char* pnp, uint16_t product, uint32_t serial)
+    {
+        std::vector<uint8_t> bytes(128, 0);
+        const uint8_t header[8] = { 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00 };
+        std::copy(header, header + 8, bytes.begin());
+        const uint16_t manufacturer = (uint16_t)((pnp[0] - '@') << 10 | (pnp[1] - '@') << 5 | (pnp[2] - '@'));
+        bytes[8] = (uint8_t)(manufacturer >> 8);
+        bytes[9] = (uint8_t)manufacturer;
+        bytes[10] = (uint8_t)product;
+        bytes[11] = (uint8_t)(product >> 8);
+        for (int i = 0; i < 4; i++)
+            bytes[12 + i] = (uint8_t)(serial >> (8 * i));
+        return bytes;
+    }
+
+    uint32_t resolve(const char* pnp, uint16_t product, uint32_t serial)
+    {
+        SinkQuirks::Id id;
+        EXPECT_TRUE(SinkQuirks::Parse(edid(pnp, product, serial), id));
+        return SinkQuirks::Resolve(id);
+    }
+
+} // namespace
+
+TEST(SinkQuirks, Parse)
+{
+    SinkQuirks::Id id;
+    ASSERT_TRUE(SinkQuirks::Parse(edid("SAM", 0x0f47, 0x01020304), id));
+    EXPECT_EQ(0x0f47, id.product);
+    EXPECT_EQ(0x01020304u, id.serial);
+    char name[4];
+    SinkQuirks::ManufacturerName(id.manufacturer, name);
+    EXPECT_STREQ("SAM", name);
+
+    std::vector<uint8_t> bad = edid("SAM", 1, 1);
+    bad[0] = 0x01;
+    EXPECT_FALSE(SinkQuirks::Parse(bad, id));
+    EXPECT_FALSE(SinkQuirks::Parse(std::vector<uint8_t>(64, 0), id));
+}
+
+TEST(SinkQuirks, Names)
+{
+    EXPECT_STREQ("XRE-7389", SinkQuirks::Name(0));
+    EXPECT_STREQ("DELIA-18552", SinkQuirks::Name(3));
+    EXPECT_STREQ("", SinkQuirks::Name(SinkQuirks::COUNT));
+}
+
+#ifdef DISPLAYSETTINGS_QUIRKS_TABLE
+
+TEST(SinkQuirks, MostSpecificEntryWins)
+{
+    EXPECT_EQ(4u, SinkQuirks::TableSize());
+    EXPECT_EQ((uint32_t)SinkQuirks::DELIA_18552, resolve("SAM", 0x0f47, 1234));
+    EXPECT_EQ((uint32_t)SinkQuirks::XRE_7389, resolve("SAM", 0x0f47, 99));
+    EXPECT_EQ((uint32_t)SinkQuirks::XRE_7389, resolve("SAM", 0x0f47, 0));
+    EXPECT_EQ((uint32_t)SinkQuirks::RDK_16024, resolve("SAM", 0x0001, 1234));
+    //listed with no quirks, and not listed at all
+    EXPECT_EQ(0u, resolve("TST", 0x1234, 1));
+    EXPECT_EQ(0u, resolve("LGD", 0x0001, 1));
+}
+
+#else
+
+TEST(SinkQuirks, WithoutPlatformTableEverySinkGetsAll)
+{
+    EXPECT_EQ(0u, SinkQuirks::TableSize());
+    EXPECT_EQ((uint32_t)SinkQuirks::ALL, resolve("SAM", 0x0f47, 1234));
+    EXPECT_EQ((uint32_t)SinkQuirks::ALL, resolve("LGD", 0x0001, 1));
+}
+
+#endif
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "TraceRing.h"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using WPEFramework::Plugin::TraceRing;
+
+namespace {
+
+    std::string tracePath()
+    {
+        return "/tmp/TraceRingTest." + std::to_string(getpid()) + ".trace";
+    }
+
+} // namespace
+
+TEST(TraceRing, IdsAreStable)
+{
+    const std::string path = tracePath();
+    TraceRing ring;
+    EXPECT_EQ(TraceRing::NO_NAME, ring.Id("closed"));
+    ASSERT_TRUE(ring.Open(path.c_str()));
+    static const char getter[] = "getCurrentResolution";
+    const uint16_t id = ring.Id(getter);
+    EXPECT_NE(TraceRing::NO_NAME, id);
+    EXPECT_EQ(id, ring.Id(getter));
+    //the same name through another pointer and as a runtime string
+    EXPECT_EQ(id, ring.NameId(std::string("getCurrentResolution")));
+    const uint16_t port = ring.NameId("HDMI0");
+    EXPECT_NE(id, port);
+    EXPECT_EQ(port, ring.NameId("HDMI0"));
+    EXPECT_NE(port, ring.NameId("HDMI1"));
+    EXPECT_EQ(TraceRing::NO_NAME, ring.NameId(""));
+
+    //the names are in the file, a reopen keeps their ids
+    ring.Close();
+    ASSERT_TRUE(ring.Open(path.c_str()));
+    EXPECT_EQ(port, ring.NameId("HDMI0"));
+    EXPECT_EQ(id, ring.Id(getter));
+    ring.Close();
+    remove(path.c_str());
+}
+
+TEST(TraceRing, CloseWaitsForWriters)
+{
+    const std::string path = tracePath();
+    TraceRing ring;
+    ASSERT_TRUE(ring.Open(path.c_str()));
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> writers;
+    for (int i = 0; i < 4; i++)
+    {
+        writers.emplace_back([&ring, &stop, i]() {
+            const std::string port = "HDMI" + std::to_string(i);
+            while (!stop)
+                ring.Add(TraceRing::HAL_CALL, ring.Id("getResolution"), ring.NameId(port), TraceRing::Now(), 0, 0, 0);
+        });
+    }
+    for (int round = 0; round < 50; round++)
+    {
+        ring.Close();
+        ASSERT_TRUE(ring.Open(path.c_str()));
+    }
+    ring.Close();
+    stop = true;
+    for (std::thread& writer : writers)
+        writer.join();
+    remove(path.c_str());
+}
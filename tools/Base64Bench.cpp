@@ -0,0 +1,101 @@
+// Compares Base64Encoder (Base64.h) with the encoding readEDID/readHostEDID used before it,
+// Core::ToString, over EDID sized and larger buffers, and checks that both give the same text.
+// Core::ToString is only available when built with -DWITH_THUNDER (and the Thunder core headers
+// and library); otherwise a byte at a time encoder of the same shape stands in for it. Build with:
+//   g++ -std=c++11 -O2 -I. tools/Base64Bench.cpp Base64.cpp -o ds-base64-bench      (add -mssse3 on x86)
+// usage: ds-base64-bench [iterations]
+
+#include "Base64.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifdef WITH_THUNDER
+#include <core/core.h>
+#endif
+
+using WPEFramework::Plugin::Base64Encoder;
+
+namespace {
+
+#ifdef WITH_THUNDER
+    const char* baselineName = "Core::ToString";
+
+    void baseline(const std::vector<uint8_t>& data, std::string& result)
+    {
+        //what readEDID did: the length is a uint16_t, larger buffers are truncated
+        uint16_t size = (uint16_t)std::min(data.size(), (size_t)0xffff);
+        WPEFramework::Core::ToString(data.data(), size, false, result);
+    }
+#else
+    const char* baselineName = "bytewise";
+
+    void baseline(const std::vector<uint8_t>& data, std::string& result)
+    {
+        static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        result.clear();
+        uint32_t bits = 0;
+        int count = 0;
+        for (uint8_t byte : data)
+        {
+            bits = (bits << 8) | byte;
+            count += 8;
+            while (count >= 6)
+            {
+                count -= 6;
+                result += alphabet[(bits >> count) & 0x3f];
+            }
+        }
+        if (count > 0)
+            result += alphabet[(bits << (6 - count)) & 0x3f];
+    }
+#endif
+
+    double run(unsigned iterations, const std::function<void()>& encode)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < iterations; i++)
+            encode();
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned iterations = (argc > 1) ? (unsigned)atoi(argv[1]) : 2000;
+    if (iterations == 0)
+        iterations = 1;
+    //a plain EDID, one with extension blocks, a large DisplayID and one past the old 64KB limit
+    const size_t sizes[] = { 128, 512, 32768, 65535, 262144 };
+
+    printf("%10s %14s %14s %8s  %s\n", "bytes", baselineName, "Base64Encoder", "speedup", "output");
+    int status = 0;
+    for (size_t size : sizes)
+    {
+        std::vector<uint8_t> data(size);
+        for (size_t i = 0; i < size; i++)
+            data[i] = (uint8_t)(rand() >> 7);
+
+        std::string expected, actual;
+        baseline(data, expected);
+        Base64Encoder::Encode(data.data(), data.size(), false, actual);
+        const char* verdict = "same";
+        if (size > 0xffff && expected.size() < actual.size())
+            verdict = "baseline truncated";
+        else if (expected != actual)
+        {
+            verdict = "DIFFERENT";
+            status = 1;
+        }
+
+        double before = run(iterations, [&data, &expected]() { baseline(data, expected); });
+        double after = run(iterations, [&data, &actual]() { Base64Encoder::Encode(data.data(), data.size(), false, actual); });
+        printf("%10zu %11.2f us %11.2f us %7.1fx  %s\n", size, before, after, after > 0 ? before / after : 0.0, verdict);
+    }
+    return status;
+}
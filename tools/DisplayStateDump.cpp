@@ -0,0 +1,69 @@
+// Prints the display state DisplaySettings publishes in shared memory (DisplayStateShm.h), once or,
+// with --watch, every time its generation changes. Also a minimal example of a native reader. Build with:
+//   g++ -std=c++11 -O2 -I. tools/DisplayStateDump.cpp -o ds-state-dump -lrt
+// usage: ds-state-dump [--watch]
+
+#include "DisplayStateShm.h"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace WPEFramework::Plugin;
+
+namespace {
+
+    void print(const DisplayStateShm::DisplayState& state, uint32_t generation)
+    {
+        printf("generation %u\n", generation);
+        for (uint32_t port = 0; port < state.portCount && port < DisplayStateShm::MAX_PORTS; port++)
+        {
+            const DisplayStateShm::Port& shared = state.ports[port];
+            printf("  %-8.*s %-12s %.*s%s\n", (int)DisplayStateShm::NAME_LENGTH, shared.name,
+                shared.connected ? "connected" : "disconnected", (int)DisplayStateShm::NAME_LENGTH, shared.resolution,
+                port == state.primaryHdmi ? "  (primary)" : "");
+        }
+        if (state.sinkKnown)
+            printf("  sink %016llx tvHdr 0x%x tvResolutions 0x%x\n", (unsigned long long)state.edidHash,
+                (unsigned)state.tvHdrCapabilities, (unsigned)state.tvResolutions);
+        else
+            printf("  no sink\n");
+        for (uint32_t decoder = 0; decoder < state.decoderCount && decoder < DisplayStateShm::MAX_DECODERS; decoder++)
+            printf("  decoder%u hdr %d\n", decoder, state.decoderHdrCapabilities[decoder]);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const bool watch = (argc > 1 && strcmp(argv[1], "--watch") == 0);
+    const DisplayStateShm::Segment* segment = DisplayStateShm::Map();
+    if (segment == nullptr)
+    {
+        fprintf(stderr, "no display state at %s, is DisplaySettings running?\n", DisplayStateShm::SegmentName);
+        return 1;
+    }
+
+    DisplayStateShm::DisplayState state;
+    uint32_t generation = 0;
+    if (!DisplayStateShm::Read(segment, state, generation))
+    {
+        fprintf(stderr, "the display state is stale, DisplaySettings stopped\n");
+        DisplayStateShm::Unmap(segment);
+        return 1;
+    }
+    print(state, generation);
+    while (watch)
+    {
+        //checking the generation is a single load, the state is only copied when it moved
+        usleep(100 * 1000);
+        if (DisplayStateShm::Generation(segment) == generation)
+            continue;
+        if (!DisplayStateShm::Read(segment, state, generation))
+        {
+            fprintf(stderr, "the display state is stale, DisplaySettings stopped\n");
+            break;
+        }
+        print(state, generation);
+    }
+    DisplayStateShm::Unmap(segment);
+    return 0;
+}
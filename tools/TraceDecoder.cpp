@@ -0,0 +1,129 @@
+// Host-side decoder for the DisplaySettings flight recorder (/opt/logs/ds.trace).
+// It only depends on the record layout in TraceRing.h, build it with:
+//   g++ -std=c++11 -I. tools/TraceDecoder.cpp -o ds-trace-decode
+// usage: ds-trace-decode [--csv] [--session N] ds.trace
+
+#include "TraceRing.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+using std::string;
+using WPEFramework::Plugin::TraceRing;
+
+namespace {
+
+    const char* kindName(uint8_t kind)
+    {
+        switch (kind)
+        {
+        case TraceRing::METHOD: return "method";
+        case TraceRing::HAL_CALL: return "hal";
+        case TraceRing::IARM_EVENT: return "iarm";
+        case TraceRing::NOTIFY: return "notify";
+        }
+        return "?";
+    }
+
+    string nameOf(const TraceRing::Header& header, uint16_t id)
+    {
+        if (id == TraceRing::NO_NAME || id >= header.nameCount)
+            return "-";
+        return string(header.names[id], strnlen(header.names[id], TraceRing::NAME_LENGTH));
+    }
+
+    void formatTime(uint64_t ns, char* out, size_t length)
+    {
+        time_t seconds = (time_t)(ns / 1000000000ULL);
+        struct tm tm;
+        gmtime_r(&seconds, &tm);
+        size_t used = strftime(out, length, "%Y-%m-%d %H:%M:%S", &tm);
+        snprintf(out + used, length - used, ".%06u", (unsigned)((ns / 1000) % 1000000));
+    }
+
+    int usage(const char* self)
+    {
+        fprintf(stderr, "usage: %s [--csv] [--session N] <trace file>\n", self);
+        return 2;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    bool csv = false;
+    int session = -1;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--csv") == 0)
+            csv = true;
+        else if (strcmp(argv[i], "--session") == 0 && i + 1 < argc)
+            session = atoi(argv[++i]);
+        else if (argv[i][0] == '-')
+            return usage(argv[0]);
+        else
+            path = argv[i];
+    }
+    if (path == nullptr)
+        return usage(argv[0]);
+
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr)
+    {
+        perror(path);
+        return 1;
+    }
+    std::vector<uint8_t> image(TraceRing::FileSize());
+    size_t read = fread(image.data(), 1, image.size(), file);
+    fclose(file);
+
+    const TraceRing::Header& header = *reinterpret_cast<const TraceRing::Header*>(image.data());
+    if (read != image.size() || header.magic != TraceRing::MAGIC || header.version != TraceRing::VERSION
+        || header.recordSize != sizeof(TraceRing::Record) || header.capacity != TraceRing::CAPACITY)
+    {
+        fprintf(stderr, "%s: not a version %u DisplaySettings trace\n", path, (unsigned)TraceRing::VERSION);
+        return 1;
+    }
+    const TraceRing::Record* records = reinterpret_cast<const TraceRing::Record*>(image.data() + sizeof(TraceRing::Header));
+
+    uint64_t end = header.writeIndex;
+    uint64_t begin = (end > header.capacity) ? end - header.capacity : 0;
+    uint64_t torn = 0;
+    if (csv)
+        printf("time,session,kind,name,port,duration_us,value0,value1,result\n");
+    for (uint64_t index = begin; index < end; index++)
+    {
+        const TraceRing::Record& record = records[index % header.capacity];
+        if (record.sequence != (uint16_t)index)
+        {
+            torn++;
+            continue;
+        }
+        if (session >= 0 && record.session != (uint8_t)session)
+            continue;
+        char when[64];
+        formatTime(record.timestamp, when, sizeof(when));
+        string name = nameOf(header, record.id);
+        char port[TraceRing::NAME_LENGTH];
+        if (record.kind == TraceRing::IARM_EVENT)
+            snprintf(port, sizeof(port), "event%u", (unsigned)record.port);
+        else
+            snprintf(port, sizeof(port), "%s", nameOf(header, record.port).c_str());
+        if (csv)
+        {
+            printf("%s,%u,%s,%s,%s,%u,%d,%d,%d\n", when, (unsigned)record.session, kindName(record.kind), name.c_str(),
+                port, record.durationUs, record.value0, record.value1, record.result);
+        }
+        else
+        {
+            printf("%s [s%u] %-6s %-32s %-8s %8uus v=%d,%d result=%d\n", when, (unsigned)record.session, kindName(record.kind),
+                name.c_str(), port, record.durationUs, record.value0, record.value1, record.result);
+        }
+    }
+    if (torn)
+        fprintf(stderr, "%llu records skipped (being written when the trace was copied)\n", (unsigned long long)torn);
+    return 0;
+}